@@ -3,6 +3,8 @@ set -euo pipefail
 
 # Caminho do binário (pode sobrescrever via: BIN=./build/os-deadlock-sim ./experiments.sh)
 BIN="${BIN:-./os-deadlock-sim}"
+# O binário não é versionado: com o caminho padrão, (re)compila se preciso
+[ "$BIN" = "./os-deadlock-sim" ] && make -s
 OUT="${OUT:-out}"
 mkdir -p "$OUT"
 
@@ -29,10 +31,19 @@ combos=(
 
   "ostrich contention-90 10 3"
   "banker  contention-90 10 3"
+
+  # Prevenção O(m): ordem global e timestamps (wait-die / wound-wait)
+  "ordered    hotspot 8 4"
+  "wait-die   hotspot 8 4"
+  "wound-wait hotspot 8 4"
+
+  "ordered    contention-90 10 3"
+  "wait-die   contention-90 10 3"
+  "wound-wait contention-90 10 3"
 )
 
 # Cabeçalho do resumo (inclui n e m agora)
-echo -e "mode\tscenario\tn\tm\ttotal\tgrants\tblocks\tsafety_calls\tns_total\tavg_ns\tdeadlocks\tt_first" > "$OUT/summary.tsv"
+echo -e "mode\tscenario\tn\tm\ttotal\tgrants\tblocks\tsafety_calls\tns_total\tavg_ns\tdeadlocks\tt_first\taborts\trestarts\twasted" > "$OUT/summary.tsv"
 
 for entry in "${combos[@]}"; do
   # shellcheck disable=SC2086
@@ -46,26 +57,25 @@ for entry in "${combos[@]}"; do
   line=$("$BIN" --mode "$mode" --scenario "$scen" --n "$n" --m "$m" \
                --log "$log" --metrics "$json" | tail -n1)
 
-  # Extrai campos da linha "mode=... scenario=... | total=... grants=... blocks=... | ..."
-  # Ex.: mode=BANKER scenario=medium | total=... grants=... blocks=... | safety_calls=... ns_total=... avg_ns=...
-  modev=$(echo "$line" | awk -F'[ =|]+' '{print $2}')
-  scenv=$(echo "$line" | awk -F'[ =|]+' '{print $4}')
-  total=$(echo "$line" | awk -F'[ =|]+' '{print $6}')
-  grants=$(echo "$line" | awk -F'[ =|]+' '{print $8}')
-  blocks=$(echo "$line" | awk -F'[ =|]+' '{print $10}')
-
-  safety_calls=0; ns_total=0; avg_ns=0; deadlocks=0; tfirst=0
-  if [[ $modev == "BANKER" ]]; then
-    safety_calls=$(echo "$line" | awk -F'[ =|]+' '{for(i=1;i<=NF;i++) if($i=="safety_calls") {print $(i+1); exit}}')
-    ns_total=$(echo "$line" | awk -F'[ =|]+' '{for(i=1;i<=NF;i++) if($i=="ns_total") {print $(i+1); exit}}')
-    # avg_ns pode não existir se safety_calls=0
-    avg_ns=$(echo "$line" | awk -F'[ =|]+' '{for(i=1;i<=NF;i++) if($i=="avg_ns") {print $(i+1); found=1} } END{if(!found) print 0}')
-  else
-    deadlocks=$(echo "$line" | awk -F'[ =|]+' '{for(i=1;i<=NF;i++) if($i=="deadlocks") {print $(i+1); exit}}')
-    tfirst=$(echo "$line" | awk -F'[ =|]+' '{for(i=1;i<=NF;i++) if($i=="t_first") {print $(i+1); exit}}')
-  fi
-
-  echo -e "$modev\t$scenv\t$n\t$m\t$total\t$grants\t$blocks\t$safety_calls\t$ns_total\t$avg_ns\t$deadlocks\t$tfirst" >> "$OUT/summary.tsv"
+  # Uma passada pela linha "mode=... scenario=... | total=... grants=... | ...":
+  # pares chave=valor num mapa (1ª ocorrência vale); campos da política
+  # ausentes saem como 0. Dispensa um awk por campo.
+  echo "$line" | awk -F'[ =|]+' -v n="$n" -v m="$m" '
+    function g(k) { return (k in v) ? v[k] : 0 }
+    {
+      for (i = 1; i < NF; i++) if (!($i in v)) v[$i] = $(i + 1)
+      mode = v["mode"]
+      sc = ns = avg = dl = tf = ab = rs = ws = 0
+      if (mode == "BANKER")       { sc = g("safety_calls"); ns = g("ns_total"); avg = g("avg_ns") }
+      else if (mode == "OSTRICH") { dl = g("deadlocks"); tf = g("t_first") }
+      else                        { ab = g("aborts"); rs = g("restarts"); ws = g("wasted") }
+      printf "%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\n",
+             mode, v["scenario"], n, m, v["total"], v["grants"], v["blocks"],
+             sc, ns, avg, dl, tf, ab, rs, ws
+    }' >> "$OUT/summary.tsv"
+
+  # Contadores por pid/recurso e hotspots a partir do log (uma passada)
+  "$BIN" analyze "$log" "$OUT/${scen}_${mode}.analyze.json" > /dev/null
 done
 
 echo "OK! Resultados em: $OUT/summary.tsv  (e logs/json em $OUT/)"
@@ -0,0 +1,64 @@
+#ifndef ANALYZE_H
+#define ANALYZE_H
+/* ---------------------------------------------------------------------
+ * analyze.h — Subcomando `analyze`: uma passada sobre o log de eventos
+ * Lê o CSV ou o binário do --log (mmap, leitura sequencial, parser de
+ * inteiros próprio) e acumula por pid e por recurso: pedidos, concessões,
+ * negativas, episódios de bloqueio (da 1ª negativa à concessão), mínimo
+ * de Available e onde a contenção se concentra. Memória limitada a
+ * O(MAX_P + MAX_R), independente do tamanho do log.
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "resources.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ANALYZE_TOP 10             /* pids listados em hotspots.pids */
+
+typedef struct AnPid {
+    uint64_t requests, grants, denies;
+    uint64_t episodes;             /* bloqueios encerrados por concessão  */
+    uint64_t blocked_ticks;        /* soma das durações (inclui o aberto) */
+    uint64_t blocked_max;
+    int64_t  since;                /* clock da 1ª negativa; -1 = livre    */
+} AnPid;
+
+typedef struct AnRes {
+    uint64_t grants, denies;       /* eventos com req[j] > 0              */
+    uint64_t short_denies;         /* negativas com req[j] > Available[j] */
+    uint64_t units_granted;
+    int64_t  avail_min;
+    uint64_t avail_min_clock;
+} AnRes;
+
+typedef struct Analysis {
+    bool     binary;
+    char     mode[16];
+    int      m;
+    int      max_pid;              /* maior pid visto (-1 = nenhum)        */
+    uint64_t bytes, events, grants, denies;
+    uint64_t unsafe_denies;        /* negadas sem coluna faltando (safety) */
+    uint64_t bad_records;          /* linhas malformadas ou pid fora de faixa */
+    uint64_t clock_first, clock_last;
+    double   wall_s;
+    AnPid    pid[MAX_P];
+    AnRes    res[MAX_R];
+} Analysis;
+
+/* Analisa o log em 'path'; false (com mensagem em err) se não abrir/ler */
+bool analyze_log(const char *path, Analysis *A, char *err, size_t len);
+
+void analyze_print_summary(const Analysis *A, const char *path, FILE *f);
+void analyze_write_json(const Analysis *A, const char *path, FILE *f);
+
+/* Subcomando: analyze LOG [saida.json]. Retorna o código de saída. */
+int  analyze_main(int argc, char **argv);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* ANALYZE_H */
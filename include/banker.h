@@ -13,6 +13,10 @@ extern "C" {
 #endif
 
 bool safety_check(const System *S);
+/* Safety restrito ao componente de P (partition.h): só os membros e as
+   colunas de Available do componente. Sem partição válida, cai no
+   safety_check completo. */
+bool safety_check_component(System *S, const Process *P);
 bool request_banker(System *S, Process *P, const int req[MAX_R]);
 
 #ifdef __cplusplus
@@ -0,0 +1,62 @@
+#ifndef BATCH_H
+#define BATCH_H
+/* ---------------------------------------------------------------------
+ * batch.h — Motor em lote: vários Systems pequenos em lanes SIMD (--batch K)
+ * Para varreduras de cenários minúsculos (n <= BATCH_MAX_P, m <= BATCH_MAX_R)
+ * o motor carrega BATCH_LANES sistemas de uma vez e guarda Available, Need
+ * e Allocation com os sistemas intercalados (um vetor por pid e recurso,
+ * uma lane por sistema). Checagens do dispatcher, aplicação da concessão e
+ * a redução do safety/detector rodam em todas as lanes com operações
+ * vetoriais; lanes que terminam ficam mascaradas até o grupo acabar.
+ * Reproduz o sim_run com --sched index e --detect stall para BANKER e
+ * OSTRICH; cada sistema pode ser conferido contra o caminho escalar.
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "simulator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef BATCH_LANES
+#define BATCH_LANES 8          /* 8 × int32 = 256 bits; 16 para AVX-512 */
+#endif
+#define BATCH_MAX_P 16
+#define BATCH_MAX_R 4
+
+/* Carrega o sistema k da varredura em S (sim_init + loader do cenário) */
+typedef bool (*BatchLoadFn)(System *S, uint64_t k, void *ctx);
+
+typedef struct BatchConfig {
+    uint64_t    systems;       /* K sistemas (k = 0..K-1)                 */
+    BatchLoadFn load;
+    void       *ctx;
+    bool        scalar;        /* roda também o sim_run e compara         */
+} BatchConfig;
+
+typedef struct BatchResult {
+    uint64_t systems;
+    uint64_t deadlocks;        /* sistemas com deadlock no travamento     */
+    uint64_t stalls;           /* sistemas que pararam com processos vivos */
+    uint64_t requests, grants, blocks;
+    uint64_t makespan_sum;
+    double   batch_s;          /* só simulação (carga dos cenários fora)  */
+    double   scalar_s;         /* idem, sim_run um sistema por vez        */
+    uint64_t mismatches;       /* sistemas em que lote e escalar divergem */
+    bool     scalar_ran;
+} BatchResult;
+
+/* O motor em lote cobre o System carregado? Se não, 'why' diz o motivo */
+bool batch_supported(const System *S, char *why, size_t len);
+
+bool batch_run(const BatchConfig *cfg, BatchResult *out);
+
+void batch_print_summary(const BatchResult *r, const char *mode, const char *scenario, FILE *f);
+bool batch_write_json(const BatchResult *r, const char *mode, const char *scenario, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* BATCH_H */
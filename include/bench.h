@@ -0,0 +1,73 @@
+#ifndef BENCH_H
+#define BENCH_H
+/* ---------------------------------------------------------------------
+ * bench.h — Subcomando `bench`: vazão ponta a ponta do sim_run
+ * Gera cargas sintéticas numa grade de n, m, tamanho de roteiro e
+ * contenção e roda cada ponto em BANKER e OSTRICH, com log desligado,
+ * CSV e binário. Cada caso roda num processo filho (fork) para que o
+ * pico de RSS seja só dele. Saída em JSON (um caso por linha); com
+ * --baseline compara contra um JSON anterior e marca regressões, com
+ * tolerância à altura do ruído do caso e só depois de re-medir.
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "resources.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BENCH_AXIS_MAX 8           /* valores por eixo da grade          */
+#define BENCH_MIN_S    0.05        /* tempo mínimo medido por caso (s)   */
+#define BENCH_MAX_RUNS 1000
+#define BENCH_NOISE_K  3.0         /* tolerância >= K × ruído (MAD, %)   */
+#define BENCH_RECHECK  2           /* re-medições antes de dar regressão */
+
+typedef enum BenchLog {
+    BENCH_LOG_OFF = 0,
+    BENCH_LOG_CSV,
+    BENCH_LOG_BIN
+} BenchLog;
+
+typedef struct BenchCase {
+    const char *mode;              /* nome da política (policy_find)     */
+    int      n, m;
+    int      len;                  /* pedidos unitários por processo     */
+    int      contention;           /* Available = soma(Max) / contention */
+    BenchLog log;
+} BenchCase;
+
+typedef struct BenchResult {
+    BenchCase c;
+    char     id[80];               /* chave da comparação com o baseline */
+    bool     ok;
+    int      runs;                 /* repetições feitas (>= reps)        */
+    uint64_t requests, grants, blocks, ticks, deadlocks;
+    uint64_t log_bytes;
+    double   wall_s;               /* mediana das repetições (sim_run + fechar log) */
+    double   noise_pct;            /* desvio absoluto mediano / mediana  */
+    double   req_per_s, ns_per_tick, bpg;
+    long     peak_rss_kb;          /* ru_maxrss do filho                 */
+
+    /* Comparação com o baseline (has_base = caso presente nele) */
+    bool     has_base, regressed, drift;
+    double   base_req_per_s, base_bpg, base_noise_pct;
+    long     base_rss_kb;
+    double   delta_pct;            /* req_per_s: (novo - base) / base     */
+    double   tol_pct;              /* queda tolerada neste caso           */
+    int      rechecks;             /* re-medições feitas após regredir    */
+} BenchResult;
+
+/* Roda um caso no processo corrente: ao menos reps repetições (mais, se
+   não somarem BENCH_MIN_S), e fica com a mediana e o ruído delas */
+bool bench_case_run(const BenchCase *c, int reps, uint64_t seed,
+                    const char *dir, BenchResult *out);
+
+/* Subcomando: bench [opções]. Retorna o código de saída (1 = regressão). */
+int  bench_main(int argc, char **argv);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* BENCH_H */
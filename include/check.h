@@ -0,0 +1,30 @@
+#ifndef CHECK_H
+#define CHECK_H
+/* ---------------------------------------------------------------------
+ * check.h — Subcomando `check` (make check): confere os atalhos
+ * Reroda cenários sintéticos com semente (random, workers, locks) e
+ * compara, pedido a pedido, a decisão da política com a do safety
+ * clássico sobre o estado cru (sem atalho de Need, envelope, partição,
+ * bitsets nem grafo de reivindicação). No OSTRICH confere o detector em
+ * bitsets contra a mesma redução. Fora do lockstep: o explorador com e
+ * sem POR tem de achar os mesmos estados travados, e --shards tem de
+ * terminar os mesmos pedidos que a execução num processo só.
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include "simulator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Loader de cenário do main (sim_init já feito; n e m vêm de S) */
+typedef bool (*CheckLoadFn)(System *S, const char *scenario, uint64_t seed);
+
+/* Subcomando: check [opções]. Retorna o código de saída (1 = divergência). */
+int check_main(int argc, char **argv, CheckLoadFn load);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CHECK_H */
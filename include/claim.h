@@ -0,0 +1,66 @@
+#ifndef CLAIM_H
+#define CLAIM_H
+/* ---------------------------------------------------------------------
+ * claim.h — Evitação pelo grafo de reivindicação (--mode claim)
+ * Para sistemas só com recursos de instância única (unitbits.h): o
+ * estado é seguro sse o grafo P→R (Need) + R→P (Allocation) é acíclico.
+ * O grafo é estado do claim.c: só ele o monta, e enquanto não montado
+ * (qualquer outra política) o caminho de concessão não o mantém.
+ * --------------------------------------------------------------------- */
+#include <stdbool.h>
+#include "resources.h"
+#include "unitbits.h"   /* u64 */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct System;
+struct Process;
+
+#define CG_PWORDS ((MAX_P + 63) / 64)
+#define CG_NODES  (MAX_P + MAX_R)    /* nós do grafo: pid ou MAX_P + j     */
+
+/* P→R quando P ainda reivindica R (need), R→P quando P detém R (holder).
+   'ord' é uma ordem topológica mantida incrementalmente. */
+typedef struct ClaimGraph {
+    bool     valid;                /* false → não mantido (montado no uso) */
+    int      holder[MAX_R];        /* dono da instância (-1 = livre)     */
+    u64      claim[MAX_R][CG_PWORDS]; /* transposta de need: bit i = Pi → j */
+    bool     ord_valid;            /* false → refaz a ordem no uso       */
+    int      ord_n;                /* processos cobertos pela ordem      */
+    int      ord[CG_NODES];        /* posição de cada nó                 */
+    int      at[CG_NODES];         /* nó em cada posição                 */
+    unsigned mark[CG_NODES];       /* visitados das buscas (== stamp)    */
+    unsigned stamp;
+} ClaimGraph;
+
+/* Aresta nova from→to: se a ordem não a respeita (ou pid está fora
+   dela), a ordem é refeita no próximo uso */
+static inline void cg_order_edge(ClaimGraph *g, int pid, int from, int to) {
+    if (g->ord_valid && (pid >= g->ord_n || g->ord[from] > g->ord[to])) g->ord_valid = false;
+}
+
+/* Espelha Need/Allocation (0/1) de pid na coluna única j */
+static inline void cg_set(ClaimGraph *g, int pid, int j, bool need, bool alloc) {
+    u64 *w = &g->claim[j][pid >> 6], bit = 1ull << (pid & 63);
+    if (((*w & bit) != 0) != need) {
+        *w ^= bit;
+        if (need) cg_order_edge(g, pid, pid, MAX_P + j);
+    }
+    if (alloc && g->holder[j] != pid) {
+        g->holder[j] = pid;
+        cg_order_edge(g, pid, MAX_P + j, pid);
+    } else if (!alloc && g->holder[j] == pid) {
+        g->holder[j] = -1;
+    }
+}
+
+/* Concede 'req' a P se a troca P→R por R→P não fechar ciclo. Com colunas
+   contadas (ou se o estado atual já tem ciclo) delega ao request_banker. */
+bool request_claim(struct System *S, struct Process *P, const int req[MAX_R]);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CLAIM_H */
@@ -0,0 +1,84 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+/* ---------------------------------------------------------------------
+ * coroutine.h — Processos com comportamento (corrotinas stackful)
+ * Em vez de um ReqList, o processo roda uma função C que cede o controle
+ * ao sim_run em cada pedido, devolução parcial ou compute(t). Sem
+ * threads do SO: troca de contexto em espaço de usuário (asm em x86-64,
+ * ucontext nas demais) e pilhas pequenas de um pool reaproveitado.
+ * Uma pilha só fica presa enquanto a corrotina está viva (começou e não
+ * terminou); o resto do estado é o CoTask, de tamanho fixo.
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include "resources.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Pilha por corrotina (bytes); ajuste com -DCO_STACK_SIZE=... */
+#ifndef CO_STACK_SIZE
+#define CO_STACK_SIZE (16 * 1024)
+#endif
+#define CO_SLAB_STACKS 64       /* pilhas por mmap do pool */
+
+struct System;
+struct Process;
+struct CoTask;
+
+/* Comportamento: roda até retornar (= processo termina e devolve tudo).
+   Se o processo for abortado pela política, a função recomeça do início. */
+typedef void (*CoBehavior)(struct CoTask *t, void *arg);
+
+/* O que a corrotina pediu ao ceder o controle */
+typedef enum CoOp {
+    CO_OP_START = 0,   /* ainda não rodou (ou recomeça após aborto) */
+    CO_OP_REQUEST,     /* req: espera até ser concedido             */
+    CO_OP_RELEASE,     /* req: devolução parcial                    */
+    CO_OP_COMPUTE,     /* wake: dorme até sim_clock >= wake         */
+    CO_OP_EXIT         /* função retornou                           */
+} CoOp;
+
+typedef struct CoTask {
+    CoBehavior      fn;
+    void           *arg;
+    struct System  *S;          /* válidos dentro do comportamento */
+    struct Process *P;
+    void           *stack;      /* do pool; NULL fora da execução  */
+    void           *sp;         /* contexto salvo (ver coroutine.c) */
+    CoOp            op;
+    bool            granted;    /* pedido corrente já concedido     */
+    bool            sleeping;   /* na fila de timers                */
+    uint64_t        wake;
+    int             req[MAX_R];
+} CoTask;
+
+/* Prepara t (memória do chamador) para rodar fn(t, arg) */
+void co_init(CoTask *t, CoBehavior fn, void *arg);
+
+/* ---- Dentro do comportamento ---- */
+void co_request(CoTask *t, const int req[MAX_R]);   /* volta já concedido */
+void co_release(CoTask *t, const int req[MAX_R]);
+void co_compute(CoTask *t, uint64_t ticks);
+
+/* ---- Lado do sim_run ---- */
+/* Roda t até a próxima cessão; devolve t->op */
+CoOp co_resume(struct System *S, struct Process *P, CoTask *t);
+/* Descarta a execução (aborto): devolve a pilha, cancela o sono */
+void co_reset(CoTask *t);
+
+/* Timers de compute(t): P dorme até 'wake' */
+void     co_sleep(struct Process *P, uint64_t wake);
+/* Acorda (sched_push_ready) quem tem wake <= sim_clock */
+void     co_wake_due(struct System *S);
+bool     co_has_sleepers(void);
+uint64_t co_next_wake(void);
+
+/* Pilhas alocadas / em uso (pool por thread) */
+void co_pool_stats(uint64_t *allocated, uint64_t *in_use);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* COROUTINE_H */
@@ -3,15 +3,73 @@
 /* ---------------------------------------------------------------------
  * detector.h — Detector de deadlock (para métricas no modo OSTRICH)
  * --------------------------------------------------------------------- */
+#include <stdint.h>
 #include <stdbool.h>
 #include "resources.h"
-#include "simulator.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-bool detect_deadlock(const System *S);
+struct System;  /* simulator.h (que inclui este header) */
+
+/* ============================
+ * Quando rodar o detector (--detect)
+ * ============================ */
+typedef enum DetectTrigger {
+    DET_STALL = 0,   /* só quando a rodada não progride (padrão)            */
+    DET_EVERY_K,     /* a cada K requisições (conferido no fim da rodada)   */
+    DET_EVERY_T,     /* a cada T ticks                                      */
+    DET_BLOCKED,     /* quando BLOCKED/ativos >= fração                     */
+    DET_ADAPTIVE,    /* intervalo em requisições: dobra se vazio, cai à
+                        metade após deadlock novo                          */
+    DET_NONE         /* nunca (nem no travamento)                           */
+} DetectTrigger;
+
+typedef struct DetectConfig {
+    DetectTrigger trigger;
+    uint64_t      every;          /* K (requisições) ou T (ticks); base do adaptativo */
+    double        blocked_frac;   /* limiar do DET_BLOCKED                             */
+} DetectConfig;
+
+typedef struct DetectState {
+    uint64_t next_req;    /* próxima detecção por nº de requisições */
+    uint64_t next_tick;   /* próxima detecção por tick              */
+    uint64_t interval;    /* intervalo corrente (adaptativo)        */
+} DetectState;
+
+#define DETECT_ADAPTIVE_MIN 1
+#define DETECT_ADAPTIVE_MAX 4096
+
+/* Conjunto de processos em deadlock (saída detalhada do detector) */
+typedef struct DeadlockReport {
+    int count;           /* nº de processos não-finalizáveis */
+    int pids[MAX_P];     /* ids, em ordem crescente          */
+} DeadlockReport;
+
+/* true se existe algum processo não-finalizável (ou se faltou memória) */
+bool detect_deadlock(const struct System *S);
+
+/* Redução por contadores + worklist, O(n·m·log n).
+   Retorna o nº de processos em deadlock; preenche 'out' se != NULL.
+   Retorna -1 se não houver memória para os buffers de trabalho. */
+int  detect_deadlock_set(const struct System *S, DeadlockReport *out);
+
+/* "stall" | "every:K" | "ticks:T" | "blocked:F" | "adaptive[:K]" | "none" */
+bool        detect_config_parse(const char *s, DetectConfig *out);
+const char *detect_trigger_str(DetectTrigger t);
+
+/* Variante clássica (Coffman): BLOCKED pede só a requisição corrente,
+   READY não pede nada. Usada pelos gatilhos periódicos, em que ainda há
+   processos executáveis. */
+int  detect_deadlock_waiting(const struct System *S, DeadlockReport *out);
+
+/* Agendamento. Os gatilhos periódicos são avaliados no fim da rodada
+   (estados assentados); cada execução é cronometrada em
+   detector_calls / ns_in_detector_total. */
+void detector_begin(struct System *S);        /* início do sim_run        */
+void detector_on_tick(struct System *S);      /* Policy.on_tick do OSTRICH */
+void detector_on_stall(struct System *S);     /* rodada sem progresso     */
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,62 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+/* ---------------------------------------------------------------------
+ * events.h — Modelo de tempo por eventos discretos (--engine event)
+ * Em vez de rodadas de +1 tick, um calendário (heap binário por tempo)
+ * de eventos ARRIVAL / REQUEST / HOLD_EXPIRE / RELEASE; sim_clock salta
+ * direto para o próximo evento. Cada processo chega segundo a
+ * distribuição de entre-chegadas e segura cada concessão pelo tempo de
+ * retenção sorteado; o custo é proporcional a eventos, não a ticks × n.
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "resources.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct System;  /* simulator.h (que inclui este header) */
+
+typedef enum SimEngine {
+    ENGINE_TICK = 0,   /* sim_run por rodadas (original) */
+    ENGINE_EVENT       /* sim_run_events                 */
+} SimEngine;
+
+/* Distribuição de durações (em ticks; sorteio arredondado) */
+typedef enum DistKind {
+    DIST_CONST = 0,    /* const:X        */
+    DIST_EXP,          /* exp:MÉDIA      */
+    DIST_UNIFORM       /* uniform:A:B    */
+} DistKind;
+
+typedef struct Dist {
+    DistKind kind;
+    double   a, b;
+} Dist;
+
+/* Campos de tempo do cenário (System.ev_cfg) */
+typedef struct EventConfig {
+    SimEngine engine;
+    Dist      arrival;     /* entre-chegadas (padrão const:0: todos em t=0) */
+    Dist      hold;        /* retenção após cada concessão (padrão const:1) */
+    uint64_t  seed;
+} EventConfig;
+
+bool        dist_parse(const char *s, Dist *out);
+const char *dist_str(const Dist *d, char *buf, size_t len);
+/* Sorteia uma duração >= lo (gerador splitmix64 em *rng) */
+uint64_t    dist_sample(const Dist *d, uint64_t *rng, uint64_t lo);
+
+bool        engine_from_str(const char *s, SimEngine *out);
+const char *engine_str(SimEngine e);
+
+/* Roda o cenário carregado pelo calendário de eventos. Mesmas políticas,
+   dispatcher e detector do sim_run; processos com corrotina não entram. */
+void sim_run_events(struct System *S);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* EVENTS_H */
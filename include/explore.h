@@ -0,0 +1,67 @@
+#ifndef EXPLORE_H
+#define EXPLORE_H
+/* ---------------------------------------------------------------------
+ * explore.h — Exploração exaustiva das intercalações (--explore)
+ * A partir do System carregado, visita todos os estados alcançáveis
+ * trocando a ordem dos passos dos processos. O estado é o vetor de
+ * cursores dos roteiros: Allocation e Available saem dele (somas de
+ * prefixo dos roteiros), então o conjunto de visitados guarda só um
+ * hash de 64 bits por estado. Com redução de ordem parcial (conjuntos
+ * teimosos) ficam de fora intercalações de passos independentes, mas
+ * todo estado travado alcançável continua sendo visitado.
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "simulator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EXPLORE_MAX_P 64           /* cursores cabem em 64 bytes         */
+#ifndef EXPLORE_TABLE_LOG2
+#define EXPLORE_TABLE_LOG2 22      /* 4M hashes (32 MiB) no visitado     */
+#endif
+
+typedef struct ExploreConfig {
+    int  threads;                  /* workers (<= 0 → nº de CPUs)        */
+    bool por;                      /* redução de ordem parcial           */
+    int  table_log2;               /* capacidade do visitado (2^x)       */
+} ExploreConfig;
+
+/* Um estado travado e a ordem de passos (pids) que leva até ele */
+typedef struct ExploreWitness {
+    int       len;
+    uint16_t *schedule;            /* [len]                              */
+    uint64_t  blocked;             /* bit i = Pi vivo e sem passo        */
+} ExploreWitness;
+
+typedef struct ExploreResult {
+    int       threads;
+    bool      por;
+    uint64_t  states;              /* estados distintos visitados        */
+    uint64_t  transitions;         /* passos expandidos                  */
+    uint64_t  por_pruned;          /* passos habilitados não expandidos  */
+    uint64_t  deadlocked;          /* estados sem passo e com vivos      */
+    bool      all_finish;          /* estado "todos terminaram" alcançado */
+    bool      complete;            /* false: tabela encheu (parcial)     */
+    double    wall_s;
+    ExploreWitness *witness;       /* até EXPLORE_WITNESS_MAX, 1 por estado */
+    int       n_witness;
+} ExploreResult;
+
+/* O explorador cobre o System carregado? Se não, 'why' diz o motivo */
+bool explore_supported(const System *S, char *why, size_t len);
+
+/* Explora a partir de 'base' (não é modificado) */
+bool explore_run(const System *base, const ExploreConfig *cfg, ExploreResult *out);
+void explore_result_free(ExploreResult *r);
+
+void explore_print_summary(const ExploreResult *r, const char *mode, const char *scenario, FILE *f);
+bool explore_write_json(const ExploreResult *r, const char *mode, const char *scenario, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* EXPLORE_H */
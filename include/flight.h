@@ -0,0 +1,44 @@
+#ifndef FLIGHT_H
+#define FLIGHT_H
+/* ---------------------------------------------------------------------
+ * flight.h — Gravador de voo: anel em memória das últimas N requisições
+ * Registro sem I/O (só cópias para o anel pré-alocado); o anel e um
+ * snapshot completo do System vão para disco só quando o detector acha
+ * deadlock, quando a execução termina travada ou sob demanda (SIGUSR1
+ * ou flight_dump()).
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include "resources.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct System;
+struct Process;
+struct DeadlockReport;
+
+/* Aloca o anel (capacity eventos, m colunas) e instala o SIGUSR1.
+   'path' é o arquivo do primeiro dump; os seguintes viram path.1, path.2... */
+bool flight_open(const char *path, uint32_t capacity, int m);
+void flight_close(void);
+bool flight_enabled(void);
+
+/* Hot path (dispatcher): clock, pid, req, granted e o delta de Available
+   desde o evento anterior (captura também liberações entre eventos). */
+void flight_record(const struct System *S, const struct Process *P,
+                   const int req[MAX_R], bool granted);
+
+/* Dump do anel + snapshot. 'rep' (opcional) lista os pids em deadlock. */
+bool flight_dump(const struct System *S, const char *reason,
+                 const struct DeadlockReport *rep);
+
+/* Gatilhos: detector achou deadlock novo / execução terminou travada */
+void flight_on_deadlock(const struct System *S, const struct DeadlockReport *rep);
+void flight_on_run_end(const struct System *S);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FLIGHT_H */
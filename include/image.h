@@ -0,0 +1,61 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+/* ---------------------------------------------------------------------
+ * image.h — Imagem binária pré-compilada de cenário (--compile/--image)
+ * O arquivo guarda o System já carregado (Available, Max, Allocation,
+ * Need, partição) e os roteiros, cada seção alinhada em página. Na
+ * carga as seções são mapeadas com mmap e usadas no lugar, sem parse
+ * nem sys_load_from_arrays(): o custo de partida vira page faults.
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "simulator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMAGE_MAGIC   "OSDLIMG"
+#define IMAGE_VERSION 2u
+#define IMAGE_ALIGN   4096u     /* seções começam em fronteira de página */
+
+/* Cabeçalho (offset 0). Os limites de compilação entram no cabeçalho:
+   a imagem só é aceita por um binário com o mesmo layout. */
+typedef struct ImageHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t rc_bits;
+    uint32_t max_p, max_r, max_reqs;
+    uint32_t n_scripts;          /* ReqList na seção de roteiros        */
+    uint64_t sys_size;           /* sizeof(System)                      */
+    uint64_t reqlist_size;       /* sizeof(ReqList)                     */
+    uint64_t sys_off;            /* seção System (cópia privada, COW)   */
+    uint64_t scripts_off;        /* seção de roteiros                   */
+    uint64_t file_size;
+    int32_t  n, m;
+    char     scenario[32];       /* nome do cenário de origem           */
+} ImageHeader;
+
+/* Imagem mapeada: S aponta para dentro do mapeamento */
+typedef struct Image {
+    ImageHeader hdr;
+    System     *S;
+    ReqList    *scripts;
+    size_t      sys_len, scripts_len;
+} Image;
+
+/* Grava o cenário carregado em S (Process.script vira índice) */
+bool image_write(const System *S, const char *scenario, const char *path);
+
+/* Mapeia a imagem: System em MAP_PRIVATE (escritas não voltam ao
+   arquivo), roteiros em MAP_PRIVATE também, pois o cursor idx mora no
+   ReqList; as páginas de items nunca são escritas e seguem
+   compartilhadas com o page cache. Ajusta policy/sched/detect. */
+bool image_open(Image *img, const char *path, const struct Policy *policy);
+void image_close(Image *img);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* IMAGE_H */
@@ -1,8 +1,9 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 /* ---------------------------------------------------------------------
- * logger.h — CSV de eventos de requisição + export de métricas (JSON)
+ * logger.h — Log de eventos de requisição (CSV ou binário) + métricas JSON
  * --------------------------------------------------------------------- */
+#include <stdint.h>
 #include <stdbool.h>
 #include "resources.h"
 #include "simulator.h"
@@ -12,7 +13,22 @@
 extern "C" {
 #endif
 
-/* Abre CSV e escreve header (usa m colunas de req e available) */
+/* Log binário (--log arquivo.bin): cabeçalho + registros de tamanho fixo
+   LOG_BIN_RECORD(m) bytes: uint64 clock, int32 pid, int32 granted,
+   int32 req[m], int32 avail[m] (little-endian do host). */
+#define LOG_BIN_MAGIC   "OSDLLOG"
+#define LOG_BIN_VERSION 1u
+#define LOG_BIN_RECORD(m) (16u + 8u * (unsigned)(m))
+
+typedef struct LogBinHeader {
+    char     magic[8];
+    uint32_t version;
+    int32_t  m;
+    char     mode[16];          /* label da política do 1º evento */
+} LogBinHeader;
+
+/* Abre o log e escreve o header (usa m colunas de req e available).
+   Caminho terminado em ".bin" → formato binário; senão CSV. */
 bool logger_open_csv(const char *path, int m);
 
 /* Registra um evento de requisição (após decisão, para ter estado atualizado).
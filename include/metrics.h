@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "resources.h"   /* MAX_R */
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,14 +15,43 @@ extern "C" {
 
 typedef struct Metrics {
     uint64_t total_requests;        /* nº total de requisições (qualquer modo)           */
-    uint64_t banker_safety_calls;   /* nº de chamadas ao SafetyCheck (modo BANKER)       */
-    uint64_t ns_in_safety_total;    /* tempo acumulado (ns) gasto em SafetyCheck         */
+    uint64_t decisions;             /* pedidos decididos pelo BANKER/CLAIM (com atalhos) */
+    uint64_t ns_in_decisions_total; /* tempo acumulado (ns) nessas decisões              */
+    uint64_t banker_safety_calls;   /* reduções de safety de fato (sem os atalhos)       */
+    uint64_t ns_in_safety_total;    /* tempo acumulado (ns) só nessas reduções           */
+    uint64_t safety_procs_scanned;  /* processos considerados pelos SafetyChecks         */
+    uint64_t safety_fast_path;      /* concessões do BANKER pelo envelope de Need (O(m)) */
+    uint64_t env_hits;              /* concessões pelo envelope seguro por processo      */
+    uint64_t env_builds;            /* gravações do envelope após um safety              */
+    uint64_t ns_in_env_build_total; /* tempo acumulado (ns) nessas gravações             */
+    uint64_t rebuilds;              /* montagens preguiçosas: need_max, bits, envelope   */
+    uint64_t ns_in_rebuild_total;   /* tempo acumulado (ns) nessas montagens             */
+    uint64_t claim_searches;        /* CLAIM: inserções que precisaram de busca          */
+    uint64_t claim_visited;         /* CLAIM: nós visitados pelas buscas                 */
+    uint64_t claim_rebuilds;        /* CLAIM: ordem refeita do zero (O(n + m + arestas)) */
+    uint64_t claim_fallbacks;       /* CLAIM: decisões delegadas ao BANKER               */
     uint64_t grants;                /* requisições concedidas                            */
     uint64_t blocks;                /* requisições bloqueadas/negadas                    */
+    uint64_t aborts;                /* processos abortados (rollback total do roteiro)   */
+    uint64_t restarts;              /* abortados que voltaram a obter concessão          */
+    uint64_t wasted_grants;         /* concessões desfeitas por abortos                  */
+    uint64_t order_violations;      /* ORDERED: pedidos fora da ordem global que não cabiam */
+    uint64_t partial_releases;      /* devoluções parciais (corrotinas: co_release)      */
+    uint64_t events;                /* eventos processados (--engine event)              */
+
+    /* Utilização: unidades alocadas integradas no tempo (O(m) por avanço do relógio) */
+    uint64_t res_units[MAX_R];      /* instâncias de cada recurso no início do sim_run   */
+    uint64_t res_busy[MAX_R];       /* soma de (unidades alocadas × ticks)               */
 
     /* Modo OSTRICH (para relatório) */
     uint64_t deadlocks_found;       /* quantos deadlocks o detector encontrou            */
     uint64_t time_to_first_deadlock;/* “tempo lógico” até o 1º deadlock (0 = não houve)  */
+    uint64_t deadlocked_procs;      /* tamanho do último conjunto em deadlock detectado  */
+    uint64_t detector_calls;        /* execuções do detector (qualquer gatilho)          */
+    uint64_t ns_in_detector_total;  /* tempo acumulado (ns) no detector                  */
+    uint64_t detector_hits;         /* execuções que acharam deadlock novo               */
+    uint64_t detect_latency_total;  /* soma (ticks) formação → detecção dos deadlocks    */
+    uint64_t detect_latency_max;    /* pior latência de detecção (ticks)                 */
 } Metrics;
 
 /* ============================
@@ -29,23 +59,67 @@ typedef struct Metrics {
  * ============================ */
 static inline void metrics_reset(Metrics *m) {
     m->total_requests = 0;
+    m->decisions = 0;
+    m->ns_in_decisions_total = 0;
     m->banker_safety_calls = 0;
     m->ns_in_safety_total = 0;
+    m->safety_procs_scanned = 0;
+    m->safety_fast_path = 0;
+    m->env_hits = 0;
+    m->env_builds = 0;
+    m->ns_in_env_build_total = 0;
+    m->rebuilds = 0;
+    m->ns_in_rebuild_total = 0;
+    m->claim_searches = 0;
+    m->claim_visited = 0;
+    m->claim_rebuilds = 0;
+    m->claim_fallbacks = 0;
     m->grants = 0;
     m->blocks = 0;
+    m->aborts = 0;
+    m->restarts = 0;
+    m->wasted_grants = 0;
+    m->order_violations = 0;
+    m->partial_releases = 0;
+    m->events = 0;
+    for (int j = 0; j < MAX_R; ++j) {
+        m->res_units[j] = 0;
+        m->res_busy[j] = 0;
+    }
     m->deadlocks_found = 0;
     m->time_to_first_deadlock = 0;
+    m->deadlocked_procs = 0;
+    m->detector_calls = 0;
+    m->ns_in_detector_total = 0;
+    m->detector_hits = 0;
+    m->detect_latency_total = 0;
+    m->detect_latency_max = 0;
 }
 
 static inline void metrics_record_request(Metrics *m) {
     m->total_requests++;
 }
 
+static inline void metrics_record_decision(Metrics *m, uint64_t elapsed_ns) {
+    m->decisions++;
+    m->ns_in_decisions_total += elapsed_ns;
+}
+
 static inline void metrics_record_safety_call(Metrics *m, uint64_t elapsed_ns) {
     m->banker_safety_calls++;
     m->ns_in_safety_total += elapsed_ns;
 }
 
+static inline void metrics_record_rebuild(Metrics *m, uint64_t elapsed_ns) {
+    m->rebuilds++;
+    m->ns_in_rebuild_total += elapsed_ns;
+}
+
+static inline void metrics_record_detector_call(Metrics *m, uint64_t elapsed_ns) {
+    m->detector_calls++;
+    m->ns_in_detector_total += elapsed_ns;
+}
+
 static inline void metrics_record_grant(Metrics *m) {
     m->grants++;
 }
@@ -54,6 +128,63 @@ static inline void metrics_record_block(Metrics *m) {
     m->blocks++;
 }
 
+/* Soma contadores de 'src' em 'dst' (shards); extremos viram min/max */
+static inline void metrics_merge(Metrics *dst, const Metrics *src) {
+    dst->total_requests       += src->total_requests;
+    dst->decisions            += src->decisions;
+    dst->ns_in_decisions_total += src->ns_in_decisions_total;
+    dst->banker_safety_calls  += src->banker_safety_calls;
+    dst->ns_in_safety_total   += src->ns_in_safety_total;
+    dst->safety_procs_scanned += src->safety_procs_scanned;
+    dst->safety_fast_path     += src->safety_fast_path;
+    dst->env_hits             += src->env_hits;
+    dst->env_builds           += src->env_builds;
+    dst->ns_in_env_build_total += src->ns_in_env_build_total;
+    dst->rebuilds             += src->rebuilds;
+    dst->ns_in_rebuild_total  += src->ns_in_rebuild_total;
+    dst->claim_searches       += src->claim_searches;
+    dst->claim_visited        += src->claim_visited;
+    dst->claim_rebuilds       += src->claim_rebuilds;
+    dst->claim_fallbacks      += src->claim_fallbacks;
+    dst->grants               += src->grants;
+    dst->blocks               += src->blocks;
+    dst->aborts               += src->aborts;
+    dst->restarts             += src->restarts;
+    dst->wasted_grants        += src->wasted_grants;
+    dst->order_violations     += src->order_violations;
+    dst->partial_releases     += src->partial_releases;
+    dst->events               += src->events;
+    for (int j = 0; j < MAX_R; ++j) {
+        dst->res_busy[j] += src->res_busy[j];
+        if (src->res_units[j] > dst->res_units[j]) dst->res_units[j] = src->res_units[j];
+    }
+    dst->deadlocks_found      += src->deadlocks_found;
+    dst->deadlocked_procs     += src->deadlocked_procs;
+    dst->detector_calls       += src->detector_calls;
+    dst->ns_in_detector_total += src->ns_in_detector_total;
+    dst->detector_hits        += src->detector_hits;
+    dst->detect_latency_total += src->detect_latency_total;
+    if (src->time_to_first_deadlock &&
+        (!dst->time_to_first_deadlock || src->time_to_first_deadlock < dst->time_to_first_deadlock))
+        dst->time_to_first_deadlock = src->time_to_first_deadlock;
+    if (src->detect_latency_max > dst->detect_latency_max)
+        dst->detect_latency_max = src->detect_latency_max;
+}
+
+/* Comparador de qsort para uint64_t (crescente) */
+static inline int metrics_cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Percentil p (0..100) de v[0..k-1] já ordenado, por nearest-rank */
+static inline uint64_t metrics_pct(const uint64_t *v, uint64_t k, double p) {
+    if (k == 0) return 0;
+    uint64_t r = (uint64_t)(p * (double)k / 100.0 + 0.999999);
+    if (r > k) r = k;
+    return v[r ? r - 1 : 0];
+}
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,49 @@
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+/* ---------------------------------------------------------------------
+ * montecarlo.h — Amostragem paralela de intercalações (--monte-carlo K)
+ * Cada rodada k clona o System carregado, usa escalonador aleatório com
+ * semente seed+k e roda sim_run(); o cenário é o mesmo em todas (carregado
+ * uma vez com scenario_seed). A rodada é reproduzível com
+ *   --scenario-seed <scenario_seed> --sched random --seed <seed+k>
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "simulator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct MCConfig {
+    uint64_t runs;      /* K intercalações                  */
+    uint64_t seed;      /* semente base (rodada k usa seed+k) */
+    uint64_t scenario_seed; /* semente do cenário (só reportada) */
+    int      threads;   /* workers (<= 0 → nº de CPUs)      */
+} MCConfig;
+
+typedef struct MCResult {
+    uint64_t  runs;
+    uint64_t  seed;
+    uint64_t  scenario_seed;
+    int       threads;
+    uint64_t  deadlocks;     /* rodadas em que o detector achou deadlock */
+    uint64_t  stalls;        /* rodadas que pararam com processos vivos  */
+    uint8_t  *deadlocked;    /* [runs] 1 se a rodada k teve deadlock     */
+    uint64_t *ttfd;          /* [runs] time_to_first_deadlock (0 = não)  */
+    double    wall_s;        /* tempo de parede total                    */
+} MCResult;
+
+/* Roda cfg->runs intercalações de 'base' (não é modificado) */
+bool mc_run(const System *base, const MCConfig *cfg, MCResult *out);
+void mc_result_free(MCResult *r);
+
+/* Resumo em uma linha (stdout) e relatório completo em JSON */
+void mc_print_summary(const MCResult *r, const char *mode, const char *scenario, FILE *f);
+bool mc_write_json(const MCResult *r, const char *mode, const char *scenario, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* MONTECARLO_H */
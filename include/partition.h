@@ -0,0 +1,51 @@
+#ifndef PARTITION_H
+#define PARTITION_H
+/* ---------------------------------------------------------------------
+ * partition.h — Componentes independentes (processos × recursos)
+ * Dois processos ficam no mesmo componente quando seus Max tocam um
+ * recurso em comum. Union-find sobre os recursos (m pequeno) e, por
+ * raiz, uma lista duplamente ligada dos processos membros.
+ * Só junta componentes (carga/registro); quem termina sai da lista, mas
+ * o componente não é dividido: continua sendo união de componentes
+ * reais, o que mantém o safety por componente correto.
+ * --------------------------------------------------------------------- */
+#include <stdbool.h>
+#include "resources.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct System;
+
+typedef struct Partition {
+    bool valid;               /* false → safety volta a varrer todos */
+    int  parent[MAX_R];       /* union-find dos recursos             */
+    int  head[MAX_R];         /* por raiz: 1º membro (-1 = vazio)    */
+    int  tail[MAX_R];
+    int  size[MAX_R];
+    int  next[MAX_P];         /* lista de membros                    */
+    int  prev[MAX_P];
+    int  anchor[MAX_P];       /* recurso qualquer do Max (-1 = fora) */
+} Partition;
+
+void part_reset(Partition *pt);
+/* Reconstrói a partir dos Max dos n processos (após carga) */
+void part_build(struct System *S);
+/* Inclui/retira o processo pid (registro online, fim de roteiro) */
+void part_add(struct System *S, int pid);
+void part_remove(struct System *S, int pid);
+
+/* Raiz do componente do recurso j (com compressão de caminho) */
+static inline int part_find(Partition *pt, int j) {
+    while (pt->parent[j] != j) {
+        pt->parent[j] = pt->parent[pt->parent[j]];
+        j = pt->parent[j];
+    }
+    return j;
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* PARTITION_H */
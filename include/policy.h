@@ -0,0 +1,77 @@
+#ifndef POLICY_H
+#define POLICY_H
+/* ---------------------------------------------------------------------
+ * policy.h — Interface de políticas de admissão (BANKER, OSTRICH, ...)
+ * Cada política é uma tabela de hooks registrada em policy.c e escolhida
+ * por nome (--mode <nome>). O System guarda o ponteiro resolvido uma vez
+ * por execução; o dispatcher chama direto a decisão de BANKER e OSTRICH
+ * e as demais pela tabela. A checagem de faixa é um helper inline comum
+ * a todas as políticas (a concessão em si, sys_grant/sys_rollback, fica
+ * em simulator.h junto com o estado derivado que ela mantém).
+ * --------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdbool.h>
+#include "resources.h"
+#include "simulator.h"
+#include "process.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Policy {
+    const char *name;            /* nome no CLI (--mode)                      */
+    const char *label;           /* rótulo em resumo/CSV/JSON (ex.: "BANKER") */
+    bool        detect_on_stall; /* roda o detector quando a simulação trava  */
+
+    /* Decide a requisição; se conceder, já aplicou a concessão. Obrigatório. */
+    bool (*on_request)(System *S, Process *P, const int req[MAX_R]);
+    /* Chamado antes de P devolver tudo (fim de roteiro). Opcional.          */
+    void (*on_release)(System *S, Process *P);
+    /* Chamado após uma requisição negada (P vai para BLOCKED). Opcional.    */
+    void (*on_block)(System *S, Process *P, const int req[MAX_R]);
+    /* Chamado ao fim de cada rodada do sim_run (após avançar o relógio).   */
+    void (*on_tick)(System *S);
+
+    /* Export de métricas próprias da política. Opcionais.
+       JSON: escreve pares no formato ",\n  \"chave\": valor".
+       Resumo: escreve o sufixo da linha do stdout (" | k=v ...").          */
+    void (*write_metrics_json)(const System *S, FILE *f);
+    void (*print_summary)(const System *S, FILE *f);
+} Policy;
+
+/* Registro (policy.c) */
+const Policy *policy_find(const char *name);
+int           policy_count(void);
+const Policy *policy_at(int i);
+
+/* Políticas embutidas */
+extern const Policy policy_banker;   /* banker.c  */
+extern const Policy policy_ostrich;  /* ostrich.c */
+extern const Policy policy_ordered;     /* prevention.c */
+extern const Policy policy_wait_die;    /* prevention.c */
+extern const Policy policy_wound_wait;  /* prevention.c */
+extern const Policy policy_claim;       /* claim.c */
+
+/* on_request de BANKER e OSTRICH, chamados direto pelo dispatcher */
+bool banker_on_request(System *S, Process *P, const int req[MAX_R]);
+bool ostrich_on_request(System *S, Process *P, const int req[MAX_R]);
+
+/* ============================
+ * Helpers inline comuns
+ * ============================ */
+
+/* 0 <= req <= Need e req <= Available para todo recurso */
+static inline bool req_within_bounds(const System *S, const Process *P,
+                                     const int req[MAX_R]) {
+    for (int j = 0; j < S->m; ++j) {
+        int r = req[j];
+        if (r < 0 || r > P->Need[j] || r > S->Available[j]) return false;
+    }
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* POLICY_H */
@@ -13,6 +13,8 @@
 extern "C" {
 #endif
 
+struct CoTask;  /* coroutine.h */
+
 /* Encaminhamento: lista de requisições */
 typedef struct ReqList{
     int len;
@@ -39,19 +41,52 @@ void reqlist_rewind(ReqList *R);
 typedef struct Process {
     int     id;                                   /* identificador do processo       */
     PState  state;                                 /* ciclo de vida                   */
-    int     Max[MAX_R];                            /* demanda máxima por recurso      */
-    int     Allocation[MAX_R];                     /* instâncias alocadas             */
-    int     Need[MAX_R];                           /* Need = Max - Allocation         */
+    rc_t    Max[MAX_R];                            /* demanda máxima por recurso      */
+    rc_t    Allocation[MAX_R];                     /* instâncias alocadas             */
+    rc_t    Need[MAX_R];                           /* Need = Max - Allocation         */
     struct  ReqList *script;                       /* sequência de requisições        */
-    uint64_t wait_time_acc;                        /* tempo acumulado bloqueado       */
+    uint64_t wait_time_acc;                        /* ticks acumulados em espera      */
+    uint32_t retries;                              /* pedidos repetidos após negativa */
+    bool     waiting;                              /* espera aberta desde blocked_since */
+    uint64_t ts;                                   /* timestamp (ordem de chegada);
+                                                      preservado em restarts        */
+    uint32_t grants_since_start;                   /* concessões desde o (re)início   */
+    uint32_t aborts;                               /* vezes que foi abortado          */
+    bool     restarted;                            /* abortado e ainda sem concessão  */
+    bool     reacq_pending;                        /* ORDERED: espera pedido + reacq  */
+    rc_t     reacq[MAX_R];                         /* devolvido por pedido fora de ordem */
+    rc_t     Init[MAX_R];                          /* Allocation da carga do cenário  */
+    bool     init_pending;                         /* restart: pede Init antes do roteiro */
+    int      prio;                                 /* prioridade estática (menor = 1º)*/
+    bool     in_ready, in_blocked;                 /* já está na fila do escalonador  */
+    uint64_t arrival_clock;                        /* sim_clock ao chegar (eventos)   */
+    uint64_t finish_clock;                         /* sim_clock ao terminar           */
+    uint64_t blocked_since;                        /* sim_clock ao entrar em BLOCKED  */
+    bool     in_deadlock;                          /* já reportado num deadlock       */
+    struct CoTask *co;                             /* comportamento (NULL = roteiro)  */
 } Process;
 
+/* Fim de uma espera (concessão, aborto ou término): acumula os ticks
+   desde a primeira negativa. O(1) por transição. */
+static inline void proc_end_wait(Process *p, uint64_t now) {
+    if (!p->waiting) return;
+    p->wait_time_acc += now - p->blocked_since;
+    p->waiting = false;
+}
+
 /* ============================
  * Protótipos utilitários
  * ============================ */
 void proc_reset(Process *p, int id);
 void proc_compute_need(Process *p);
 bool proc_invariants_ok(const Process *p);
+/* Pedido corrente: a alocação da carga a readquirir após um restart,
+   senão o próximo item do roteiro ou o pedido pendente da corrotina */
+bool proc_peek_request(const Process *p, int out_req[MAX_R]);
+/* Consome o pedido corrente, já concedido */
+void proc_pop_request(Process *p);
+/* Processo com roteiro sem nada mais a pedir (nem a readquisição) */
+bool proc_script_done(const Process *p);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -1,7 +1,8 @@
 /*
 * Centralizar constantes globais (limites como MAX_P, MAX_R);
 * Definir tipos básicos (apelidos de inteiros);
-* Declarar os enums fundamentais: Mode (banker/ostrich) e PState (ciclo de vida do processo);
+* Declarar os enums fundamentais: PState (ciclo de vida do processo);
+* (as políticas de admissão — banker/ostrich/... — ficam em policy.h)
 * Garantir que todo o resto do projeto possa incluir isso sem dependências cíclicas
 */
 
@@ -21,8 +22,12 @@
  * Limites globais (ajuste conforme necessário)
  * =========================================================== */
 #define MAX_REQS 64     /* número máximo de requisições por processo */
+#ifndef MAX_P
 #define MAX_P 1024      /* número máximo de processos suportados */
-#define MAX_R   32      /* número máximo de tipos de recurso     */
+#endif
+#ifndef MAX_R
+#define MAX_R   32      /* número máximo de tipos de recurso (make MAX_R=4096) */
+#endif
 /* Validações de compilação (evita valores inválidos) */
 _Static_assert(MAX_P > 0, "MAX_P deve ser > 0");
 _Static_assert(MAX_R > 0, "MAX_R deve ser > 0");
@@ -37,19 +42,49 @@ typedef uint32_t u32;
 typedef uint64_t u64;
 
 /* ===========================================================
- * Compatibilidade C++
+ * Largura dos contadores de recurso (Max/Allocation/Need/Available)
+ * Escolha em tempo de compilação: make RC_BITS=8|16|32 (padrão 32).
+ * Com 8/16 bits a tabela de processos encolhe 2-4x e cabe melhor
+ * em cache durante o safety_check(); requisições continuam int.
  * =========================================================== */
-#ifdef __cplusplus
-extern "C" {
+#ifndef RC_BITS
+#define RC_BITS 32
+#endif
+
+#if RC_BITS == 8
+typedef u8      rc_t;
+#define RC_MAX  UINT8_MAX
+#elif RC_BITS == 16
+typedef u16     rc_t;
+#define RC_MAX  UINT16_MAX
+#elif RC_BITS == 32
+typedef int32_t rc_t;   /* mantém sinal: compatível com o código original em int */
+#define RC_MAX  INT32_MAX
+#else
+#error "RC_BITS deve ser 8, 16 ou 32"
 #endif
 
+/* Aritmética com checagem de faixa [0, RC_MAX].
+   Retorna false (sem alterar *x) se o resultado sairia da faixa. */
+static inline bool rc_fits(long long v) {
+    return v >= 0 && v <= (long long)RC_MAX;
+}
+static inline bool rc_add(rc_t *x, int d) {
+    long long v = (long long)*x + d;
+    if (!rc_fits(v)) return false;
+    *x = (rc_t)v;
+    return true;
+}
+static inline bool rc_sub(rc_t *x, int d) {
+    return rc_add(x, -d);
+}
+
 /* ===========================================================
- * Modo de execução do simulador
+ * Compatibilidade C++
  * =========================================================== */
-typedef enum Mode {
-    MODE_BANKER = 0,   /* Evita deadlock (algoritmo do banqueiro) */
-    MODE_OSTRICH       /* Ignora prevenção; detector só para métricas */
-} Mode;
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /* ===========================================================
  * Estado do processo (ciclo de vida no simulador)
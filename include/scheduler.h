@@ -0,0 +1,82 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+/* ---------------------------------------------------------------------
+ * scheduler.h — Ordem de visita dos processos no sim_run
+ * Filas READY/BLOCKED por rodada: anel para FIFO, heap binário (min)
+ * para as ordens com chave (índice, aleatória, prioridade, SRS, LNF).
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include "resources.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct System;
+struct Process;
+
+typedef enum SchedKind {
+    SK_INDEX = 0,  /* 0..n-1 (comportamento original)                 */
+    SK_FIFO,       /* ordem de chegada na fila (anel)                 */
+    SK_RANDOM,     /* aleatória com semente (--seed)                  */
+    SK_PRIORITY,   /* menor Process.prio primeiro                      */
+    SK_SRS,        /* shortest-remaining-script (reqlist_count)        */
+    SK_LNF         /* largest-Need-first (soma de Need)                */
+} SchedKind;
+
+typedef struct SchedEntry {
+    uint64_t key;     /* chave primária (heap)               */
+    uint32_t tie;     /* desempate: ordem de inserção        */
+    int32_t  pid;
+} SchedEntry;
+
+typedef struct SchedQueue {
+    int        len;
+    int        head;          /* início do anel (FIFO) */
+    SchedEntry e[MAX_P];
+} SchedQueue;
+
+typedef struct Scheduler {
+    SchedKind  kind;
+    uint64_t   seed;          /* semente original (--seed)        */
+    uint64_t   rng;           /* estado splitmix64 (SK_RANDOM) */
+    uint32_t   seq;           /* contador de inserções            */
+    int        rcur, bcur;    /* fila corrente de cada par        */
+    SchedQueue ready[2];      /* [rcur] = rodada atual; [rcur^1] = próxima */
+    SchedQueue blocked[2];    /* [bcur] = a varrer nesta rodada            */
+} Scheduler;
+
+/* splitmix64: gerador pequeno e reprodutível (semente → sequência) */
+static inline uint64_t sched_rand_next(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void        sched_init(Scheduler *sc, SchedKind kind, uint64_t seed);
+bool        sched_kind_from_str(const char *s, SchedKind *out);
+const char *sched_kind_str(SchedKind k);
+
+/* Enfileira P na fila READY da próxima rodada (ignora se já está lá) */
+void sched_push_ready(struct System *S, struct Process *P);
+/* Enfileira P na fila BLOCKED corrente (varrida ainda nesta rodada) */
+void sched_push_blocked(struct System *S, struct Process *P);
+
+/* Rodada: troca READY corrente/próxima; pop devolve pid ou -1 */
+void sched_begin_round(Scheduler *sc);
+int  sched_pop_ready(struct System *S);
+/* Varredura de bloqueados: congela a fila corrente; novos bloqueios vão
+   para a outra (próxima rodada) */
+void sched_begin_sweep(Scheduler *sc);
+int  sched_pop_sweep(struct System *S);
+
+int  sched_ready_count(const Scheduler *sc);
+int  sched_blocked_count(const Scheduler *sc);
+bool sched_pending(const Scheduler *sc);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* SCHEDULER_H */
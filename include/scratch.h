@@ -0,0 +1,34 @@
+#ifndef SCRATCH_H
+#define SCRATCH_H
+/* ---------------------------------------------------------------------
+ * scratch.h — Buffers de trabalho por thread
+ * Cada slot cresce até o maior tamanho já pedido e é reaproveitado nas
+ * chamadas seguintes: sem malloc por chamada e sem arrays [MAX_P] na
+ * pilha (com MAX_P grande eles passam do limite da stack).
+ * --------------------------------------------------------------------- */
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    SCR_DETECT = 0,   /* detect_core: demanda, listas, contadores   */
+    SCR_DETECT_UNIT,  /* detect_core: listas das colunas únicas      */
+    SCR_REPORT,       /* DeadlockReport do detector_run              */
+    SCR_BANKER,       /* redução do banqueiro: membros, ordem, Finish */
+    SCR_CLAIM,        /* buscas do claim: pilha e posições visitadas */
+    SCR_COUNT
+} ScratchSlot;
+
+/* Buffer do slot com pelo menos 'bytes' (conteúdo anterior não é
+   preservado de forma útil). NULL se faltou memória. */
+void *scratch_get(ScratchSlot k, size_t bytes);
+
+/* Libera os buffers da thread corrente (fim de uma worker) */
+void scratch_free(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* SCRATCH_H */
@@ -0,0 +1,58 @@
+#ifndef SERVER_H
+#define SERVER_H
+/* ---------------------------------------------------------------------
+ * server.h — Controle de admissão online (--serve) e gerador de carga
+ * Um System fica residente; clientes falam um protocolo de linhas por
+ * socket Unix (ou stdin/stdout com "-"). Cada pedido passa pelo mesmo
+ * dispatcher do sim_run (handle_request_current_mode).
+ *
+ * Protocolo (uma linha por comando, inteiros separados por espaço):
+ *   I a0 .. a{m-1}      reinicia o System com esse Available   → K
+ *   P x0 .. x{m-1}      registra processo com Max = x          → P <pid>
+ *   Q pid r0 .. r{m-1}  pede r                                 → G | D | X (abortado)
+ *   L pid r0 .. r{m-1}  devolve r (parcial)                    → K
+ *   F pid               termina: devolve tudo e libera o pid   → K
+ *   S                   estatísticas                           → S k=v ...
+ * Erros → "E <motivo>". Respostas saem na ordem dos comandos.
+ * Cada pid pertence à conexão que o registrou: Q/L/F de outra conexão
+ * recebem "E pid", e os pids de uma conexão que cai são terminados.
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include "resources.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct Policy;
+
+typedef struct ServerConfig {
+    const char          *path;          /* socket Unix; "-" = stdin/stdout */
+    const struct Policy *policy;
+    int                  m;
+    int                  avail[MAX_R];  /* Available inicial (--avail)     */
+    const char          *metrics_path;  /* JSON ao encerrar (opcional)     */
+} ServerConfig;
+
+typedef struct LoadGenConfig {
+    const char *path;      /* socket do servidor               */
+    int         clients;   /* conexões simultâneas             */
+    uint64_t    ops;       /* pedidos Q no total               */
+    int         m;
+    int         max_claim; /* Max por recurso de cada processo */
+    uint64_t    seed;
+    const char *json_path; /* relatório (opcional)             */
+} LoadGenConfig;
+
+/* Roda até EOF (stdin) ou SIGINT/SIGTERM; 0 = ok */
+int server_run(const ServerConfig *cfg);
+
+/* Laço fechado: cada cliente mantém um pedido em voo; mede decisões/s
+   e percentis de latência ida-e-volta. 0 = ok */
+int loadgen_run(const LoadGenConfig *cfg);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* SERVER_H */
@@ -0,0 +1,53 @@
+#ifndef SHARD_H
+#define SHARD_H
+/* ---------------------------------------------------------------------
+ * shard.h — Simulação particionada em processos do SO (--shards K)
+ * A tabela de processos é dividida em K blocos; cada worker (fork) roda
+ * sim_run() no seu bloco com um Available local (escrow). O Available
+ * autoritativo fica num segmento compartilhado (pool) protegido por um
+ * mutex entre processos; só há commit no pool quando a decisão local
+ * precisa de recursos além do escrow.
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "simulator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHARD_MAX 64
+
+typedef struct ShardStat {
+    Metrics  metrics;
+    uint64_t sim_clock;      /* rodadas do worker                        */
+    uint64_t commits;        /* empréstimos do pool que viraram concessão */
+    uint64_t aborted;        /* empréstimos devolvidos (decisão negou)    */
+    uint64_t returns;        /* devoluções de sobra ao pool               */
+    uint64_t rescues;        /* processos escoltados com todos travados   */
+    double   wall_s;
+    int      procs;
+    bool     ok;
+} ShardStat;
+
+typedef struct ShardResult {
+    int       shards;
+    bool      stalled;       /* terminou com processos vivos (escrow preso) */
+    double    wall_s;
+    ShardStat stat[SHARD_MAX];
+} ShardResult;
+
+/*
+ * Roda S (já carregado) em 'shards' workers. Ao voltar, S tem as métricas
+ * somadas, sim_clock = maior makespan e estado/finish_clock de cada
+ * processo, para o resumo e o JSON de sempre. Scripts são herdados pelo
+ * fork (copy-on-write).
+ */
+bool shard_run(System *S, int shards, ShardResult *out);
+void shard_print_summary(const ShardResult *r, FILE *f);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* SHARD_H */
@@ -9,40 +9,233 @@
 #include "resources.h"
 #include "metrics.h"
 #include "process.h"
+#include "scheduler.h"
+#include "detector.h"
+#include "partition.h"
+#include "unitbits.h"
+#include "claim.h"
+#include "events.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+struct Policy;  /* policy.h */
+
 /* ============================
  * Estrutura do sistema
  * ============================ */
 typedef struct System {
     int      n;                                    /* # de processos ativos           */
     int      m;                                    /* # de tipos de recursos          */
-    int      Available[MAX_R];                     /* instâncias livres por recurso   */
+    rc_t     Available[MAX_R];                     /* instâncias livres por recurso   */
     Process  procs[MAX_P];                         /* tabela de processos             */
-    Mode     mode;                                 /* BANKER ou OSTRICH               */
+    const struct Policy *policy;                   /* política de admissão (--mode)   */
     uint64_t sim_clock;                            /* “tempo” lógico da simulação     */
     Metrics  metrics;                              /* contadores/tempo de execução    */
+    int      n_finished;                           /* processos em P_FINISHED         */
+    DetectConfig detect_cfg;                       /* gatilho do detector (--detect)  */
+    DetectState  detect_st;                        /* agenda corrente do detector     */
+    EventConfig  ev_cfg;                           /* motor e tempos (--engine ...)   */
+    const char  *fault;                            /* erro interno que parou a execução (NULL = ok) */
+
+    /* Holders por recurso (políticas de prevenção; ver prevention.c) */
+    int      holder_old[MAX_R];                    /* pid de menor ts que detém j     */
+    int      holder_young[MAX_R];                  /* pid de maior ts que detém j     */
+    bool     holders_valid;                        /* false → reconstruir no uso      */
+
+    /* Envelope de Need (atalho O(m) do BANKER; mantido por sys_need_update) */
+    rc_t     need_max[MAX_R];                      /* maior Need[j] entre os processos */
+    int      need_max_cnt[MAX_R];                  /* quantos têm Need[j] == need_max  */
+    bool     need_max_valid[MAX_R];                /* false → recomputar no uso       */
+
+    /* Componentes independentes (safety só no componente do requisitante) */
+    Partition part;
+
+    /* Manter no fim: sim_clone() copia tudo antes daqui */
+    Scheduler sched;                               /* filas READY/BLOCKED (--sched)   */
+
+    /* Colunas de instância única em bitsets (safety/detector). Fica fora
+       da cópia do sim_clone: o destino reconstrói no primeiro uso. */
+    UnitBits  bits;
+
+    /* Grafo de reivindicação (--mode claim; ver claim.h). Só claim.c o
+       monta; nas demais políticas fica inválido. Fora da cópia do sim_clone. */
+    ClaimGraph cg;
+
+    /* Envelope seguro por processo (BANKER; ver banker.c): pedido de Pi
+       com req <= env_slack[i] - env_debt é seguro sem safety. Validade por
+       época: montado por componente, vale enquanto env_at[i] for a época
+       do componente e esta for maior que env_floor. Também fora da cópia
+       do sim_clone. */
+    uint64_t env_gen;                              /* última época emitida            */
+    uint64_t env_floor;                            /* épocas <= floor não valem       */
+    uint64_t env_comp[MAX_R];                      /* por raiz: época da montagem     */
+    uint64_t env_at[MAX_P];                        /* época em que Pi entrou (0 = fora) */
+    int      env_debt[MAX_R];                      /* concedido desde a montagem      */
+    rc_t     env_slack[MAX_P * MAX_R];             /* linha de Pi em i*m: min(Work_k - Need_k) antes dele */
 } System;
 
+/* ============================
+ * Estado derivado e concessão
+ * ============================ */
+/*
+ * Envelope de Need: um Need[j] foi de 'old' para 'now'. Subir é O(1);
+ * baixar também, exceto quando o último processo no máximo sai dele:
+ * aí a coluna é marcada inválida e recomputada (O(n)) no próximo uso.
+ */
+static inline void sys_need_update(System *S, int j, rc_t old, rc_t now) {
+    if (!S->need_max_valid[j] || old == now) return;
+    if (now > S->need_max[j]) {
+        S->need_max[j] = now;
+        S->need_max_cnt[j] = 1;
+        return;
+    }
+    if (now == S->need_max[j]) S->need_max_cnt[j]++;
+    if (old == S->need_max[j] && --S->need_max_cnt[j] == 0) S->need_max_valid[j] = false;
+}
+
+/* Envelopes seguros (banker.c): época do componente da coluna j */
+static inline int sys_env_slot(System *S, int j) {
+    return S->part.valid ? part_find(&S->part, j) : 0;
+}
+
+/* Todos os envelopes montados até aqui deixam de valer (O(1)) */
+static inline void sys_env_invalidate(System *S) {
+    S->env_floor = ++S->env_gen;
+}
+
+/*
+ * Envelope seguro: r unidades de j concedidas a 'pid'. Dentro da folga a
+ * sequência segura da montagem continua valendo e só a dívida cresce;
+ * fora dela (ou Pi fora da sequência), o envelope do componente é
+ * descartado. Devoluções só aumentam as folgas e não passam por aqui.
+ */
+static inline void sys_env_grant(System *S, int pid, int j, int r) {
+    if (S->env_gen == S->env_floor) return;        /* nenhuma montagem viva */
+    int c = sys_env_slot(S, j);
+    uint64_t g = S->env_comp[c];
+    if (g <= S->env_floor) return;
+    if (S->env_at[pid] != g || r > (int)S->env_slack[pid * S->m + j] - S->env_debt[j]) {
+        S->env_comp[c] = 0;
+        return;
+    }
+    S->env_debt[j] += r;
+}
+
+/* Carga/reset/início de execução: envelopes, bitsets e grafo do claim
+   recomputados no uso */
+static inline void sys_need_invalidate(System *S) {
+    for (int j = 0; j < MAX_R; ++j) S->need_max_valid[j] = false;
+    S->bits.valid = false;
+    S->cg.valid = false;
+    sys_env_invalidate(S);
+}
+
+/* Need/Allocation de P na coluna j mudaram (Need era old_need): envelope
+   de Need, bitsets e, só se o claim o montou, o grafo acompanham */
+static inline void sys_cell_changed(System *S, const Process *P, int j, rc_t old_need) {
+    sys_need_update(S, j, old_need, P->Need[j]);
+    ub_set(&S->bits, P->id, j, P->Need[j], P->Allocation[j]);
+    if (S->cg.valid && ub_is_unit(&S->bits, j))
+        cg_set(&S->cg, P->id, j, P->Need[j] != 0, P->Allocation[j] != 0);
+}
+
+/*
+ * sys_grant / sys_rollback
+ * Movem 'req' entre Available e Allocation/Need com checagem de faixa.
+ * Primeiro valida todas as colunas e só então aplica (tudo-ou-nada).
+ */
+static inline bool sys_grant(System *S, Process *P, const int req[MAX_R]) {
+    for (int j = 0; j < S->m; ++j) {
+        int r = req[j];
+        if (!rc_fits((long long)S->Available[j] - r)) return false;
+        if (!rc_fits((long long)P->Allocation[j] + r)) return false;
+        if (!rc_fits((long long)P->Need[j] - r))       return false;
+    }
+    for (int j = 0; j < S->m; ++j) {
+        int r = req[j];
+        S->Available[j]  = (rc_t)(S->Available[j]  - r);
+        P->Allocation[j] = (rc_t)(P->Allocation[j] + r);
+        P->Need[j]       = (rc_t)(P->Need[j]       - r);
+        if (r) {
+            sys_cell_changed(S, P, j, (rc_t)(P->Need[j] + r));
+            sys_env_grant(S, P->id, j, r);
+        }
+    }
+    return true;
+}
+
+static inline bool sys_rollback(System *S, Process *P, const int req[MAX_R]) {
+    for (int j = 0; j < S->m; ++j) {
+        int r = req[j];
+        if (!rc_fits((long long)S->Available[j] + r)) return false;
+        if (!rc_fits((long long)P->Allocation[j] - r)) return false;
+        if (!rc_fits((long long)P->Need[j] + r))       return false;
+    }
+    for (int j = 0; j < S->m; ++j) {
+        int r = req[j];
+        S->Available[j]  = (rc_t)(S->Available[j]  + r);
+        P->Allocation[j] = (rc_t)(P->Allocation[j] - r);
+        P->Need[j]       = (rc_t)(P->Need[j]       + r);
+        if (r) sys_cell_changed(S, P, j, (rc_t)(P->Need[j] - r));
+    }
+    return true;
+}
 
 
 /* ============================
  * Interface do simulador
  * ============================ */
-void sim_init(System *s, int n, int m, Mode mode);
+void sim_init(System *s, int n, int m, const struct Policy *policy);
 void sim_reset(System *s);
 void sim_finalize(System *s);
 bool sys_invariants_ok(const System *s);
 void sys_load_from_arrays(System *s,
                           const int available0[MAX_R],
-                          const int maxs[MAX_P][MAX_R],
-                          const int allocs[MAX_P][MAX_R],
-                          struct ReqList *scripts[MAX_P]);
+                          const int maxs[][MAX_R],      /* s->n linhas */
+                          const int allocs[][MAX_R],
+                          struct ReqList *scripts[]);
 void sim_run(System *s);
 
+/* Aborta P: devolve tudo, restaura Need = Max, rebobina o roteiro e o
+   deixa READY (mantém o timestamp). Contabiliza aborts/wasted_grants. */
+void sim_abort_process(System *s, Process *p);
+
+/* Copia o estado de src para dst sem as filas do escalonador (só os n
+   processos ativos). Scripts continuam apontando para os de src. */
+void sim_clone(System *dst, const System *src);
+
+/* Contabilidade de tempo: sim_metrics_begin fixa as instâncias de cada
+   recurso (uma varredura por execução); sim_advance_clock move o relógio
+   integrando as unidades alocadas no intervalo (O(m)). */
+void sim_metrics_begin(System *s);
+void sim_advance_clock(System *s, uint64_t to);
+
+/* Termina P: on_release da política, devolve tudo, sai da partição e
+   marca FINISHED com finish_clock = sim_clock + 1 (fim da rodada) */
+void sim_finish_process(System *s, Process *p);
+
+/* Devolve toda a alocação de P a Available e zera Max/Allocation/Need */
+void release_all_resources(System *s, Process *p);
+
+/* Caminho comum de decisão (dispatcher.c): métricas + política + log */
+bool handle_request_current_mode(System *s, Process *p, const int req[MAX_R]);
+
+/* Distribuição de uma grandeza por processo. Turnaround só dos
+   terminados; espera ainda aberta conta até o sim_clock. */
+typedef enum ProcStat { PS_WAIT = 0, PS_RETRIES, PS_TURNAROUND } ProcStat;
+typedef struct ProcDist {
+    int      count;
+    double   mean;
+    uint64_t p50, p99, max;           /* nearest-rank */
+} ProcDist;
+void sim_proc_dist(const System *s, ProcStat k, ProcDist *out);
+
+/* Turnaround (finish_clock) dos processos terminados: média e p99 */
+void sim_turnaround_stats(const System *s, double *mean, uint64_t *p99);
+
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,70 @@
+#ifndef STATS_H
+#define STATS_H
+/* ---------------------------------------------------------------------
+ * stats.h — Página de estatísticas ao vivo (--stats arquivo)
+ * O simulador mapeia o arquivo (MAP_SHARED) e, a cada avanço do relógio,
+ * copia alguns contadores de Metrics, sim_clock e o tamanho das filas
+ * READY/BLOCKED sob um seqlock: um escritor, leitores sem trava que
+ * repetem a leitura se pegarem uma escrita pela metade. Publicar são só
+ * stores em memória (sem syscalls). `os-deadlock-sim stat arquivo`
+ * anexa ao arquivo e imprime taxas uma vez por segundo.
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct System;
+
+#define STATS_MAGIC   "OSDLSTA"
+#define STATS_VERSION 1u
+
+/* Valores publicados (índices de StatsPage.v) */
+typedef enum StatsField {
+    ST_CLOCK = 0,
+    ST_REQUESTS,
+    ST_GRANTS,
+    ST_BLOCKS,
+    ST_ABORTS,
+    ST_SAFETY_CALLS,
+    ST_SAFETY_NS,       /* ns acumulados; o leitor divide os deltas   */
+    ST_DETECTOR_CALLS,
+    ST_DEADLOCKS,
+    ST_EVENTS,
+    ST_READY,           /* entradas nas filas do escalonador         */
+    ST_BLOCKED,
+    ST_FINISHED,
+    ST_DONE,            /* 1 depois do último publish                */
+    ST_COUNT
+} StatsField;
+
+typedef struct StatsPage {
+    char     magic[8];
+    uint32_t version;
+    uint32_t writer_pid;
+    int32_t  n, m;
+    char     mode[16];
+    char     scenario[32];
+    _Atomic uint64_t seq;            /* ímpar = escrita em andamento */
+    _Atomic uint64_t v[ST_COUNT];
+} StatsPage;
+
+/* Escritor: cria/trunca o arquivo e mapeia a página */
+bool stats_open(const char *path, const struct System *S, const char *scenario);
+/* Publish final com ST_DONE = 1 e desmapeia (o arquivo fica) */
+void stats_close(const struct System *S);
+bool stats_enabled(void);
+/* Hot path: um seqlock de ST_COUNT stores; no-op se desligado */
+void stats_publish(const struct System *S);
+
+/* Subcomando `stat`: anexa e imprime taxas a cada segundo até o
+   escritor terminar. Retorna o código de saída do processo. */
+int  stats_watch(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* STATS_H */
@@ -0,0 +1,29 @@
+#ifndef TIMING_H
+#define TIMING_H
+/* ---------------------------------------------------------------------
+ * timing.h — Relógio monotônico em ns (medição de overhead no host)
+ * Requer _POSIX_C_SOURCE >= 199309L (definido no Makefile).
+ * --------------------------------------------------------------------- */
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline unsigned long long now_ns(void) {
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC_RAW)
+    /* Usa RAW quando disponível (Linux), mais estável contra NTP */
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else
+    /* Fallback POSIX portátil */
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (unsigned long long)ts.tv_sec * 1000000000ull
+         + (unsigned long long)ts.tv_nsec;
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TIMING_H */
@@ -0,0 +1,47 @@
+#ifndef TRACE_H
+#define TRACE_H
+/* ---------------------------------------------------------------------
+ * trace.h — Export no formato Chrome trace-event (Perfetto/about:tracing)
+ * Duas linhas do tempo no mesmo arquivo:
+ *   "simulado": um track por processo com spans READY/BLOCKED/RUNNING/
+ *               FINISHED (1 tick = 1 ms) e counters de Available;
+ *   "host":     spans de safety_check, detector e flush do logger, em
+ *               tempo real (ns desde o trace_open).
+ * Tudo fica em buffers na memória; o JSON é escrito uma vez no
+ * trace_close(), fora dos trechos medidos.
+ * --------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include "resources.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct System;
+struct Process;
+
+typedef enum TraceHost {
+    TR_HOST_SAFETY = 0,   /* safety_check (BANKER)           */
+    TR_HOST_DETECT,       /* detect_deadlock_* (detector.c)  */
+    TR_HOST_LOG_FLUSH     /* fflush do CSV (logger.c)        */
+} TraceHost;
+
+bool trace_open(const char *path, int m);
+/* Escreve o JSON (estado final fecha os spans abertos) e libera */
+bool trace_close(const struct System *S);
+bool trace_enabled(void);
+
+/* Estado corrente de P no tick atual; só grava se mudou */
+void trace_state(const struct System *S, const struct Process *P);
+/* Todos os processos ativos (início da execução) */
+void trace_states_all(const struct System *S);
+/* Available de cada recurso (counter) no tick atual */
+void trace_available(const struct System *S);
+/* Span de host [t0, t1] em ns de now_ns() */
+void trace_host(TraceHost kind, unsigned long long t0, unsigned long long t1);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TRACE_H */
@@ -0,0 +1,73 @@
+#ifndef UNITBITS_H
+#define UNITBITS_H
+/* ---------------------------------------------------------------------
+ * unitbits.h — Recursos de instância única em bitsets (tipo lock)
+ * Uma coluna com uma única instância (Available + ΣAllocation == 1 e
+ * nenhum Max acima de 1) só assume 0/1 em Need, Allocation e Work.
+ * Essas colunas viram bits de palavras de 64: Need <= Work passa a ser
+ * (need & ~work) == 0 e devolver a alocação vira work |= alloc, 64
+ * recursos por instrução. As demais colunas ("contadas") seguem nos
+ * laços escalares; safety_check() e o detector juntam as duas partes.
+ * --------------------------------------------------------------------- */
+#include <stdbool.h>
+#include "resources.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct System;
+
+#define UB_WORDS  ((MAX_R + 63) / 64)
+
+typedef struct UnitBits {
+    bool valid;                    /* false → ub_build no próximo uso    */
+    int  words;                    /* palavras em uso: (m + 63) / 64     */
+    int  n_unit;                   /* colunas de instância única         */
+    int  n_counted;
+    int  counted[MAX_R];           /* colunas restantes, em ordem        */
+    u64  unit[UB_WORDS];           /* bit j = coluna j é de instância única */
+    u64  avail[UB_WORDS];          /* bit j = Available[j] == 1          */
+    u64  need[MAX_P][UB_WORDS];    /* bit j = Need[i][j] == 1            */
+    u64  alloc[MAX_P][UB_WORDS];   /* bit j = Allocation[i][j] == 1      */
+} UnitBits;
+
+/* Classifica as colunas e monta os bitsets dos n processos: O(n·m) */
+void ub_build(struct System *S);
+
+/* Reconstrói só se invalidado (carga/reset/início de execução) */
+void ub_ensure(struct System *S);
+
+/* Coluna j é de instância única (bitsets montados) */
+static inline bool ub_is_unit(const UnitBits *b, int j) {
+    return b->valid && (b->unit[j >> 6] >> (j & 63) & 1);
+}
+
+/* Espelha Need/Allocation do processo pid na coluna j (se for única).
+   A instância só troca de dono via Allocation: quando o bit de pid muda,
+   o de Available muda junto. */
+static inline void ub_set(UnitBits *b, int pid, int j, rc_t need, rc_t alloc) {
+    if (!ub_is_unit(b, j)) return;
+    int w = j >> 6;
+    u64 bit = 1ull << (j & 63);
+    if ((need != 0) != ((b->need[pid][w] & bit) != 0)) b->need[pid][w] ^= bit;
+    if (((b->alloc[pid][w] & bit) != 0) != (alloc != 0)) {
+        b->alloc[pid][w] ^= bit;
+        b->avail[w]      ^= bit;
+    }
+}
+
+/* need <= work em todas as colunas únicas */
+static inline bool ub_leq(const u64 *need, const u64 *work, int words) {
+    for (int w = 0; w < words; ++w) if (need[w] & ~work[w]) return false;
+    return true;
+}
+
+static inline void ub_or(u64 *work, const u64 *alloc, int words) {
+    for (int w = 0; w < words; ++w) work[w] |= alloc[w];
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* UNITBITS_H */
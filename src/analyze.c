@@ -0,0 +1,377 @@
+/* ---------------------------------------------------------------------
+ * analyze.c — Leitura em uma passada do log de eventos (CSV ou binário)
+ * O arquivo inteiro é mapeado e lido em ordem (POSIX_MADV_SEQUENTIAL);
+ * o CSV é quebrado com um parser de inteiros sem strtol nem cópias, o
+ * binário é lido registro a registro. Cada evento passa por an_event,
+ * que só atualiza contadores em tabelas fixas.
+ * --------------------------------------------------------------------- */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "analyze.h"
+#include "logger.h"
+#include "timing.h"
+
+/* ============================
+ * Acúmulo por evento
+ * ============================ */
+static void an_event(Analysis *A, uint64_t clock, int pid, bool granted,
+                     const int32_t *req, const int32_t *avail)
+{
+    if (pid < 0 || pid >= MAX_P) {
+        A->bad_records++;
+        return;
+    }
+    if (A->events == 0) A->clock_first = clock;
+    A->clock_last = clock;
+    A->events++;
+    if (pid > A->max_pid) A->max_pid = pid;
+
+    AnPid *p = &A->pid[pid];
+    p->requests++;
+    if (granted) {
+        A->grants++;
+        p->grants++;
+        if (p->since >= 0) {
+            uint64_t d = clock - (uint64_t)p->since;
+            p->episodes++;
+            p->blocked_ticks += d;
+            if (d > p->blocked_max) p->blocked_max = d;
+            p->since = -1;
+        }
+    } else {
+        A->denies++;
+        p->denies++;
+        if (p->since < 0) p->since = (int64_t)clock;
+    }
+
+    bool short_col = false;
+    for (int j = 0; j < A->m; ++j) {
+        AnRes *r = &A->res[j];
+        if (avail[j] < r->avail_min) {
+            r->avail_min = avail[j];
+            r->avail_min_clock = clock;
+        }
+        if (req[j] <= 0) continue;
+        if (granted) {
+            r->grants++;
+            r->units_granted += (uint64_t)req[j];
+        } else {
+            r->denies++;
+            if (req[j] > avail[j]) {
+                r->short_denies++;
+                short_col = true;
+            }
+        }
+    }
+    if (!granted && !short_col) A->unsafe_denies++;
+}
+
+/* Bloqueios ainda abertos contam até o último evento */
+static void an_close(Analysis *A) {
+    for (int i = 0; i <= A->max_pid; ++i) {
+        AnPid *p = &A->pid[i];
+        if (p->since < 0) continue;
+        uint64_t d = A->clock_last - (uint64_t)p->since;
+        p->blocked_ticks += d;
+        if (d > p->blocked_max) p->blocked_max = d;
+    }
+}
+
+/* ============================
+ * CSV
+ * ============================ */
+static inline bool parse_i64(const char **pp, const char *end, int64_t *out) {
+    const char *p = *pp;
+    bool neg = p < end && *p == '-';
+    if (neg) ++p;
+    if (p >= end || (unsigned)(*p - '0') > 9u) return false;
+    int64_t v = 0;
+    while (p < end && (unsigned)(*p - '0') <= 9u) v = v * 10 + (*p++ - '0');
+    *out = neg ? -v : v;
+    *pp = p;
+    return true;
+}
+
+/* Consome o separador ',' (ou fim de linha quando last) */
+static inline bool expect_sep(const char **pp, const char *end, bool last) {
+    const char *p = *pp;
+    if (!last) {
+        if (p >= end || *p != ',') return false;
+        *pp = p + 1;
+        return true;
+    }
+    if (p < end && *p == '\r') ++p;
+    if (p < end && *p != '\n') return false;
+    *pp = p < end ? p + 1 : p;
+    return true;
+}
+
+static const char *next_line(const char *p, const char *end) {
+    const char *nl = memchr(p, '\n', (size_t)(end - p));
+    return nl ? nl + 1 : end;
+}
+
+static bool parse_csv(Analysis *A, const char *p, const char *end, char *err, size_t len) {
+    /* Header: clock,pid,mode,granted,req0..,avail0.. → m pelas vírgulas */
+    const char *eol = next_line(p, end);
+    if (eol - p < 7 || memcmp(p, "clock,", 6) != 0) {
+        snprintf(err, len, "não é um log CSV do simulador (header)");
+        return false;
+    }
+    int commas = 0;
+    for (const char *q = p; q < eol; ++q) commas += *q == ',';
+    int m = (commas + 1 - 4) / 2;
+    if (m < 0 || m > MAX_R || 4 + 2 * m != commas + 1) {
+        snprintf(err, len, "header com colunas inesperadas");
+        return false;
+    }
+    A->m = m;
+    p = eol;
+
+    int32_t req[MAX_R], avail[MAX_R];
+    while (p < end) {
+        const char *line = p;
+        int64_t clock, pid, granted, v = 0;
+        bool ok = parse_i64(&p, end, &clock) && expect_sep(&p, end, false) &&
+                  parse_i64(&p, end, &pid) && expect_sep(&p, end, false);
+        if (ok) {
+            /* modo: texto até a vírgula (guardado do 1º evento) */
+            const char *mode = p;
+            while (p < end && *p != ',' && *p != '\n') ++p;
+            if (!A->mode[0] && p > mode) {
+                size_t k = (size_t)(p - mode) < sizeof A->mode - 1 ? (size_t)(p - mode) : sizeof A->mode - 1;
+                memcpy(A->mode, mode, k);
+            }
+            ok = expect_sep(&p, end, false) && parse_i64(&p, end, &granted) &&
+                 expect_sep(&p, end, m == 0);
+        }
+        for (int j = 0; ok && j < 2 * m; ++j) {
+            ok = parse_i64(&p, end, &v) && expect_sep(&p, end, j == 2 * m - 1);
+            if (j < m) req[j] = (int32_t)v;
+            else       avail[j - m] = (int32_t)v;
+        }
+        if (!ok) {
+            if (line < end && *line != '\n') A->bad_records++;
+            p = next_line(line, end);
+            continue;
+        }
+        an_event(A, (uint64_t)clock, (int)pid, granted != 0, req, avail);
+    }
+    return true;
+}
+
+/* ============================
+ * Binário
+ * ============================ */
+static bool parse_bin(Analysis *A, const char *p, const char *end, char *err, size_t len) {
+    LogBinHeader h;
+    memcpy(&h, p, sizeof h);
+    if (h.version != LOG_BIN_VERSION || h.m < 0 || h.m > MAX_R) {
+        snprintf(err, len, "log binário com versão/m incompatível");
+        return false;
+    }
+    A->m = h.m;
+    memcpy(A->mode, h.mode, sizeof A->mode);
+    A->mode[sizeof A->mode - 1] = '\0';
+    p += sizeof h;
+
+    size_t rec = LOG_BIN_RECORD(h.m);
+    int32_t r[4 + 2 * MAX_R];
+    for (; (size_t)(end - p) >= rec; p += rec) {
+        uint64_t clock;
+        memcpy(r, p, rec);
+        memcpy(&clock, r, sizeof clock);
+        an_event(A, clock, r[2], r[3] != 0, &r[4], &r[4 + h.m]);
+    }
+    if (p != end) A->bad_records++;   /* registro final cortado */
+    return true;
+}
+
+/* ============================
+ * Entrada
+ * ============================ */
+bool analyze_log(const char *path, Analysis *A, char *err, size_t len) {
+    memset(A, 0, sizeof *A);
+    A->max_pid = -1;
+    for (int i = 0; i < MAX_P; ++i) A->pid[i].since = -1;
+    for (int j = 0; j < MAX_R; ++j) A->res[j].avail_min = INT64_MAX;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        snprintf(err, len, "não abriu %s: %s", path, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        snprintf(err, len, "%s vazio ou ilegível", path);
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    unsigned long long t0 = now_ns();
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        snprintf(err, len, "mmap falhou: %s", strerror(errno));
+        return false;
+    }
+    posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+
+    const char *p = map, *end = p + size;
+    A->bytes = size;
+    A->binary = size >= sizeof(LogBinHeader) && memcmp(p, LOG_BIN_MAGIC, sizeof LOG_BIN_MAGIC) == 0;
+    bool ok = A->binary ? parse_bin(A, p, end, err, len) : parse_csv(A, p, end, err, len);
+    munmap(map, size);
+    if (ok) an_close(A);
+    A->wall_s = (double)(now_ns() - t0) / 1e9;
+    for (int j = 0; j < A->m; ++j) {
+        if (A->res[j].avail_min == INT64_MAX) A->res[j].avail_min = 0;
+    }
+    return ok;
+}
+
+/* ============================
+ * Relatórios
+ * ============================ */
+static double mb_per_s(const Analysis *A) {
+    return A->wall_s > 0.0 ? (double)A->bytes / 1e6 / A->wall_s : 0.0;
+}
+
+/* Índices dos 'k' maiores por chave (ordem decrescente, empate → menor id) */
+static int top_k(const uint64_t *key, int count, int k, int *out) {
+    int got = 0;
+    for (int i = 0; i < count; ++i) {
+        if (key[i] == 0) continue;
+        if (got == k && key[i] <= key[out[k - 1]]) continue;
+        int pos = got < k ? got++ : k - 1;
+        while (pos > 0 && key[out[pos - 1]] < key[i]) {
+            out[pos] = out[pos - 1];
+            --pos;
+        }
+        out[pos] = i;
+    }
+    return got;
+}
+
+void analyze_print_summary(const Analysis *A, const char *path, FILE *f) {
+    uint64_t key[MAX_R];
+    int hot[MAX_R];
+    for (int j = 0; j < A->m; ++j) key[j] = A->res[j].short_denies;
+    int nh = top_k(key, A->m, A->m, hot);
+
+    fprintf(f, "analyze log=%s format=%s mode=%s m=%d | events=%llu grants=%llu denies=%llu"
+               " unsafe_denies=%llu bad=%llu | clock=[%llu,%llu] | bytes=%llu wall_s=%.3f MB_per_s=%.1f",
+            path, A->binary ? "bin" : "csv", A->mode[0] ? A->mode : "?", A->m,
+            (unsigned long long)A->events, (unsigned long long)A->grants,
+            (unsigned long long)A->denies, (unsigned long long)A->unsafe_denies,
+            (unsigned long long)A->bad_records,
+            (unsigned long long)A->clock_first, (unsigned long long)A->clock_last,
+            (unsigned long long)A->bytes, A->wall_s, mb_per_s(A));
+    if (nh > 0) fprintf(f, " | hottest=R%d short_denies=%llu", hot[0],
+                        (unsigned long long)A->res[hot[0]].short_denies);
+    fputc('\n', f);
+}
+
+void analyze_write_json(const Analysis *A, const char *path, FILE *f) {
+    fprintf(f,
+        "{\n"
+        "  \"log\": \"%s\",\n"
+        "  \"format\": \"%s\",\n"
+        "  \"mode\": \"%s\",\n"
+        "  \"m\": %d,\n"
+        "  \"bytes\": %llu,\n"
+        "  \"events\": %llu,\n"
+        "  \"grants\": %llu,\n"
+        "  \"denies\": %llu,\n"
+        "  \"unsafe_denies\": %llu,\n"
+        "  \"bad_records\": %llu,\n"
+        "  \"clock_first\": %llu,\n"
+        "  \"clock_last\": %llu,\n"
+        "  \"wall_s\": %.6f,\n"
+        "  \"mb_per_s\": %.1f,\n"
+        "  \"pids\": [",
+        path, A->binary ? "bin" : "csv", A->mode[0] ? A->mode : "?", A->m,
+        (unsigned long long)A->bytes, (unsigned long long)A->events,
+        (unsigned long long)A->grants, (unsigned long long)A->denies,
+        (unsigned long long)A->unsafe_denies, (unsigned long long)A->bad_records,
+        (unsigned long long)A->clock_first, (unsigned long long)A->clock_last,
+        A->wall_s, mb_per_s(A));
+
+    bool first = true;
+    for (int i = 0; i <= A->max_pid; ++i) {
+        const AnPid *p = &A->pid[i];
+        if (!p->requests) continue;
+        fprintf(f, "%s\n    {\"pid\": %d, \"requests\": %llu, \"grants\": %llu, \"denies\": %llu,"
+                   " \"block_episodes\": %llu, \"blocked_ticks\": %llu, \"blocked_max\": %llu,"
+                   " \"blocked_at_end\": %s}",
+                first ? "" : ",", i, (unsigned long long)p->requests,
+                (unsigned long long)p->grants, (unsigned long long)p->denies,
+                (unsigned long long)p->episodes, (unsigned long long)p->blocked_ticks,
+                (unsigned long long)p->blocked_max, p->since >= 0 ? "true" : "false");
+        first = false;
+    }
+    fprintf(f, "\n  ],\n  \"resources\": [");
+    for (int j = 0; j < A->m; ++j) {
+        const AnRes *r = &A->res[j];
+        fprintf(f, "%s\n    {\"id\": %d, \"grants\": %llu, \"denies\": %llu, \"short_denies\": %llu,"
+                   " \"units_granted\": %llu, \"avail_min\": %lld, \"avail_min_clock\": %llu}",
+                j ? "," : "", j, (unsigned long long)r->grants, (unsigned long long)r->denies,
+                (unsigned long long)r->short_denies, (unsigned long long)r->units_granted,
+                (long long)r->avail_min, (unsigned long long)r->avail_min_clock);
+    }
+
+    /* Hotspots: recursos por negativas em que faltou a coluna; pids por
+       ticks bloqueados */
+    uint64_t rkey[MAX_R];
+    int rhot[MAX_R];
+    for (int j = 0; j < A->m; ++j) rkey[j] = A->res[j].short_denies;
+    int nr = top_k(rkey, A->m, A->m, rhot);
+    fprintf(f, "\n  ],\n  \"hotspots\": {\"resources\": [");
+    for (int k = 0; k < nr; ++k) fprintf(f, "%s%d", k ? ", " : "", rhot[k]);
+
+    static uint64_t pkey[MAX_P];
+    int phot[ANALYZE_TOP];
+    for (int i = 0; i <= A->max_pid; ++i) pkey[i] = A->pid[i].blocked_ticks;
+    int np = top_k(pkey, A->max_pid + 1, ANALYZE_TOP, phot);
+    fprintf(f, "], \"pids\": [");
+    for (int k = 0; k < np; ++k) fprintf(f, "%s%d", k ? ", " : "", phot[k]);
+    fprintf(f, "]}\n}\n");
+}
+
+int analyze_main(int argc, char **argv) {
+    if (argc < 3 || argc > 4) {
+        fprintf(stderr, "Uso: %s analyze eventos.csv|eventos.bin [saida.json]\n", argv[0]);
+        return 1;
+    }
+    const char *log = argv[2], *out = argc == 4 ? argv[3] : NULL;
+    Analysis *A = malloc(sizeof *A);
+    if (!A) return 1;
+    char err[256];
+    if (!analyze_log(log, A, err, sizeof err)) {
+        fprintf(stderr, "analyze: %s\n", err);
+        free(A);
+        return 1;
+    }
+    int rc = 0;
+    if (out) {
+        FILE *f = fopen(out, "w");
+        if (f) {
+            analyze_write_json(A, log, f);
+            rc = fclose(f) == 0 ? 0 : 1;
+        } else {
+            fprintf(stderr, "analyze: não abriu %s: %s\n", out, strerror(errno));
+            rc = 1;
+        }
+        analyze_print_summary(A, log, stdout);
+    } else {
+        analyze_write_json(A, log, stdout);
+    }
+    free(A);
+    return rc;
+}
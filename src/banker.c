@@ -3,17 +3,76 @@
  * --------------------------------------------------------------------- */
 #include <stdbool.h>
 #include "banker.h"
+#include "policy.h"
+#include "timing.h"
+#include "trace.h"
+#include "scratch.h"
 
-static inline bool vec_leq_need(const int need[MAX_R], const int work[MAX_R], int m) {
+static inline bool vec_leq_need(const rc_t need[MAX_R], const int work[MAX_R], int m) {
     for (int j = 0; j < m; ++j) if (need[j] > work[j]) return false;
     return true;
 }
 
+/* Membros, ordem e Finish das reduções: n de cada, no scratch da thread
+   (arrays [MAX_P] na pilha estouram a stack com MAX_P grande) */
+typedef struct { int *mem, *order; bool *fin; } BankerWork;
+
+static bool banker_work(int n, BankerWork *w) {
+    char *p = scratch_get(SCR_BANKER, (size_t)n * (2 * sizeof(int) + sizeof(bool)));
+    if (!p) return false;
+    w->mem = (int *)p;
+    w->order = w->mem + n;
+    w->fin = (bool *)(w->order + n);
+    return true;
+}
+
+/*
+ * Redução sobre as colunas contadas 'cols' (escalar) e, se ub != NULL,
+ * sobre as de instância única em bitsets. mem == NULL → processos 0..k-1.
+ */
+static bool reduce(const System *S, const UnitBits *ub, const int *cols, int mc,
+                   const int *mem, int k, bool *Finish) {
+    int Work[MAX_R];
+    u64 WorkB[UB_WORDS] = {0};
+    int words = ub ? ub->words : 0;
+
+    for (int c = 0; c < mc; ++c) Work[c] = S->Available[cols[c]];
+    for (int w = 0; w < words; ++w) WorkB[w] = ub->avail[w];
+    for (int t = 0; t < k; ++t) Finish[t] = false;
+
+    int left = k;
+    bool progress = true;
+    while (progress && left > 0) {
+        progress = false;
+        for (int t = 0; t < k; ++t) {
+            if (Finish[t]) continue;
+            int i = mem ? mem[t] : t;
+            const Process *q = &S->procs[i];
+            if (words && !ub_leq(ub->need[i], WorkB, words)) continue;
+            int c = 0;
+            while (c < mc && q->Need[cols[c]] <= Work[c]) ++c;
+            if (c < mc) continue;
+            for (c = 0; c < mc; ++c) Work[c] += q->Allocation[cols[c]];
+            if (words) ub_or(WorkB, ub->alloc[i], words);
+            Finish[t] = true;
+            left--;
+            progress = true;
+        }
+    }
+    return left == 0;
+}
+
 bool safety_check(const System *S) {
-    if (!S) return false;
+    BankerWork wk;
+    if (!S || !banker_work(S->n, &wk)) return false;   /* sem memória: nunca "seguro" */
     int m = S->m, n = S->n;
+    bool *Finish = wk.fin;
+
+    /* Com colunas de instância única: parte em bits + parte contada */
+    const UnitBits *ub = &S->bits;
+    if (ub->valid && ub->n_unit > 0) return reduce(S, ub, ub->counted, ub->n_counted, NULL, n, Finish);
+
     int Work[MAX_R];
-    bool Finish[MAX_P];
 
     for (int j = 0; j < m; ++j) Work[j] = S->Available[j];
     for (int i = 0; i < n; ++i) Finish[i] = false;
@@ -34,6 +93,189 @@ bool safety_check(const System *S) {
     return true;
 }
 
+bool safety_check_component(System *S, const Process *P) {
+    ub_ensure(S);
+    Partition *pt = &S->part;
+    int anchor = pt->valid ? pt->anchor[P->id] : -1;
+    if (anchor < 0) {
+        S->metrics.safety_procs_scanned += (uint64_t)S->n;
+        return safety_check(S);
+    }
+    int root = part_find(pt, anchor);
+
+    /* Colunas contadas do componente e membros (na ordem da lista).
+       Os Max dos membros só tocam colunas do componente, então os bits
+       das demais colunas não interferem. */
+    const UnitBits *ub = S->bits.n_unit > 0 ? &S->bits : NULL;
+    int cols[MAX_R], mc = 0;
+    int ncand = ub ? ub->n_counted : S->m;
+    for (int c = 0; c < ncand; ++c) {
+        int j = ub ? ub->counted[c] : c;
+        if (part_find(pt, j) == root) cols[mc++] = j;
+    }
+
+    BankerWork wk;
+    if (!banker_work(S->n, &wk)) return false;
+    int *mem = wk.mem, k = 0;
+    for (int i = pt->head[root]; i >= 0; i = pt->next[i]) mem[k++] = i;
+    S->metrics.safety_procs_scanned += (uint64_t)k;
+
+    return reduce(S, ub, cols, mc, mem, k, wk.fin);
+}
+
+
+/* Maior Need[j] entre os processos (recomputa se a coluna foi invalidada;
+   a recomputação conta como montagem, não como custo da decisão) */
+static rc_t need_max(System *S, int j) {
+    if (S->need_max_valid[j]) return S->need_max[j];
+    unsigned long long t0 = now_ns();
+    rc_t mx = 0;
+    int cnt = 0;
+    for (int i = 0; i < S->n; ++i) {
+        rc_t v = S->procs[i].Need[j];
+        if (v > mx) { mx = v; cnt = 1; }
+        else if (v == mx) cnt++;
+    }
+    S->need_max[j] = mx;
+    S->need_max_cnt[j] = cnt;
+    S->need_max_valid[j] = true;
+    metrics_record_rebuild(&S->metrics, now_ns() - t0);
+    return mx;
+}
+
+/* Available - req cobre o Need de qualquer processo: todos terminam na
+   ordem que for, então o estado após a concessão é seguro sem o laço
+   O(n²·m). Usa o envelope de antes da concessão (o Need de P só cai). */
+static bool covers_all_needs(System *S, const int req[MAX_R]) {
+    for (int j = 0; j < S->m; ++j) {
+        if ((int)S->Available[j] - req[j] < (int)need_max(S, j)) return false;
+    }
+    return true;
+}
+
+/*
+ * Envelope seguro por processo. Na sequência segura achada pela redução,
+ * se Pi pede req com req <= Work_k - Need_k para todo Pk antes dele, a
+ * mesma sequência continua valendo após a concessão: quem vem depois de
+ * Pi recebe de volta Allocation_i + req. env_slack[i] guarda esse mínimo
+ * (limitado por Available); concessões seguintes descontam de env_debt
+ * (sys_env_grant). O safety do caminho normal já acha a sequência, então
+ * o envelope sai dele com uma passada linear a mais. Só para sistemas sem
+ * colunas de instância única: essas já têm a redução em bitsets (e o
+ * modo claim).
+ */
+static bool env_enabled(System *S) {
+    if (!S->bits.valid) {                     /* bitsets: montagem */
+        unsigned long long t0 = now_ns();
+        ub_ensure(S);
+        metrics_record_rebuild(&S->metrics, now_ns() - t0);
+    }
+    return S->bits.n_unit == 0;
+}
+
+/* Slot de época do componente de P (-1: P fora da partição) */
+static int env_slot_of(System *S, const Process *P) {
+    if (!S->part.valid) return 0;
+    int anchor = S->part.anchor[P->id];
+    return anchor < 0 ? -1 : part_find(&S->part, anchor);
+}
+
+/*
+ * Redução do componente c (mesma decisão de safety_check_component) que
+ * guarda a ordem; se todos terminam, grava os envelopes dos membros e
+ * abre uma época nova. Inseguro: não mexe em nada. A redução conta como
+ * safety e a gravação em env_builds; 'lazy' = montagem avulsa, que conta
+ * inteira como rebuild.
+ */
+static bool env_reduce(System *S, int c, bool lazy) {
+    unsigned long long t0 = now_ns();
+    Partition *pt = &S->part;
+    BankerWork wk;
+    if (!banker_work(S->n, &wk)) return false;
+    int cols[MAX_R], mc = 0, *mem = wk.mem, k = 0;
+    for (int j = 0; j < S->m; ++j)
+        if (sys_env_slot(S, j) == c) cols[mc++] = j;
+    if (pt->valid) {
+        for (int i = pt->head[c]; i >= 0; i = pt->next[i]) mem[k++] = i;
+    } else {
+        for (int i = 0; i < S->n; ++i) mem[k++] = i;
+    }
+    if (!lazy) S->metrics.safety_procs_scanned += (uint64_t)k;
+
+    int Work[MAX_R], *order = wk.order, done = 0;
+    bool *Finish = wk.fin;
+    for (int u = 0; u < mc; ++u) Work[u] = S->Available[cols[u]];
+    for (int t = 0; t < k; ++t) Finish[t] = false;
+
+    bool progress = true;
+    while (progress && done < k) {
+        progress = false;
+        for (int t = 0; t < k; ++t) {
+            if (Finish[t]) continue;
+            const Process *q = &S->procs[mem[t]];
+            int u = 0;
+            while (u < mc && q->Need[cols[u]] <= Work[u]) ++u;
+            if (u < mc) continue;
+            for (u = 0; u < mc; ++u) Work[u] += q->Allocation[cols[u]];
+            Finish[t] = true;
+            order[done++] = mem[t];
+            progress = true;
+        }
+    }
+    unsigned long long t1 = now_ns();
+    if (!lazy) metrics_record_safety_call(&S->metrics, t1 - t0);
+    if (done < k) {
+        if (lazy) metrics_record_rebuild(&S->metrics, t1 - t0);
+        return false;
+    }
+
+    /* Segunda passada, na ordem achada: folga = mínimo dos anteriores */
+    uint64_t g = ++S->env_gen;
+    int Run[MAX_R];
+    for (int u = 0; u < mc; ++u) {
+        Work[u] = Run[u] = S->Available[cols[u]];
+        S->env_debt[cols[u]] = 0;
+    }
+    for (int t = 0; t < k; ++t) {
+        int i = order[t];
+        const Process *q = &S->procs[i];
+        for (int u = 0; u < mc; ++u) {
+            int j = cols[u];
+            S->env_slack[i * S->m + j] = (rc_t)Run[u];
+            int d = Work[u] - q->Need[j];
+            if (d < Run[u]) Run[u] = d;
+            Work[u] += q->Allocation[j];
+        }
+        S->env_at[i] = g;
+    }
+    S->env_comp[c] = g;
+    unsigned long long t2 = now_ns();
+    if (lazy) {
+        metrics_record_rebuild(&S->metrics, t2 - t0);
+    } else {
+        S->metrics.env_builds++;
+        S->metrics.ns_in_env_build_total += t2 - t1;
+    }
+    return true;
+}
+
+/* Montagem avulsa (primeiro pedido após carga ou invalidação). Componente
+   inseguro (só vindo da carga): época sem membros, até a próxima
+   concessão descartá-la. */
+static void env_build(System *S, int c) {
+    if (env_reduce(S, c, true)) return;
+    S->env_comp[c] = ++S->env_gen;
+}
+
+static bool env_admits(const System *S, const Process *P, const int req[MAX_R], int c) {
+    uint64_t g = S->env_comp[c];
+    if (g <= S->env_floor || S->env_at[P->id] != g) return false;
+    const rc_t *slack = &S->env_slack[P->id * S->m];
+    for (int j = 0; j < S->m; ++j) {
+        if (req[j] > 0 && req[j] > (int)slack[j] - S->env_debt[j]) return false;
+    }
+    return true;
+}
 
 bool request_banker(System *S, Process *P, const int req[MAX_R]) {
     if (!S || !P || !req) return false;
@@ -46,27 +288,141 @@ bool request_banker(System *S, Process *P, const int req[MAX_R]) {
         if (r > S->Available[j]) return false;
     }
 
-    /* 2) Tentativa (aplica provisoriamente) */
-    for (int j = 0; j < S->m; ++j) {
-        int r = req[j];
-        S->Available[j]  -= r;
-        P->Allocation[j] += r;
-        P->Need[j]       -= r;
+    /* 2) Atalho: estado trivialmente seguro */
+    if (covers_all_needs(S, req)) {
+        if (!sys_grant(S, P, req)) return false;
+        S->metrics.safety_fast_path++;
+        return true;
     }
 
-    /* 3) Safety check */
-    bool safe = safety_check(S);
+    /* Daqui em diante há redução: buffers de n processos. Sem eles não
+       dá para decidir; nega e para a simulação com o erro. */
+    BankerWork wk;
+    if (!banker_work(S->n, &wk)) {
+        S->fault = "banqueiro sem memória para os buffers de trabalho";
+        return false;
+    }
+
+    /* 3) Envelope seguro de P: dentro dele, concede sem safety (O(m)) */
+    int c = env_enabled(S) ? env_slot_of(S, P) : -1;
+    if (c >= 0) {
+        if (S->env_comp[c] <= S->env_floor) env_build(S, c);
+        if (env_admits(S, P, req, c)) {
+            if (!sys_grant(S, P, req)) return false;
+            S->metrics.env_hits++;
+            return true;
+        }
+    }
+
+    /* 4) Tentativa (aplica provisoriamente; fora do envelope, o sys_grant o descarta) */
+    uint64_t env_kept = c >= 0 ? S->env_comp[c] : 0;
+    if (!sys_grant(S, P, req)) return false;
+
+    /* 5) Safety check (só o componente de P: os demais não mudaram); se
+       seguro, já deixa o envelope do estado novo */
+    bool safe;
+    if (c >= 0) {
+        safe = env_reduce(S, c, false);
+    } else {
+        unsigned long long t0 = now_ns();
+        safe = safety_check_component(S, P);
+        metrics_record_safety_call(&S->metrics, now_ns() - t0);
+    }
 
     if (safe) {
         return true; /* mantém a tentativa */
     } else {
-        /* 4) Rollback */
-        for (int j = 0; j < S->m; ++j) {
-            int r = req[j];
-            S->Available[j]  += r;
-            P->Allocation[j] -= r;
-            P->Need[j]       += r;
-        }
+        /* 6) Rollback (inverso exato da tentativa: não pode falhar). O
+           estado volta ao de antes e o envelope segue valendo (a dívida
+           que sobrou só o deixa mais conservador). */
+        bool undone = sys_rollback(S, P, req);
+        (void)undone;
+        if (c >= 0) S->env_comp[c] = env_kept;
         return false;
     }
 }
+
+
+/* ============================
+ * Política BANKER
+ * ============================ */
+
+/* pré-checagem: só mede a decisão se possível prosseguir (as reduções e
+   montagens dentro dela são medidas à parte em request_banker) */
+bool banker_on_request(System *S, Process *P, const int req[MAX_R]) {
+    if (!req_within_bounds(S, P, req)) return false;
+
+    unsigned long long t0 = now_ns();
+    bool ok = request_banker(S, P, req);
+    unsigned long long t1 = now_ns();
+    metrics_record_decision(&S->metrics, t1 - t0);
+    trace_host(TR_HOST_SAFETY, t0, t1);
+    return ok;
+}
+
+/* Taxas e médias: atalhos sobre o total de decisões; tempos de safety,
+   gravação do envelope e montagens, cada um sobre a própria contagem */
+static double ratio(uint64_t num, uint64_t den) {
+    return den ? (double)num / (double)den : 0.0;
+}
+
+static void banker_write_metrics_json(const System *S, FILE *f) {
+    const Metrics *mt = &S->metrics;
+    fprintf(f,
+        ",\n  \"decisions\": %llu"
+        ",\n  \"ns_in_decisions_total\": %llu"
+        ",\n  \"banker_safety_calls\": %llu"
+        ",\n  \"ns_in_safety_total\": %llu"
+        ",\n  \"safety_avg_ns\": %.0f"
+        ",\n  \"safety_procs_scanned\": %llu"
+        ",\n  \"safety_fast_path\": %llu"
+        ",\n  \"safety_fast_path_rate\": %.4f"
+        ",\n  \"env_hits\": %llu"
+        ",\n  \"env_hit_rate\": %.4f"
+        ",\n  \"env_builds\": %llu"
+        ",\n  \"env_build_avg_ns\": %.0f"
+        ",\n  \"rebuilds\": %llu"
+        ",\n  \"ns_in_rebuild_total\": %llu",
+        (unsigned long long)mt->decisions,
+        (unsigned long long)mt->ns_in_decisions_total,
+        (unsigned long long)mt->banker_safety_calls,
+        (unsigned long long)mt->ns_in_safety_total,
+        ratio(mt->ns_in_safety_total, mt->banker_safety_calls),
+        (unsigned long long)mt->safety_procs_scanned,
+        (unsigned long long)mt->safety_fast_path,
+        ratio(mt->safety_fast_path, mt->decisions),
+        (unsigned long long)mt->env_hits,
+        ratio(mt->env_hits, mt->decisions),
+        (unsigned long long)mt->env_builds,
+        ratio(mt->ns_in_env_build_total, mt->env_builds),
+        (unsigned long long)mt->rebuilds,
+        (unsigned long long)mt->ns_in_rebuild_total);
+}
+
+static void banker_print_summary(const System *S, FILE *f) {
+    unsigned long long calls = S->metrics.banker_safety_calls;
+    unsigned long long ns    = S->metrics.ns_in_safety_total;
+    fprintf(f, " | decisions=%llu safety_calls=%llu ns_total=%llu",
+            (unsigned long long)S->metrics.decisions, calls, ns);
+    if (calls) fprintf(f, " avg_ns=%llu", ns / calls);
+    if (S->metrics.rebuilds) {
+        fprintf(f, " rebuilds=%llu rebuild_ns=%llu",
+                (unsigned long long)S->metrics.rebuilds,
+                (unsigned long long)S->metrics.ns_in_rebuild_total);
+    }
+    if (S->metrics.env_builds) {
+        fprintf(f, " env_hits=%llu env_builds=%llu env_build_ns=%llu",
+                (unsigned long long)S->metrics.env_hits,
+                (unsigned long long)S->metrics.env_builds,
+                (unsigned long long)(S->metrics.ns_in_env_build_total / S->metrics.env_builds));
+    }
+}
+
+const Policy policy_banker = {
+    .name               = "banker",
+    .label              = "BANKER",
+    .detect_on_stall    = false,
+    .on_request         = banker_on_request,
+    .write_metrics_json = banker_write_metrics_json,
+    .print_summary      = banker_print_summary,
+};
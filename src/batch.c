@@ -0,0 +1,423 @@
+/* ---------------------------------------------------------------------
+ * batch.c — Motor em lote (BATCH_LANES sistemas por vetor)
+ * Vetores de extensão do GCC (vector_size): cada vi tem uma lane por
+ * sistema; comparações devolvem máscaras -1/0, usadas com & e | no lugar
+ * de desvios. O laço percorre pids em ordem (o --sched index do sim_run),
+ * então todas as lanes olham o mesmo pid ao mesmo tempo; só o avanço do
+ * roteiro (cursor diferente por lane) é escalar, e só nas lanes concedidas.
+ * --------------------------------------------------------------------- */
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "batch.h"
+#include "process.h"
+#include "policy.h"
+#include "detector.h"
+#include "scheduler.h"
+#include "timing.h"
+
+typedef int32_t vi __attribute__((vector_size(BATCH_LANES * sizeof(int32_t))));
+
+typedef struct Lanes {
+    int  n, m;                                   /* máximos do grupo       */
+    bool banker, detect;
+    vi   avail[BATCH_MAX_R];
+    vi   need[BATCH_MAX_P][BATCH_MAX_R];
+    vi   alloc[BATCH_MAX_P][BATCH_MAX_R];
+    vi   req[BATCH_MAX_P][BATCH_MAX_R];          /* pedido no topo do roteiro */
+    vi   cursor[BATCH_MAX_P], len[BATCH_MAX_P];
+    vi   ready_now[BATCH_MAX_P], ready_next[BATCH_MAX_P], blocked[BATCH_MAX_P];
+    vi   live;                                   /* -1: lane ainda roda     */
+    vi   unfinished;
+    vi   clock, requests, grants, blocks;
+    vi   stalled, dead;                          /* dead: procs em deadlock */
+    int  nk[BATCH_LANES];                        /* n de cada lane         */
+    int  script[BATCH_LANES][BATCH_MAX_P][MAX_REQS][BATCH_MAX_R];
+} Lanes;
+
+/* Resultado de um sistema (lote ou escalar), para conferência */
+typedef struct SysOut {
+    uint64_t requests, grants, blocks, makespan;
+    int      finished, dead;
+    bool     stalled;
+} SysOut;
+
+/* OR horizontal em palavras de 64 bits (sem desvio por lane) */
+static inline bool v_any(const vi *x) {
+    uint64_t w[sizeof(vi) / sizeof(uint64_t)], acc = 0;
+    memcpy(w, x, sizeof w);
+    for (size_t k = 0; k < sizeof w / sizeof w[0]; ++k) acc |= w[k];
+    return acc != 0;
+}
+
+/* ============================
+ * Suporte
+ * ============================ */
+bool batch_supported(const System *S, char *why, size_t len) {
+    const char *msg = NULL;
+    if (S->policy != &policy_banker && S->policy != &policy_ostrich)
+        msg = "só as políticas banker e ostrich";
+    else if (S->n < 1 || S->n > BATCH_MAX_P || S->m < 1 || S->m > BATCH_MAX_R)
+        msg = "cenário grande demais para uma lane";
+    else if (S->procs[0].co)
+        msg = "cenários com corrotinas não cabem em lanes";
+    else if (S->sched.kind != SK_INDEX)
+        msg = "só --sched index (lanes andam em passo único por pid)";
+    else if (S->detect_cfg.trigger != DET_STALL && S->detect_cfg.trigger != DET_NONE)
+        msg = "só --detect stall|none";
+    if (msg && why) snprintf(why, len, "%s (n<=%d, m<=%d)", msg, BATCH_MAX_P, BATCH_MAX_R);
+    return msg == NULL;
+}
+
+/* ============================
+ * Empacotar / desempacotar
+ * ============================ */
+static void lanes_clear(Lanes *L, const System *S) {
+    memset(L, 0, offsetof(Lanes, script));
+    L->banker = S->policy == &policy_banker;
+    L->detect = S->policy->detect_on_stall && S->detect_cfg.trigger != DET_NONE;
+}
+
+static void lanes_pack(Lanes *L, int k, const System *S) {
+    if (S->n > L->n) L->n = S->n;
+    if (S->m > L->m) L->m = S->m;
+    L->nk[k] = S->n;
+    for (int j = 0; j < S->m; ++j) L->avail[j][k] = S->Available[j];
+    bool pending = false;
+    for (int i = 0; i < S->n; ++i) {
+        const Process *p = &S->procs[i];
+        for (int j = 0; j < S->m; ++j) {
+            L->need[i][j][k]  = p->Need[j];
+            L->alloc[i][j][k] = p->Allocation[j];
+        }
+        const ReqList *r = p->script;
+        int len = r ? r->len : 0, cur = r ? r->idx : 0;
+        for (int s = cur; s < len; ++s)
+            for (int j = 0; j < S->m; ++j) L->script[k][i][s][j] = r->items[s][j];
+        L->len[i][k] = len;
+        L->cursor[i][k] = cur;
+        for (int j = 0; j < S->m; ++j) L->req[i][j][k] = cur < len ? r->items[cur][j] : 0;
+
+        if (p->state == P_READY)   { L->ready_next[i][k] = -1; pending = true; }
+        if (p->state == P_BLOCKED) { L->blocked[i][k] = -1;    pending = true; }
+        if (p->state != P_FINISHED) L->unfinished[k]++;
+    }
+    L->live[k] = pending ? -1 : 0;
+}
+
+static void lanes_unpack(const Lanes *L, int k, SysOut *o) {
+    o->requests = (uint64_t)L->requests[k];
+    o->grants   = (uint64_t)L->grants[k];
+    o->blocks   = (uint64_t)L->blocks[k];
+    o->makespan = (uint64_t)L->clock[k];
+    o->dead     = L->dead[k];
+    o->stalled  = L->stalled[k] != 0;
+    o->finished = L->nk[k] - L->unfinished[k];
+}
+
+/* ============================
+ * Núcleo vetorial
+ * ============================ */
+
+/* Redução do banqueiro/detector nas lanes de A (Need contra Work).
+   *all = -1 nas lanes em que todos terminam; *left = quantos não.
+   (Vetores sempre por ponteiro: por valor mudam o ABI sem -mavx.) */
+static void lanes_reduce(const Lanes *L, const vi *A, vi *all, vi *left) {
+    int n = L->n, m = L->m;
+    vi work[BATCH_MAX_R], fin[BATCH_MAX_P];
+    for (int j = 0; j < m; ++j) work[j] = L->avail[j];
+    for (int i = 0; i < n; ++i) fin[i] = ~*A;
+
+    /* Para quando nada muda ou quando todas as lanes já terminaram
+       (como o 'left > 0' do safety escalar: sem passada extra vazia) */
+    vi changed, pending;
+    do {
+        changed = pending = (vi){0};
+        for (int i = 0; i < n; ++i) {
+            vi can = ~fin[i];
+            if (!v_any(&can)) continue;
+            for (int j = 0; j < m; ++j) can &= L->need[i][j] <= work[j];
+            for (int j = 0; j < m; ++j) work[j] += L->alloc[i][j] & can;
+            fin[i] |= can;
+            changed |= can;
+            pending |= ~fin[i];
+        }
+        changed &= pending;
+    } while (v_any(&changed));
+
+    vi done = ~(vi){0}, cnt = {0};
+    for (int i = 0; i < n; ++i) {
+        done &= fin[i];
+        cnt -= ~fin[i];
+    }
+    if (all)  *all = done;
+    if (left) *left = cnt;
+}
+
+/* Move req de pid i entre Available e Allocation/Need nas lanes G
+   (dir = +1 concede, -1 desfaz) */
+static void lanes_apply(Lanes *L, int i, const vi *G, int dir) {
+    for (int j = 0; j < L->m; ++j) {
+        vi r = L->req[i][j] & *G;
+        if (dir < 0) r = -r;
+        L->avail[j]   -= r;
+        L->alloc[i][j] += r;
+        L->need[i][j]  -= r;
+    }
+}
+
+/* sim_finish_process nas lanes F: devolve tudo */
+static void lanes_finish(Lanes *L, int i, const vi *F) {
+    for (int j = 0; j < L->m; ++j) {
+        L->avail[j]    += L->alloc[i][j] & *F;
+        L->alloc[i][j] &= ~*F;
+        L->need[i][j]  &= ~*F;
+    }
+    L->unfinished += *F;   /* F = -1 → decrementa */
+}
+
+/* Um passo do pid i nas lanes M: o dispatcher (checagens + política),
+   avanço do roteiro e término. *ok = concedido; *fin = terminou. */
+static void lanes_step(Lanes *L, int i, const vi *M, vi *ok_out, vi *fin_out) {
+    vi empty = *M & (L->cursor[i] >= L->len[i]);
+    vi R = *M & ~empty;
+    L->requests -= R;
+
+    vi ok = R;
+    for (int j = 0; j < L->m; ++j)
+        ok &= (L->req[i][j] >= 0) & (L->req[i][j] <= L->need[i][j]) & (L->req[i][j] <= L->avail[j]);
+
+    if (v_any(&ok)) {
+        lanes_apply(L, i, &ok, +1);
+        if (L->banker) {
+            /* Sem o atalho do max-Need: recalculá-lo por passo em todas as
+               lanes custa mais do que a redução que ele evitaria */
+            vi safe;
+            lanes_reduce(L, &ok, &safe, NULL);
+            vi undo = ok & ~safe;
+            if (v_any(&undo)) lanes_apply(L, i, &undo, -1);
+            ok &= safe;
+        }
+    }
+    L->grants -= ok;
+    L->blocks -= R & ~ok;
+
+    if (v_any(&ok)) {
+        L->cursor[i] -= ok;
+        for (int k = 0; k < BATCH_LANES; ++k) {
+            if (!ok[k]) continue;
+            int c = L->cursor[i][k];
+            for (int j = 0; j < L->m; ++j)
+                L->req[i][j][k] = c < L->len[i][k] ? L->script[k][i][c][j] : 0;
+        }
+    }
+
+    vi fin = empty | (ok & (L->cursor[i] >= L->len[i]));
+    if (v_any(&fin)) lanes_finish(L, i, &fin);
+    *ok_out = ok;
+    *fin_out = fin;
+}
+
+/* Uma rodada do sim_run em todas as lanes vivas */
+static void lanes_round(Lanes *L) {
+    int n = L->n;
+    vi live = L->live, progress = {0}, ok, fin;
+
+    for (int i = 0; i < n; ++i) {
+        L->ready_now[i] = L->ready_next[i] & live;
+        L->ready_next[i] = (vi){0};
+    }
+
+    /* 1) READY em ordem de pid */
+    for (int i = 0; i < n; ++i) {
+        vi M = L->ready_now[i];
+        if (!v_any(&M)) continue;
+        progress |= M;
+        lanes_step(L, i, &M, &ok, &fin);
+        L->ready_next[i] |= ok & ~fin;
+        L->blocked[i]    |= M & ~ok & ~fin;
+    }
+
+    /* 2) Varredura dos bloqueados (inclui os desta rodada) */
+    for (int i = 0; i < n; ++i) {
+        vi M = L->blocked[i] & live;
+        if (!v_any(&M)) continue;
+        lanes_step(L, i, &M, &ok, &fin);
+        L->blocked[i]    &= ~(ok | fin);
+        L->ready_next[i] |= ok & ~fin;
+        progress |= ok | fin;
+    }
+
+    /* 3) Relógio; 4) travamento → detector (Need) */
+    L->clock -= live;
+    vi stall = live & ~progress;
+    if (v_any(&stall)) {
+        L->stalled |= stall;
+        if (L->detect) {
+            vi left;
+            lanes_reduce(L, &stall, NULL, &left);
+            L->dead = (left & stall) | (L->dead & ~stall);
+        }
+    }
+    L->live = live & progress & (L->unfinished != 0);
+}
+
+static void lanes_run(Lanes *L) {
+    while (v_any(&L->live)) lanes_round(L);
+}
+
+/* ============================
+ * Caminho escalar (referência)
+ * ============================ */
+static void scalar_out(const System *S, SysOut *o) {
+    o->requests = S->metrics.total_requests;
+    o->grants   = S->metrics.grants;
+    o->blocks   = S->metrics.blocks;
+    o->makespan = S->sim_clock;
+    o->finished = S->n_finished;
+    o->dead     = S->metrics.deadlocks_found ? (int)S->metrics.deadlocked_procs : 0;
+    o->stalled  = S->n_finished < S->n;
+}
+
+static bool out_equal(const SysOut *a, const SysOut *b) {
+    return a->requests == b->requests && a->grants == b->grants &&
+           a->blocks == b->blocks && a->makespan == b->makespan &&
+           a->finished == b->finished && a->dead == b->dead &&
+           a->stalled == b->stalled;
+}
+
+static void result_add(BatchResult *r, const SysOut *o) {
+    r->requests     += o->requests;
+    r->grants       += o->grants;
+    r->blocks       += o->blocks;
+    r->makespan_sum += o->makespan;
+    if (o->dead > 0) r->deadlocks++;
+    if (o->stalled)  r->stalls++;
+}
+
+/* ============================
+ * Driver
+ * ============================ */
+bool batch_run(const BatchConfig *cfg, BatchResult *out) {
+    if (!cfg || !cfg->load || !out || cfg->systems == 0) return false;
+    memset(out, 0, sizeof *out);
+
+    System *S = malloc(sizeof *S);
+    size_t lsz = (sizeof(Lanes) + 63) & ~(size_t)63;
+    Lanes  *L = aligned_alloc(64, lsz);
+    if (!S || !L) {
+        free(S);
+        free(L);
+        return false;
+    }
+
+    unsigned long long t_batch = 0, t_scalar = 0;
+    bool ok = true;
+    for (uint64_t k0 = 0; k0 < cfg->systems && ok; k0 += BATCH_LANES) {
+        int lanes = cfg->systems - k0 < BATCH_LANES ? (int)(cfg->systems - k0) : BATCH_LANES;
+
+        /* Carga (fora do tempo) e empacotamento (dentro) */
+        for (int k = 0; k < lanes; ++k) {
+            if (!cfg->load(S, k0 + (uint64_t)k, cfg->ctx) || !batch_supported(S, NULL, 0)) {
+                ok = false;
+                break;
+            }
+            unsigned long long t0 = now_ns();
+            if (k == 0) lanes_clear(L, S);
+            lanes_pack(L, k, S);
+            t_batch += now_ns() - t0;
+        }
+        if (!ok) break;
+
+        unsigned long long t0 = now_ns();
+        lanes_run(L);
+        t_batch += now_ns() - t0;
+
+        for (int k = 0; k < lanes; ++k) {
+            SysOut b;
+            lanes_unpack(L, k, &b);
+            result_add(out, &b);
+            out->systems++;
+            if (!cfg->scalar) continue;
+
+            if (!cfg->load(S, k0 + (uint64_t)k, cfg->ctx)) { ok = false; break; }
+            t0 = now_ns();
+            sim_run(S);
+            t_scalar += now_ns() - t0;
+            SysOut s;
+            scalar_out(S, &s);
+            if (!out_equal(&b, &s)) out->mismatches++;
+        }
+    }
+
+    out->batch_s    = (double)t_batch / 1e9;
+    out->scalar_s   = (double)t_scalar / 1e9;
+    out->scalar_ran = cfg->scalar && ok;
+    free(S);
+    free(L);
+    return ok;
+}
+
+/* ============================
+ * Relatórios
+ * ============================ */
+static double rate(uint64_t k, double s) {
+    return s > 0.0 ? (double)k / s : 0.0;
+}
+
+void batch_print_summary(const BatchResult *r, const char *mode, const char *scenario, FILE *f) {
+    fprintf(f, "mode=%s scenario=%s | systems=%llu lanes=%d deadlocks=%llu stalls=%llu"
+               " | grants=%llu blocks=%llu makespan_mean=%.2f"
+               " | batch_s=%.3f sys_per_s=%.0f",
+            mode, scenario, (unsigned long long)r->systems, BATCH_LANES,
+            (unsigned long long)r->deadlocks, (unsigned long long)r->stalls,
+            (unsigned long long)r->grants, (unsigned long long)r->blocks,
+            r->systems ? (double)r->makespan_sum / (double)r->systems : 0.0,
+            r->batch_s, rate(r->systems, r->batch_s));
+    if (r->scalar_ran) {
+        fprintf(f, " | scalar_s=%.3f scalar_sys_per_s=%.0f speedup=%.2fx mismatches=%llu",
+                r->scalar_s, rate(r->systems, r->scalar_s),
+                r->batch_s > 0.0 ? r->scalar_s / r->batch_s : 0.0,
+                (unsigned long long)r->mismatches);
+    }
+    fputc('\n', f);
+}
+
+bool batch_write_json(const BatchResult *r, const char *mode, const char *scenario, const char *path) {
+    if (!r || !path) return false;
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f,
+        "{\n"
+        "  \"mode\": \"%s\",\n"
+        "  \"scenario\": \"%s\",\n"
+        "  \"systems\": %llu,\n"
+        "  \"lanes\": %d,\n"
+        "  \"deadlocks\": %llu,\n"
+        "  \"stalls\": %llu,\n"
+        "  \"requests\": %llu,\n"
+        "  \"grants\": %llu,\n"
+        "  \"blocks\": %llu,\n"
+        "  \"makespan_mean\": %.3f,\n"
+        "  \"batch_s\": %.6f,\n"
+        "  \"batch_systems_per_s\": %.1f",
+        mode, scenario, (unsigned long long)r->systems, BATCH_LANES,
+        (unsigned long long)r->deadlocks, (unsigned long long)r->stalls,
+        (unsigned long long)r->requests, (unsigned long long)r->grants,
+        (unsigned long long)r->blocks,
+        r->systems ? (double)r->makespan_sum / (double)r->systems : 0.0,
+        r->batch_s, rate(r->systems, r->batch_s));
+    if (r->scalar_ran) {
+        fprintf(f,
+            ",\n  \"scalar_s\": %.6f"
+            ",\n  \"scalar_systems_per_s\": %.1f"
+            ",\n  \"speedup\": %.3f"
+            ",\n  \"mismatches\": %llu",
+            r->scalar_s, rate(r->systems, r->scalar_s),
+            r->batch_s > 0.0 ? r->scalar_s / r->batch_s : 0.0,
+            (unsigned long long)r->mismatches);
+    }
+    fprintf(f, "\n}\n");
+    return fclose(f) == 0;
+}
@@ -0,0 +1,499 @@
+/* ---------------------------------------------------------------------
+ * bench.c — Vazão ponta a ponta: sim_run → dispatcher → política → log
+ * A carga de cada ponto da grade sai de uma semente fixa, então BANKER e
+ * OSTRICH (e as três variantes de log) veem exatamente os mesmos
+ * roteiros. O tempo medido é o do sim_run mais o fechamento do log (o
+ * flush final faz parte do custo de logar); carga e sim_init ficam fora.
+ * --------------------------------------------------------------------- */
+#define _DEFAULT_SOURCE            /* MAP_ANONYMOUS, wait4 */
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "bench.h"
+#include "simulator.h"
+#include "process.h"
+#include "policy.h"
+#include "scheduler.h"
+#include "logger.h"
+#include "timing.h"
+
+static const char *const log_names[] = { "off", "csv", "bin" };
+
+/* ============================
+ * Carga sintética
+ * ============================ */
+
+/* Cada processo faz 'len' pedidos unitários em recursos sorteados (com
+   repetição), Max = soma do roteiro e Allocation inicial zero.
+   Available[j] = max(maior Max[.][j], soma(Max[.][j]) / contention):
+   sempre viável, e a contenção cresce com o divisor. */
+static bool bench_load(System *S, ReqList *r, int len, int contention, uint64_t seed) {
+    int (*Maxs)[MAX_R] = calloc((size_t)S->n, sizeof *Maxs);   /* n linhas, não MAX_P */
+    int (*Alls)[MAX_R] = calloc((size_t)S->n, sizeof *Alls);
+    struct ReqList **Scripts = calloc((size_t)S->n, sizeof *Scripts);
+    int A[MAX_R] = {0};
+    long long sum[MAX_R] = {0};
+    uint64_t rng = seed;
+
+    if (!Maxs || !Alls || !Scripts) {
+        free(Maxs); free(Alls); free(Scripts);
+        return false;
+    }
+    for (int i = 0; i < S->n; ++i) {
+        reqlist_init(&r[i]);
+        for (int k = 0; k < len; ++k) {
+            int req[MAX_R] = {0};
+            int j = (int)(sched_rand_next(&rng) % (uint64_t)S->m);
+            req[j] = 1;
+            Maxs[i][j]++;
+            (void)reqlist_push(&r[i], req, S->m);
+        }
+        for (int j = 0; j < S->m; ++j) {
+            sum[j] += Maxs[i][j];
+            if (Maxs[i][j] > A[j]) A[j] = Maxs[i][j];
+        }
+        Scripts[i] = &r[i];
+    }
+    for (int j = 0; j < S->m; ++j) {
+        if (sum[j] / contention > A[j]) A[j] = (int)(sum[j] / contention);
+    }
+    sys_load_from_arrays(S, A, Maxs, Alls, Scripts);
+    free(Maxs); free(Alls); free(Scripts);
+    return true;
+}
+
+/* Semente do ponto da grade: independe da política e do log */
+static uint64_t case_seed(const BenchCase *c, uint64_t seed) {
+    uint64_t s = seed;
+    s = s * 1000003u + (uint64_t)c->n;
+    s = s * 1000003u + (uint64_t)c->m;
+    s = s * 1000003u + (uint64_t)c->len;
+    s = s * 1000003u + (uint64_t)c->contention;
+    return s;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Mediana de v[0..k) (reordena v) */
+static double median(double *v, int k) {
+    qsort(v, (size_t)k, sizeof *v, cmp_double);
+    return k % 2 ? v[k / 2] : 0.5 * (v[k / 2 - 1] + v[k / 2]);
+}
+
+bool bench_case_run(const BenchCase *c, int reps, uint64_t seed,
+                    const char *dir, BenchResult *out)
+{
+    const Policy *policy = policy_find(c->mode);
+    if (!policy || reps < 1) return false;
+
+    int      cap   = reps > BENCH_MAX_RUNS ? reps : BENCH_MAX_RUNS;
+    System  *S     = calloc(1, sizeof *S);
+    ReqList *r     = malloc((size_t)c->n * sizeof *r);
+    double  *walls = malloc((size_t)cap * sizeof *walls);
+    if (!S || !r || !walls) {
+        free(S);
+        free(r);
+        free(walls);
+        return false;
+    }
+
+    char path[512] = "";
+    if (c->log != BENCH_LOG_OFF)
+        snprintf(path, sizeof path, "%s/bench-%ld.%s", dir, (long)getpid(), log_names[c->log]);
+
+    /* Casos curtos repetem até somar BENCH_MIN_S: a mediana de muitas
+       rodadas de 100 µs é bem menos ruidosa que a de três */
+    bool ok = true;
+    double total = 0.0;
+    int k;
+    for (k = 0; ok && (k < reps || (total < BENCH_MIN_S && k < BENCH_MAX_RUNS)); ++k) {
+        sim_init(S, c->n, c->m, policy);
+        if (!bench_load(S, r, c->len, c->contention, case_seed(c, seed))) {
+            fprintf(stderr, "bench: sem memória para a carga\n");
+            ok = false;
+            break;
+        }
+        sched_init(&S->sched, SK_INDEX, seed);
+        if (path[0] && !logger_open_csv(path, S->m)) {
+            fprintf(stderr, "bench: não abriu %s\n", path);
+            ok = false;
+            break;
+        }
+        unsigned long long t0 = now_ns();
+        sim_run(S);
+        logger_close_csv();
+        double wall = (double)(now_ns() - t0) / 1e9;
+        walls[k] = wall;
+        total += wall;
+
+        if (k == 0) {
+            out->requests  = S->metrics.total_requests;
+            out->grants    = S->metrics.grants;
+            out->blocks    = S->metrics.blocks;
+            out->deadlocks = S->metrics.deadlocks_found;
+            out->ticks     = S->sim_clock;
+        }
+        sim_finalize(S);
+    }
+    if (path[0]) {
+        struct stat st;
+        if (stat(path, &st) == 0) out->log_bytes = (uint64_t)st.st_size;
+        unlink(path);
+    }
+    free(r);
+    free(S);
+    if (!ok) {
+        free(walls);
+        return false;
+    }
+
+    double med = median(walls, k);
+    for (int i = 0; i < k; ++i) walls[i] = walls[i] > med ? walls[i] - med : med - walls[i];
+    out->noise_pct   = med > 0.0 ? 100.0 * median(walls, k) / med : 0.0;
+    free(walls);
+
+    out->runs        = k;
+    out->wall_s      = med;
+    out->req_per_s   = med > 0.0 ? (double)out->requests / med : 0.0;
+    out->ns_per_tick = out->ticks ? med * 1e9 / (double)out->ticks : 0.0;
+    out->bpg         = out->grants ? (double)out->blocks / (double)out->grants : 0.0;
+    return true;
+}
+
+/* ============================
+ * Baseline
+ * ============================ */
+
+/* Valor numérico depois de "chave": na linha (0 se não houver) */
+static double json_num(const char *line, const char *key) {
+    const char *p = strstr(line, key);
+    return p ? strtod(p + strlen(key), NULL) : 0.0;
+}
+
+/* Regressão: vazão abaixo de base × (1 - tol) ou pico de RSS acima de
+   base × (1 + thr) (e mais de 1 MiB). tol = max(thr, K × ruído), com o
+   ruído maior entre esta medida e a do baseline: num caso que oscila 10%
+   entre rodadas, uma queda de 10% não diz nada. Deriva: blocks/grant
+   diferente, ou seja, as decisões mudaram. */
+static void bench_judge(BenchResult *b, double thr) {
+    double noise = b->noise_pct > b->base_noise_pct ? b->noise_pct : b->base_noise_pct;
+    double tol   = BENCH_NOISE_K * noise / 100.0;
+    if (tol < thr) tol = thr;
+    b->tol_pct   = 100.0 * tol;
+    b->delta_pct = b->base_req_per_s > 0.0
+                 ? 100.0 * (b->req_per_s - b->base_req_per_s) / b->base_req_per_s : 0.0;
+    b->regressed = b->req_per_s < b->base_req_per_s * (1.0 - tol) ||
+                   (b->peak_rss_kb > (long)((double)b->base_rss_kb * (1.0 + thr)) &&
+                    b->peak_rss_kb - b->base_rss_kb > 1024);
+    b->drift = b->bpg - b->base_bpg > 5e-4 || b->base_bpg - b->bpg > 5e-4;
+}
+
+/* Lê o JSON de uma execução anterior (um caso por linha) e julga cada
+   resultado com o mesmo id (bench_judge) */
+static bool bench_compare(BenchResult *res, int k, const char *path, double thr) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "bench: não abriu baseline %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    char line[2048];
+    while (fgets(line, sizeof line, f)) {
+        const char *p = strstr(line, "\"id\":\"");
+        if (!p) continue;
+        p += 6;
+        const char *e = strchr(p, '"');
+        if (!e) continue;
+        size_t len = (size_t)(e - p);
+        for (int i = 0; i < k; ++i) {
+            BenchResult *b = &res[i];
+            if (!b->ok || strlen(b->id) != len || memcmp(b->id, p, len) != 0) continue;
+            b->has_base       = true;
+            b->base_req_per_s = json_num(line, "\"req_per_s\":");
+            b->base_bpg       = json_num(line, "\"bpg\":");
+            b->base_rss_kb    = (long)json_num(line, "\"peak_rss_kb\":");
+            b->base_noise_pct = json_num(line, "\"noise_pct\":");
+            bench_judge(b, thr);
+            break;
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+/* ============================
+ * Saída
+ * ============================ */
+static void bench_print_case(const BenchResult *b, FILE *f) {
+    fprintf(f, "%-44s", b->id);
+    if (!b->ok) {
+        fprintf(f, " | falhou\n");
+        return;
+    }
+    fprintf(f, " | req=%llu req_per_s=%.0f noise=%.1f%% ns_per_tick=%.0f bpg=%.3f rss_kb=%ld",
+            (unsigned long long)b->requests, b->req_per_s, b->noise_pct, b->ns_per_tick,
+            b->bpg, b->peak_rss_kb);
+    if (b->log_bytes) fprintf(f, " log_bytes=%llu", (unsigned long long)b->log_bytes);
+    if (b->has_base) {
+        fprintf(f, " | base=%.0f delta=%+.1f%% tol=%.1f%%", b->base_req_per_s, b->delta_pct,
+                b->tol_pct);
+        if (b->rechecks) fprintf(f, " rechecks=%d", b->rechecks);
+        fprintf(f, "%s%s", b->regressed ? " REGRESSÃO" : "", b->drift ? " DERIVA" : "");
+    }
+    fputc('\n', f);
+}
+
+static void bench_write_json(const BenchResult *res, int k, int reps, uint64_t seed,
+                             const char *baseline, double thr, int recheck, FILE *f)
+{
+    fprintf(f, "{\n  \"bench\": \"sim_run\",\n  \"max_p\": %d,\n  \"max_r\": %d,\n"
+               "  \"reps\": %d,\n  \"seed\": %llu,\n",
+            MAX_P, MAX_R, reps, (unsigned long long)seed);
+    if (baseline) {
+        int reg = 0, drift = 0;
+        for (int i = 0; i < k; ++i) {
+            reg   += res[i].regressed;
+            drift += res[i].drift;
+        }
+        fprintf(f, "  \"baseline\": \"%s\",\n  \"threshold_pct\": %.1f,\n  \"recheck\": %d,\n"
+                   "  \"regressions\": %d,\n  \"drift\": %d,\n",
+                baseline, thr * 100.0, recheck, reg, drift);
+    }
+    fprintf(f, "  \"cases\": [\n");
+    for (int i = 0; i < k; ++i) {
+        const BenchResult *b = &res[i];
+        fprintf(f, "    {\"id\":\"%s\",\"mode\":\"%s\",\"n\":%d,\"m\":%d,\"len\":%d,"
+                   "\"contention\":%d,\"log\":\"%s\",\"ok\":%s,\"runs\":%d,",
+                b->id, b->c.mode, b->c.n, b->c.m, b->c.len, b->c.contention,
+                log_names[b->c.log], b->ok ? "true" : "false", b->runs);
+        fprintf(f, "\"requests\":%llu,\"grants\":%llu,\"blocks\":%llu,\"deadlocks\":%llu,"
+                   "\"ticks\":%llu,\"wall_s\":%.6f,\"req_per_s\":%.1f,\"noise_pct\":%.2f,"
+                   "\"ns_per_tick\":%.1f,\"bpg\":%.4f,\"peak_rss_kb\":%ld,\"log_bytes\":%llu",
+                (unsigned long long)b->requests, (unsigned long long)b->grants,
+                (unsigned long long)b->blocks, (unsigned long long)b->deadlocks,
+                (unsigned long long)b->ticks, b->wall_s, b->req_per_s, b->noise_pct,
+                b->ns_per_tick, b->bpg, b->peak_rss_kb, (unsigned long long)b->log_bytes);
+        if (b->has_base) {
+            fprintf(f, ",\"base_req_per_s\":%.1f,\"delta_pct\":%.2f,\"tol_pct\":%.2f,"
+                       "\"rechecks\":%d,\"regressed\":%s,\"drift\":%s",
+                    b->base_req_per_s, b->delta_pct, b->tol_pct, b->rechecks,
+                    b->regressed ? "true" : "false", b->drift ? "true" : "false");
+        }
+        fprintf(f, "}%s\n", i + 1 < k ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+/* ============================
+ * Subcomando
+ * ============================ */
+
+/* "a,b,c" → v[0..]; devolve quantos valores leu (-1 se inválido) */
+static int parse_axis(const char *s, int v[BENCH_AXIS_MAX], int lo, int hi) {
+    int k = 0;
+    while (*s) {
+        char *end;
+        long x = strtol(s, &end, 10);
+        if (end == s || k == BENCH_AXIS_MAX || x < lo || x > hi) return -1;
+        v[k++] = (int)x;
+        s = end;
+        if (*s == ',') s++;
+        else if (*s) return -1;
+    }
+    return k;
+}
+
+static void bench_usage(const char *prog) {
+    fprintf(stderr,
+        "Uso: %s bench [--quick] [--reps R] [--seed S]"
+        " [--n a,b,..] [--m a,b,..] [--len a,b,..] [--contention a,b,..]"
+        " [--modes banker,ostrich] [--logs off,csv,bin] [--dir DIR]"
+        " [--out bench.json] [--baseline anterior.json [--threshold PCT] [--recheck R]]\n", prog);
+}
+
+/* Roda o caso num filho: o ru_maxrss do wait4 é o pico só daquele caso */
+static void bench_fork(BenchResult *br, int reps, uint64_t seed, const char *dir) {
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid == 0) {
+        br->ok = bench_case_run(&br->c, reps, seed, dir, br);
+        _exit(br->ok ? 0 : 1);
+    }
+    int st = 0;
+    struct rusage ru;
+    if (pid < 0 || wait4(pid, &st, 0, &ru) < 0 || !WIFEXITED(st)) {
+        br->ok = false;
+    } else {
+        br->peak_rss_kb = ru.ru_maxrss;
+    }
+}
+
+int bench_main(int argc, char **argv) {
+    int ns[BENCH_AXIS_MAX] = {64, 512},  nn = 2;
+    int ms[BENCH_AXIS_MAX] = {4, 16},    nm = 2;
+    int ls[BENCH_AXIS_MAX] = {4, 16},    nl = 2;
+    int cs[BENCH_AXIS_MAX] = {2, 8},     nc = 2;
+    const char *modes[BENCH_AXIS_MAX] = {"banker", "ostrich"};
+    int nmodes = 2;
+    BenchLog logs[3] = {BENCH_LOG_OFF, BENCH_LOG_CSV, BENCH_LOG_BIN};
+    int nlogs = 3;
+    int reps = 3;
+    unsigned long long seed = 1;
+    double thr = 0.10;
+    int recheck = BENCH_RECHECK;
+    const char *dir = "/tmp", *out_path = NULL, *base_path = NULL;
+
+    static struct option opts[] = {
+        {"quick",      no_argument,       0, 'q'},
+        {"reps",       required_argument, 0, 'k'},
+        {"seed",       required_argument, 0, 'r'},
+        {"n",          required_argument, 0, 'N'},
+        {"m",          required_argument, 0, 'M'},
+        {"len",        required_argument, 0, 'L'},
+        {"contention", required_argument, 0, 'C'},
+        {"modes",      required_argument, 0, 'p'},
+        {"logs",       required_argument, 0, 'g'},
+        {"dir",        required_argument, 0, 'd'},
+        {"out",        required_argument, 0, 'o'},
+        {"baseline",   required_argument, 0, 'b'},
+        {"threshold",  required_argument, 0, 't'},
+        {"recheck",    required_argument, 0, 'R'},
+        {"help",       no_argument,       0, 'h'},
+        {0,0,0,0}
+    };
+
+    int c, idx = 0;
+    optind = 1;
+    while ((c = getopt_long(argc - 1, argv + 1, "qk:r:N:M:L:C:p:g:d:o:b:t:R:h", opts, &idx)) != -1) {
+        switch (c) {
+            case 'q':
+                ns[0] = 64; ns[1] = 256; nn = 2;
+                ms[0] = 4;  nm = 1;
+                ls[0] = 4;  nl = 1;
+                reps = 1;
+                break;
+            case 'k': reps = atoi(optarg); break;
+            case 'r': seed = strtoull(optarg, NULL, 0); break;
+            case 'N': nn = parse_axis(optarg, ns, 1, MAX_P); break;
+            case 'M': nm = parse_axis(optarg, ms, 1, MAX_R); break;
+            case 'L': nl = parse_axis(optarg, ls, 1, MAX_REQS); break;
+            case 'C': nc = parse_axis(optarg, cs, 1, 1 << 20); break;
+            case 'p':
+                nmodes = 0;
+                for (char *t = strtok(optarg, ","); t; t = strtok(NULL, ",")) {
+                    if (nmodes == BENCH_AXIS_MAX || !policy_find(t)) {
+                        fprintf(stderr, "bench: modo inválido: %s\n", t);
+                        return 2;
+                    }
+                    modes[nmodes++] = t;
+                }
+                break;
+            case 'g':
+                nlogs = 0;
+                for (char *t = strtok(optarg, ","); t; t = strtok(NULL, ",")) {
+                    int v = -1;
+                    for (int i = 0; i < 3; ++i)
+                        if (strcmp(t, log_names[i]) == 0) v = i;
+                    if (v < 0 || nlogs == 3) {
+                        fprintf(stderr, "bench: log inválido: %s (off|csv|bin)\n", t);
+                        return 2;
+                    }
+                    logs[nlogs++] = (BenchLog)v;
+                }
+                break;
+            case 'd': dir = optarg; break;
+            case 'o': out_path = optarg; break;
+            case 'b': base_path = optarg; break;
+            case 't': thr = atof(optarg) / 100.0; break;
+            case 'R': recheck = atoi(optarg); break;
+            case 'h': default: bench_usage(argv[0]); return c == 'h' ? 0 : 1;
+        }
+    }
+    if (nn <= 0 || nm <= 0 || nl <= 0 || nc <= 0 || nmodes == 0 || nlogs == 0 || reps < 1 ||
+        recheck < 0) {
+        fprintf(stderr, "bench: grade inválida (limites: n <= %d, m <= %d, len <= %d)\n",
+                MAX_P, MAX_R, MAX_REQS);
+        bench_usage(argv[0]);
+        return 2;
+    }
+
+    /* Resultados num mapeamento compartilhado: cada filho escreve o seu */
+    int k = nn * nm * nl * nc * nmodes * nlogs;
+    size_t bytes = (size_t)k * sizeof(BenchResult);
+    BenchResult *res = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (res == MAP_FAILED) {
+        fprintf(stderr, "bench: sem memória para %d casos\n", k);
+        return 1;
+    }
+    memset(res, 0, bytes);
+
+    int i = 0;
+    for (int a = 0; a < nn; ++a)
+    for (int b = 0; b < nm; ++b)
+    for (int l = 0; l < nl; ++l)
+    for (int q = 0; q < nc; ++q)
+    for (int p = 0; p < nmodes; ++p)
+    for (int g = 0; g < nlogs; ++g) {
+        BenchResult *br = &res[i++];
+        br->c = (BenchCase){ modes[p], ns[a], ms[b], ls[l], cs[q], logs[g] };
+        snprintf(br->id, sizeof br->id, "%s/n%d/m%d/len%d/c%d/%s",
+                 policy_find(modes[p])->label, ns[a], ms[b], ls[l], cs[q], log_names[logs[g]]);
+    }
+
+    for (i = 0; i < k; ++i) {
+        bench_fork(&res[i], reps, (uint64_t)seed, dir);
+        bench_print_case(&res[i], stdout);
+    }
+
+    int rc = 0;
+    if (base_path) {
+        if (!bench_compare(res, k, base_path, thr)) {
+            rc = 1;
+        } else {
+            /* Só é regressão se repetir: o caso marcado é medido de novo,
+               até recheck vezes, e fica absolvido na primeira que passar */
+            for (i = 0; i < k; ++i) {
+                BenchResult *br = &res[i];
+                while (br->ok && br->regressed && br->rechecks < recheck) {
+                    br->rechecks++;
+                    bench_fork(br, reps, (uint64_t)seed, dir);
+                    if (br->ok) bench_judge(br, thr);
+                }
+            }
+            int reg = 0, drift = 0, cmp = 0;
+            for (i = 0; i < k; ++i) {
+                cmp   += res[i].has_base;
+                reg   += res[i].regressed;
+                drift += res[i].drift;
+                if (res[i].regressed || res[i].drift) bench_print_case(&res[i], stdout);
+            }
+            printf("baseline=%s compared=%d regressions=%d drift=%d threshold=%.1f%% recheck=%d\n",
+                   base_path, cmp, reg, drift, thr * 100.0, recheck);
+            if (reg) rc = 1;
+        }
+    }
+    for (i = 0; i < k; ++i)
+        if (!res[i].ok) rc = 1;
+
+    if (out_path) {
+        FILE *f = fopen(out_path, "w");
+        if (f) {
+            bench_write_json(res, k, reps, (uint64_t)seed, base_path, thr, recheck, f);
+            if (fclose(f) != 0) rc = 1;
+        } else {
+            fprintf(stderr, "bench: não abriu %s: %s\n", out_path, strerror(errno));
+            rc = 1;
+        }
+    }
+    munmap(res, bytes);
+    return rc;
+}
@@ -0,0 +1,408 @@
+/* ---------------------------------------------------------------------
+ * check.c — Conferência dos atalhos contra a redução clássica
+ * Lockstep: a política do caso é envolvida por uma que, antes de cada
+ * decisão, calcula a resposta de referência (req_within_bounds + safety
+ * de Coffman/Dijkstra sobre Available, Need e Allocation crus, como se
+ * o pedido já estivesse concedido) e depois compara com a da política.
+ * BANKER passa pelo atalho de Need (user-043), pelo envelope seguro
+ * (user-050), pela partição e pelos bitsets (user-047); CLAIM pelo grafo
+ * de reivindicação (user-048). No OSTRICH, quem é conferido a cada
+ * pedido é o detector (detect_deadlock_set, com os bitsets montados).
+ * Na primeira divergência o caso para com S->fault e a mensagem diz o
+ * pedido; o caso reproduz com --mode/--scenario/--n/--m/--sched/--seed.
+ * Prevenção (ordered, wait-die, wound-wait): sem referência de decisão;
+ * confere que todo processo de roteiro termina segurando o Max inteiro,
+ * inclusive os recomeçados após um aborto (user-029).
+ * --------------------------------------------------------------------- */
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "policy.h"
+#include "process.h"
+#include "scheduler.h"
+#include "detector.h"
+#include "events.h"
+#include "explore.h"
+#include "shard.h"
+
+/* ============================
+ * Referência
+ * ============================ */
+
+static bool *g_fin;                /* Finish da referência (n do caso)  */
+
+/* Processos que não terminam na redução clássica sobre o estado cru; com
+   P != NULL, como se req já tivesse sido concedido a P. 0 = seguro. */
+static int plain_stuck(const System *S, const Process *P, const int req[MAX_R]) {
+    int n = S->n, m = S->m, Work[MAX_R];
+    for (int j = 0; j < m; ++j) Work[j] = S->Available[j] - (P ? req[j] : 0);
+    for (int i = 0; i < n; ++i) g_fin[i] = false;
+
+    int left = n;
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (int i = 0; i < n; ++i) {
+            if (g_fin[i]) continue;
+            const Process *q = &S->procs[i];
+            int d = q == P, j = 0;
+            while (j < m && q->Need[j] - (d ? req[j] : 0) <= Work[j]) ++j;
+            if (j < m) continue;
+            for (j = 0; j < m; ++j) Work[j] += q->Allocation[j] + (d ? req[j] : 0);
+            g_fin[i] = true;
+            left--;
+            progress = true;
+        }
+    }
+    return left;
+}
+
+/* ============================
+ * Lockstep
+ * ============================ */
+
+static const Policy *g_inner;      /* política conferida                */
+static Policy        g_wrap;       /* g_inner com check_on_request      */
+static bool          g_detect;     /* OSTRICH: confere o detector       */
+static bool          g_held;       /* prevenção: confere Max no término */
+static const char   *g_case;
+static uint64_t      g_compared;
+
+static void check_fail(System *S, const Process *P, const char *what, int got, int want) {
+    if (!S->fault) {
+        fprintf(stderr, "check: %s: P%d tick=%llu: %s=%d, referência=%d\n",
+                g_case, P->id, (unsigned long long)S->sim_clock, what, got, want);
+    }
+    S->fault = "check: divergência da referência";
+}
+
+static bool check_on_request(System *S, Process *P, const int req[MAX_R]) {
+    if (g_detect) {
+        ub_ensure(S);                              /* detector em bitsets */
+        int got = detect_deadlock_set(S, NULL), want = plain_stuck(S, NULL, NULL);
+        g_compared++;
+        if (got != want) check_fail(S, P, "deadlocked", got, want);
+        return g_inner->on_request(S, P, req);
+    }
+    bool want = req_within_bounds(S, P, req) && plain_stuck(S, P, req) == 0;
+    bool got  = g_inner->on_request(S, P, req);
+    g_compared++;
+    if (got != want) check_fail(S, P, "concede", got, want);
+    return got;
+}
+
+/* Fim de roteiro (não aborto): P tem de estar segurando o Max inteiro */
+static void check_on_release(System *S, Process *P) {
+    if (g_held && !P->co && proc_script_done(P)) {
+        for (int j = 0; j < S->m; ++j) {
+            if (P->Need[j] != 0) {
+                check_fail(S, P, "Need no término", (int)P->Need[j], 0);
+                break;
+            }
+        }
+    }
+    if (g_inner->on_release) g_inner->on_release(S, P);
+}
+
+typedef struct CheckCase {
+    const char *mode;
+    const char *scenario;
+    int         n, m;
+    SchedKind   sched;
+    SimEngine   engine;
+} CheckCase;
+
+/* Totais por grupo e o quanto cada atalho foi exercitado */
+typedef struct CheckTotals {
+    int      cases, failed;
+    uint64_t compared;
+    uint64_t fast_path, env_hits, unit_decisions, claim_graph, detect_bits;
+    uint64_t por_states, full_states, por_pruned;
+    uint64_t commits;
+    uint64_t restarts;
+} CheckTotals;
+
+/* Instâncias de cada recurso: Available + soma de Allocation */
+static void units_of(const System *S, long long u[MAX_R]) {
+    for (int j = 0; j < S->m; ++j) {
+        u[j] = S->Available[j];
+        for (int i = 0; i < S->n; ++i) u[j] += S->procs[i].Allocation[j];
+    }
+}
+
+static bool units_kept(const System *S, const long long u0[MAX_R]) {
+    long long u[MAX_R];
+    units_of(S, u);
+    return memcmp(u, u0, (size_t)S->m * sizeof *u) == 0;
+}
+
+static bool run_lockstep(System *S, const CheckCase *c, uint64_t seed,
+                         CheckLoadFn load, CheckTotals *t)
+{
+    const Policy *pol = policy_find(c->mode);
+    char id[128];
+    snprintf(id, sizeof id, "%s/%s/n%d/m%d/%s/%s/seed%llu", pol->label, c->scenario,
+             c->n, c->m, sched_kind_str(c->sched), c->engine == ENGINE_EVENT ? "event" : "tick",
+             (unsigned long long)seed);
+
+    g_inner = pol;
+    g_wrap = *pol;
+    g_held = pol == &policy_ordered || pol == &policy_wait_die || pol == &policy_wound_wait;
+    if (!g_held) g_wrap.on_request = check_on_request;
+    g_wrap.on_release = check_on_release;
+    g_detect = pol == &policy_ostrich;
+    g_case = id;
+    g_compared = 0;
+
+    sim_init(S, c->n, c->m, &g_wrap);
+    bool ok = load(S, c->scenario, seed);
+    long long u0[MAX_R];
+    if (ok) {
+        units_of(S, u0);
+        sched_init(&S->sched, c->sched, seed);
+        S->ev_cfg.engine = c->engine;
+        S->ev_cfg.seed = seed;
+        if (c->engine == ENGINE_EVENT) sim_run_events(S);
+        else                           sim_run(S);
+        ok = !S->fault;
+        if (ok && !units_kept(S, u0)) {
+            fprintf(stderr, "check: %s: instâncias não conferem no fim\n", id);
+            ok = false;
+        }
+        if (ok && !g_detect && S->n_finished < S->n) {   /* evitação e prevenção não travam */
+            fprintf(stderr, "check: %s: %d de %d processos terminaram\n", id, S->n_finished, S->n);
+            ok = false;
+        }
+    } else {
+        fprintf(stderr, "check: %s: cenário não carregou\n", id);
+    }
+
+    const Metrics *mt = &S->metrics;
+    bool units = S->bits.valid && S->bits.n_unit > 0;
+    t->cases++;
+    t->failed += !ok;
+    t->compared  += g_compared;
+    t->restarts  += mt->restarts;
+    t->fast_path += mt->safety_fast_path;
+    t->env_hits  += mt->env_hits;
+    if (pol == &policy_banker && units) t->unit_decisions += mt->decisions;
+    if (pol == &policy_claim)           t->claim_graph += mt->decisions - mt->claim_fallbacks;
+    if (g_detect && units)              t->detect_bits += g_compared;
+    sim_finalize(S);
+    return ok;
+}
+
+/* ============================
+ * POR e shards
+ * ============================ */
+
+/* Conjuntos teimosos preservam todo estado travado: com e sem POR a
+   exploração tem de achar os mesmos (e o mesmo "todos terminam") */
+static bool run_por(System *S, const char *mode, const char *scenario, int n, int m,
+                    uint64_t seed, CheckLoadFn load, CheckTotals *t)
+{
+    const Policy *pol = policy_find(mode);
+    ExploreResult r[2];
+    bool ok = true;
+    for (int k = 0; k < 2; ++k) {
+        ExploreConfig cfg = { 1, k == 1, 20 };
+        sim_init(S, n, m, pol);
+        ok = ok && load(S, scenario, seed) && explore_run(S, &cfg, &r[k]);
+        sim_finalize(S);
+        if (!ok) {
+            if (k == 1) explore_result_free(&r[0]);
+            break;
+        }
+    }
+    if (ok) {
+        ok = r[0].complete && r[1].complete && r[0].deadlocked == r[1].deadlocked &&
+             r[0].all_finish == r[1].all_finish && r[1].states <= r[0].states;
+        if (!ok) {
+            fprintf(stderr, "check: %s/%s/n%d/m%d/seed%llu: explore sem POR deadlocked=%llu"
+                            " all_finish=%d, com POR deadlocked=%llu all_finish=%d\n",
+                    pol->label, scenario, n, m, (unsigned long long)seed,
+                    (unsigned long long)r[0].deadlocked, r[0].all_finish,
+                    (unsigned long long)r[1].deadlocked, r[1].all_finish);
+        }
+        t->full_states += r[0].states;
+        t->por_states  += r[1].states;
+        t->por_pruned  += r[1].por_pruned;
+        explore_result_free(&r[0]);
+        explore_result_free(&r[1]);
+    } else {
+        fprintf(stderr, "check: %s/%s/seed%llu: exploração falhou\n",
+                pol->label, scenario, (unsigned long long)seed);
+    }
+    t->cases++;
+    t->failed += !ok;
+    return ok;
+}
+
+/* BANKER em K shards: o commit no pool não pode travar nem perder
+   instância, e todo pedido do roteiro é concedido uma vez, como no
+   sim_run de um processo só */
+static bool run_shards(System *S, const char *scenario, int n, int m, int shards,
+                       uint64_t seed, CheckLoadFn load, CheckTotals *t)
+{
+    uint64_t grants[2] = {0, 0};
+    int finished[2] = {0, 0};
+    bool ok = true, stalled = false;
+    for (int k = 0; k < 2 && ok; ++k) {
+        sim_init(S, n, m, &policy_banker);
+        ok = load(S, scenario, seed);
+        long long u0[MAX_R];
+        if (ok) {
+            units_of(S, u0);
+            sched_init(&S->sched, SK_INDEX, seed);
+            if (k == 0) {
+                sim_run(S);
+            } else {
+                ShardResult res;
+                ok = shard_run(S, shards, &res);
+                stalled = res.stalled;
+                for (int s = 0; s < res.shards; ++s) t->commits += res.stat[s].commits;
+            }
+            ok = ok && !S->fault && units_kept(S, u0);
+            grants[k] = S->metrics.grants;
+            finished[k] = S->n_finished;
+        }
+        sim_finalize(S);
+    }
+    ok = ok && !stalled && grants[0] == grants[1] && finished[0] == n && finished[1] == n;
+    if (!ok) {
+        fprintf(stderr, "check: BANKER/%s/n%d/m%d/shards%d/seed%llu: grants %llu vs %llu,"
+                        " terminaram %d vs %d de %d%s\n",
+                scenario, n, m, shards, (unsigned long long)seed,
+                (unsigned long long)grants[0], (unsigned long long)grants[1],
+                finished[0], finished[1], n, stalled ? " (stalled)" : "");
+    }
+    t->cases++;
+    t->failed += !ok;
+    return ok;
+}
+
+/* ============================
+ * Subcomando
+ * ============================ */
+
+/* Atalho sem nenhuma decisão na grade: a conferência dele seria vazia */
+static int require(const char *what, uint64_t v) {
+    if (v) return 0;
+    fprintf(stderr, "check: %s não foi exercitado pela grade\n", what);
+    return 1;
+}
+
+static void check_usage(const char *prog) {
+    fprintf(stderr, "Uso: %s check [--seeds K] [--seed S]\n", prog);
+}
+
+int check_main(int argc, char **argv, CheckLoadFn load) {
+    int seeds = 3;
+    unsigned long long seed = 1;
+
+    static struct option opts[] = {
+        {"seeds", required_argument, 0, 'k'},
+        {"seed",  required_argument, 0, 'r'},
+        {"help",  no_argument,       0, 'h'},
+        {0,0,0,0}
+    };
+    int c, idx = 0;
+    optind = 1;
+    while ((c = getopt_long(argc - 1, argv + 1, "k:r:h", opts, &idx)) != -1) {
+        switch (c) {
+            case 'k': seeds = atoi(optarg); break;
+            case 'r': seed = strtoull(optarg, NULL, 0); break;
+            case 'h': default: check_usage(argv[0]); return c == 'h' ? 0 : 2;
+        }
+    }
+    if (seeds < 1) {
+        check_usage(argv[0]);
+        return 2;
+    }
+
+    /* Grade do lockstep: random com colunas contadas e (n pequeno) de
+       instância única, workers com devolução parcial, locks só em bits */
+    static const struct { const char *scenario; int n, m; } grid[] = {
+        {"random", 24, 4}, {"random", 96, 8}, {"workers", 48, 4},
+        {"locks", 24, 16}, {"locks", 64, 32},
+    };
+    static const char *const modes[] = {"banker", "claim", "ostrich"};
+    static const SchedKind scheds[] = {SK_INDEX, SK_RANDOM};
+    int ng = (int)(sizeof grid / sizeof grid[0]);
+
+    /* Prevenção: cenários com alocação de carga (deadlock, cycle-4,
+       hotspot) e random, onde os abortos recomeçam roteiros parciais */
+    static const struct { const char *scenario; int n, m; } pgrid[] = {
+        {"deadlock", 2, 2}, {"cycle-4", 4, 2}, {"hotspot", 8, 4}, {"random", 24, 4},
+    };
+    static const char *const pmodes[] = {"ordered", "wait-die", "wound-wait"};
+    int npg = (int)(sizeof pgrid / sizeof pgrid[0]);
+
+    System *S = calloc(1, sizeof *S);
+    g_fin = malloc(MAX_P * sizeof *g_fin);
+    if (!S || !g_fin) {
+        fprintf(stderr, "check: sem memória para o System\n");
+        free(S);
+        free(g_fin);
+        return 1;
+    }
+
+    CheckTotals ls = {0}, pv = {0}, por = {0}, sh = {0};
+    for (int s = 0; s < seeds; ++s) {
+        uint64_t sd = (uint64_t)seed + (uint64_t)s;
+        for (int g = 0; g < ng; ++g)
+        for (int p = 0; p < 3; ++p)
+        for (int q = 0; q < 2; ++q)
+        for (int e = 0; e < 2; ++e) {
+            /* corrotinas só no motor por ticks */
+            if (e == 1 && strcmp(grid[g].scenario, "workers") == 0) continue;
+            CheckCase cc = { modes[p], grid[g].scenario, grid[g].n, grid[g].m,
+                             scheds[q], e ? ENGINE_EVENT : ENGINE_TICK };
+            run_lockstep(S, &cc, sd, load, &ls);
+        }
+        for (int g = 0; g < npg; ++g)
+        for (int p = 0; p < 3; ++p)
+        for (int e = 0; e < 2; ++e) {
+            CheckCase cc = { pmodes[p], pgrid[g].scenario, pgrid[g].n, pgrid[g].m,
+                             SK_INDEX, e ? ENGINE_EVENT : ENGINE_TICK };
+            run_lockstep(S, &cc, sd, load, &pv);
+        }
+        for (int p = 0; p < 3; p += 2) {
+            run_por(S, modes[p], "random", 6, 3, sd, load, &por);
+            run_por(S, modes[p], "locks", 6, 5, sd, load, &por);
+        }
+        for (int k = 2; k <= 4; k += 2) {
+            run_shards(S, "random", 64, 4, k, sd, load, &sh);
+            run_shards(S, "locks", 32, 16, k, sd, load, &sh);
+        }
+    }
+    free(g_fin);
+    g_fin = NULL;
+    free(S);
+
+    printf("check lockstep | casos=%d falhas=%d comparações=%llu | fast_path=%llu env_hits=%llu"
+           " bitsets=%llu claim=%llu detector_bits=%llu\n",
+           ls.cases, ls.failed, (unsigned long long)ls.compared,
+           (unsigned long long)ls.fast_path, (unsigned long long)ls.env_hits,
+           (unsigned long long)ls.unit_decisions, (unsigned long long)ls.claim_graph,
+           (unsigned long long)ls.detect_bits);
+    printf("check prevenção| casos=%d falhas=%d | restarts=%llu\n",
+           pv.cases, pv.failed, (unsigned long long)pv.restarts);
+    printf("check por      | casos=%d falhas=%d | estados=%llu sem_por=%llu por_pruned=%llu\n",
+           por.cases, por.failed, (unsigned long long)por.por_states,
+           (unsigned long long)por.full_states, (unsigned long long)por.por_pruned);
+    printf("check shards   | casos=%d falhas=%d | commits=%llu\n",
+           sh.cases, sh.failed, (unsigned long long)sh.commits);
+
+    int missing = require("atalho de Need (safety_fast_path)", ls.fast_path) +
+                  require("envelope seguro (env_hits)", ls.env_hits) +
+                  require("safety em bitsets", ls.unit_decisions) +
+                  require("grafo de reivindicação", ls.claim_graph) +
+                  require("detector em bitsets", ls.detect_bits) +
+                  require("POR (por_pruned)", por.por_pruned) +
+                  require("commit no pool (commits)", sh.commits) +
+                  require("recomeço após aborto (restarts)", pv.restarts);
+    return ls.failed || pv.failed || por.failed || sh.failed || missing ? 1 : 0;
+}
@@ -0,0 +1,353 @@
+/* ---------------------------------------------------------------------
+ * claim.c — Evitação pelo grafo de reivindicação (--mode claim)
+ * Conceder R a P troca a aresta P→R por R→P; o estado continua seguro
+ * sse isso não fecha ciclo, ou seja, sse ainda não há caminho P ⇝ R.
+ * A ordem topológica do grafo (ClaimGraph.ord) é mantida como em
+ * Pearce–Kelly: se ord[R] < ord[P] a aresta nova já respeita a ordem e
+ * a decisão é O(1); senão uma busca para frente a partir de P e outra
+ * para trás a partir de R, ambas só dentro da faixa [ord[P], ord[R]],
+ * acham o ciclo ou reordenam apenas os nós visitados.
+ * Arestas novas fora daqui (devolução parcial, aborto, registro) que
+ * desrespeitem a ordem a invalidam (cg_set); ela é refeita no próximo
+ * pedido em O(n + m + arestas). O grafo só existe neste modo: é montado
+ * dos bitsets no primeiro pedido e some a cada sys_need_invalidate.
+ * --------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "claim.h"
+#include "banker.h"
+#include "policy.h"
+#include "timing.h"
+#include "trace.h"
+#include "scratch.h"
+
+#define RNODE(j) (MAX_P + (j))
+
+/* Arestas de P ainda não aplicadas (pedido em curso) */
+typedef struct Overlay {
+    int        pid;
+    const u64 *drop;      /* colunas com P→R removida        */
+    const u64 *add;       /* colunas com R→P já inserida     */
+} Overlay;
+
+/* Monta holder e claim a partir dos bitsets; a ordem fica para depois */
+static void cg_build(System *S) {
+    const UnitBits *b = &S->bits;
+    ClaimGraph *g = &S->cg;
+    memset(g->claim, 0, sizeof g->claim);
+    memset(g->mark, 0, sizeof g->mark);
+    g->stamp = 0;
+    g->ord_valid = false;
+    for (int j = 0; j < MAX_R; ++j) g->holder[j] = -1;
+    for (int i = 0; i < S->n; ++i)
+        for (int w = 0; w < b->words; ++w) {
+            for (u64 t = b->need[i][w]; t; t &= t - 1)
+                g->claim[w * 64 + __builtin_ctzll(t)][i >> 6] |= 1ull << (i & 63);
+            for (u64 t = b->alloc[i][w]; t; t &= t - 1)
+                g->holder[w * 64 + __builtin_ctzll(t)] = i;
+        }
+    g->valid = true;
+}
+
+/* Refaz a ordem do zero (Kahn). false: o grafo tem ciclo (estado inseguro) */
+static bool order_build(System *S) {
+    const UnitBits *b = &S->bits;
+    ClaimGraph *g = &S->cg;
+    int n = S->n, m = S->m, words = b->words;
+    int *indeg = malloc(CG_NODES * sizeof *indeg);
+    int *queue = malloc(CG_NODES * sizeof *queue);
+    if (!indeg || !queue) {
+        free(indeg); free(queue);
+        return false;
+    }
+
+    int head = 0, tail = 0;
+    for (int i = 0; i < n; ++i) {
+        int d = 0;
+        for (int w = 0; w < words; ++w) d += __builtin_popcountll(b->alloc[i][w]);
+        indeg[i] = d;
+        if (d == 0) queue[tail++] = i;
+    }
+    for (int j = 0; j < m; ++j) {
+        int d = 0;
+        for (int w = 0; w < CG_PWORDS; ++w) d += __builtin_popcountll(g->claim[j][w]);
+        indeg[RNODE(j)] = d;
+        if (d == 0) queue[tail++] = RNODE(j);
+    }
+
+    int pos = 0;
+    while (head < tail) {
+        int v = queue[head++];
+        g->ord[v] = pos;
+        g->at[pos++] = v;
+        if (v < MAX_P) {
+            for (int w = 0; w < words; ++w) {
+                for (u64 t = b->need[v][w]; t; t &= t - 1) {
+                    int r = RNODE(w * 64 + __builtin_ctzll(t));
+                    if (--indeg[r] == 0) queue[tail++] = r;
+                }
+            }
+        } else {
+            int h = g->holder[v - MAX_P];
+            if (h >= 0 && --indeg[h] == 0) queue[tail++] = h;
+        }
+    }
+    free(indeg); free(queue);
+
+    g->ord_n = n;
+    g->ord_valid = (pos == n + m);
+    return g->ord_valid;
+}
+
+static int cmp_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Insere x→y na ordem (o grafo é o atual com as mudanças de 'ov').
+ * false se a aresta fecharia ciclo (nada muda). *moved indica reordenação.
+ */
+static bool order_insert(System *S, int x, int y, const Overlay *ov, bool *moved) {
+    const UnitBits *b = &S->bits;
+    ClaimGraph *g = &S->cg;
+    int lb = g->ord[y], ub = g->ord[x];
+    if (ub < lb) return true;            /* já respeita a ordem: O(1) */
+    S->metrics.claim_searches++;
+
+    if (++g->stamp == 0) {
+        memset(g->mark, 0, sizeof g->mark);
+        g->stamp = 1;
+    }
+    unsigned st = g->stamp;
+    int words = b->words, pid = ov->pid;
+    int nodes = S->n + S->m;                 /* cada nó entra uma vez */
+    int *stack = scratch_get(SCR_CLAIM, 3 * (size_t)nodes * sizeof *stack);
+    if (!stack) {                            /* request_claim já reservou */
+        S->fault = "claim sem memória para os buffers de trabalho";
+        return false;
+    }
+    int *kf = stack + nodes, *kb = kf + nodes;
+    int nf = 0, nb = 0, sp = 0;
+
+    /* Para frente a partir de y, só ord < ub: achar x fecha o ciclo */
+    stack[sp++] = y;
+    g->mark[y] = st;
+    while (sp > 0) {
+        int v = stack[--sp];
+        kf[nf++] = g->ord[v];
+        if (v < MAX_P) {
+            for (int w = 0; w < words; ++w) {
+                u64 t = b->need[v][w];
+                if (v == pid) t &= ~ov->drop[w];
+                for (; t; t &= t - 1) {
+                    int r = RNODE(w * 64 + __builtin_ctzll(t));
+                    if (g->ord[r] == ub) {
+                        S->metrics.claim_visited += (uint64_t)nf;
+                        return false;
+                    }
+                    if (g->mark[r] != st && g->ord[r] < ub) {
+                        g->mark[r] = st;
+                        stack[sp++] = r;
+                    }
+                }
+            }
+        } else {
+            int j = v - MAX_P;
+            int h = (ov->add[j >> 6] >> (j & 63) & 1) ? pid : g->holder[j];
+            if (h < 0) continue;
+            if (g->ord[h] == ub) {
+                S->metrics.claim_visited += (uint64_t)nf;
+                return false;
+            }
+            if (g->mark[h] != st && g->ord[h] < ub) {
+                g->mark[h] = st;
+                stack[sp++] = h;
+            }
+        }
+    }
+
+    /* Para trás a partir de x, só ord > lb (disjunto do anterior: um nó
+       comum daria caminho y ⇝ x, já recusado acima) */
+    stack[sp++] = x;
+    g->mark[x] = st;
+    while (sp > 0) {
+        int v = stack[--sp];
+        kb[nb++] = g->ord[v];
+        if (v < MAX_P) {
+            for (int w = 0; w < words; ++w) {
+                u64 t = b->alloc[v][w];
+                if (v == pid) t |= ov->add[w];
+                for (; t; t &= t - 1) {
+                    int r = RNODE(w * 64 + __builtin_ctzll(t));
+                    if (g->mark[r] != st && g->ord[r] > lb) {
+                        g->mark[r] = st;
+                        stack[sp++] = r;
+                    }
+                }
+            }
+        } else {
+            int j = v - MAX_P;
+            bool dropped = ov->drop[j >> 6] >> (j & 63) & 1;
+            for (int w = 0; w < CG_PWORDS; ++w) {
+                u64 t = g->claim[j][w];
+                if (dropped && w == (pid >> 6)) t &= ~(1ull << (pid & 63));
+                for (; t; t &= t - 1) {
+                    int q = w * 64 + __builtin_ctzll(t);
+                    if (g->mark[q] != st && g->ord[q] > lb) {
+                        g->mark[q] = st;
+                        stack[sp++] = q;
+                    }
+                }
+            }
+        }
+    }
+    S->metrics.claim_visited += (uint64_t)(nf + nb);
+
+    /* Reordena: os de trás (kb) antes dos da frente (kf), reaproveitando
+       as mesmas posições em ordem crescente */
+    qsort(kb, (size_t)nb, sizeof *kb, cmp_int);
+    qsort(kf, (size_t)nf, sizeof *kf, cmp_int);
+    int *node = stack;                          /* nós na nova ordem */
+    for (int i = 0; i < nb; ++i) node[i] = g->at[kb[i]];
+    for (int i = 0; i < nf; ++i) node[nb + i] = g->at[kf[i]];
+    int i = 0, f = 0, k = 0;
+    while (i < nb || f < nf) {
+        int p = (f == nf || (i < nb && kb[i] < kf[f])) ? kb[i++] : kf[f++];
+        g->ord[node[k]] = p;
+        g->at[p] = node[k++];
+    }
+    *moved = true;
+    return true;
+}
+
+bool request_claim(System *S, Process *P, const int req[MAX_R]) {
+    if (!S || !P || !req) return false;
+    ub_ensure(S);
+    const UnitBits *b = &S->bits;
+    ClaimGraph *g = &S->cg;
+    if (b->n_counted > 0) {
+        S->metrics.claim_fallbacks++;
+        return request_banker(S, P, req);
+    }
+
+    /* Checagens básicas (as do banqueiro) */
+    for (int j = 0; j < S->m; ++j) {
+        int r = req[j];
+        if (r < 0 || r > P->Need[j] || r > S->Available[j]) return false;
+    }
+
+    if (!g->valid) {
+        unsigned long long t0 = now_ns();
+        cg_build(S);
+        metrics_record_rebuild(&S->metrics, now_ns() - t0);
+    }
+    if (!g->ord_valid) {
+        S->metrics.claim_rebuilds++;
+        unsigned long long t0 = now_ns();
+        bool built = order_build(S);
+        metrics_record_rebuild(&S->metrics, now_ns() - t0);
+        if (!built) {                   /* ciclo já no estado atual */
+            S->metrics.claim_fallbacks++;
+            return request_banker(S, P, req);
+        }
+    }
+
+    /* Buffers das buscas (n + m nós) fora da pilha; sem eles não há decisão */
+    if (!scratch_get(SCR_CLAIM, 3 * (size_t)(S->n + S->m) * sizeof(int))) {
+        S->fault = "claim sem memória para os buffers de trabalho";
+        return false;
+    }
+
+    u64 drop[UB_WORDS] = {0}, add[UB_WORDS] = {0};
+    for (int j = 0; j < S->m; ++j) if (req[j]) drop[j >> 6] |= 1ull << (j & 63);
+    Overlay ov = { P->id, drop, add };
+
+    bool moved = false, safe = true;
+    for (int w = 0; w < b->words && safe; ++w) {
+        for (u64 t = drop[w]; t; t &= t - 1) {
+            int j = w * 64 + __builtin_ctzll(t);
+            if (!order_insert(S, RNODE(j), P->id, &ov, &moved)) { safe = false; break; }
+            add[w] |= 1ull << (j & 63);
+        }
+    }
+    if (safe && sys_grant(S, P, req)) return true;
+
+    /* Negado: a ordem pode ter andado para o grafo com as trocas; devolve
+       as arestas P→R (o grafo real é acíclico, a inserção não falha) */
+    if (moved) {
+        memset(add, 0, sizeof add);
+        for (int w = 0; w < b->words; ++w) {
+            while (drop[w]) {
+                int j = w * 64 + __builtin_ctzll(drop[w]);
+                drop[w] &= drop[w] - 1;
+                if (!order_insert(S, P->id, RNODE(j), &ov, &moved)) g->ord_valid = false;
+            }
+        }
+    }
+    return false;
+}
+
+/* ============================
+ * Política CLAIM
+ * ============================ */
+
+static bool claim_on_request(System *S, Process *P, const int req[MAX_R]) {
+    if (!req_within_bounds(S, P, req)) return false;
+
+    unsigned long long t0 = now_ns();
+    bool ok = request_claim(S, P, req);
+    unsigned long long t1 = now_ns();
+    metrics_record_decision(&S->metrics, t1 - t0);
+    trace_host(TR_HOST_SAFETY, t0, t1);
+    return ok;
+}
+
+static void claim_write_metrics_json(const System *S, FILE *f) {
+    const Metrics *mt = &S->metrics;
+    fprintf(f,
+        ",\n  \"decisions\": %llu"
+        ",\n  \"ns_in_decisions_total\": %llu"
+        ",\n  \"banker_safety_calls\": %llu"
+        ",\n  \"ns_in_safety_total\": %llu"
+        ",\n  \"rebuilds\": %llu"
+        ",\n  \"ns_in_rebuild_total\": %llu"
+        ",\n  \"claim_searches\": %llu"
+        ",\n  \"claim_visited\": %llu"
+        ",\n  \"claim_rebuilds\": %llu"
+        ",\n  \"claim_fallbacks\": %llu",
+        (unsigned long long)mt->decisions,
+        (unsigned long long)mt->ns_in_decisions_total,
+        (unsigned long long)mt->banker_safety_calls,
+        (unsigned long long)mt->ns_in_safety_total,
+        (unsigned long long)mt->rebuilds,
+        (unsigned long long)mt->ns_in_rebuild_total,
+        (unsigned long long)mt->claim_searches,
+        (unsigned long long)mt->claim_visited,
+        (unsigned long long)mt->claim_rebuilds,
+        (unsigned long long)mt->claim_fallbacks);
+}
+
+static void claim_print_summary(const System *S, FILE *f) {
+    const Metrics *mt = &S->metrics;
+    unsigned long long calls = mt->decisions;      /* a decisão do claim é o "safety" */
+    unsigned long long ns    = mt->ns_in_decisions_total;
+    fprintf(f, " | decisions=%llu ns_total=%llu", calls, ns);
+    if (calls) fprintf(f, " avg_ns=%llu", ns / calls);
+    if (mt->banker_safety_calls)
+        fprintf(f, " safety_calls=%llu", (unsigned long long)mt->banker_safety_calls);
+    fprintf(f, " searches=%llu visited=%llu fallbacks=%llu",
+            (unsigned long long)mt->claim_searches,
+            (unsigned long long)mt->claim_visited,
+            (unsigned long long)mt->claim_fallbacks);
+}
+
+const Policy policy_claim = {
+    .name               = "claim",
+    .label              = "CLAIM",
+    .detect_on_stall    = false,
+    .on_request         = claim_on_request,
+    .write_metrics_json = claim_write_metrics_json,
+    .print_summary      = claim_print_summary,
+};
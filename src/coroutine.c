@@ -0,0 +1,300 @@
+/* ---------------------------------------------------------------------
+ * coroutine.c — Troca de contexto, pool de pilhas e timers de compute(t)
+ * x86-64: co_switch em asm salva só os registradores callee-saved na
+ * própria pilha (sem syscall). Outras arquiteturas: ucontext.
+ * Pilhas vêm de blocos mmap de CO_SLAB_STACKS e voltam a uma free list
+ * quando a corrotina termina ou é abortada; sem páginas de guarda (um
+ * VMA por pilha esgotaria vm.max_map_count), mas com canário no fundo.
+ * Estado do motor é por thread: a corrotina só roda na thread do sim_run.
+ * --------------------------------------------------------------------- */
+#define _DEFAULT_SOURCE
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "coroutine.h"
+#include "scheduler.h"
+#include "simulator.h"
+#include "process.h"
+#include "trace.h"
+
+#if !defined(__x86_64__)
+#include <ucontext.h>
+#endif
+
+#define CO_CANARY 0xC0DEDBADC0FFEE11ull
+
+/* Fundo de cada pilha: canário (e, sem asm, o ucontext da corrotina) */
+typedef struct CoStackBase {
+    uint64_t canary;
+    struct CoStackBase *next_free;
+#if !defined(__x86_64__)
+    ucontext_t uc;
+#endif
+} CoStackBase;
+
+typedef struct CoTimer {
+    uint64_t wake;
+    struct Process *P;
+} CoTimer;
+
+typedef struct CoEngine {
+    CoTask      *cur;           /* corrotina em execução            */
+#if defined(__x86_64__)
+    void        *main_sp;
+#else
+    ucontext_t   main_uc;
+#endif
+    CoStackBase *free_list;
+    uint64_t     allocated, in_use;
+    CoTimer     *heap;          /* min-heap por wake                 */
+    int          heap_len, heap_cap;
+} CoEngine;
+
+static _Thread_local CoEngine g_co;
+
+/* ============================
+ * Troca de contexto
+ * ============================ */
+#if defined(__x86_64__)
+/* co_switch(&salvar_sp, novo_sp): empilha rbp/rbx/r12-r15, troca rsp */
+void co_switch(void **save_sp, void *new_sp);
+__asm__(
+    ".text\n"
+    ".globl co_switch\n"
+    ".type co_switch,@function\n"
+    "co_switch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    movq  %rsp, (%rdi)\n"
+    "    movq  %rsi, %rsp\n"
+    "    popq  %r15\n"
+    "    popq  %r14\n"
+    "    popq  %r13\n"
+    "    popq  %r12\n"
+    "    popq  %rbx\n"
+    "    popq  %rbp\n"
+    "    ret\n"
+    ".size co_switch, .-co_switch\n");
+#endif
+
+static void co_entry(void);
+
+static void ctx_make(CoTask *t) {
+    CoStackBase *b = t->stack;
+#if defined(__x86_64__)
+    /* Topo alinhado em 16; ao entrar em co_entry rsp ≡ 8 (mod 16),
+       como depois de um call. Seis zeros = registradores restaurados. */
+    uintptr_t top = ((uintptr_t)b + CO_STACK_SIZE) & ~(uintptr_t)15;
+    void **sp = (void **)top;
+    *--sp = NULL;                    /* retorno falso de co_entry */
+    *--sp = (void *)co_entry;
+    for (int i = 0; i < 6; ++i) *--sp = NULL;
+    t->sp = sp;
+#else
+    getcontext(&b->uc);
+    b->uc.uc_stack.ss_sp   = (char *)b + sizeof *b;
+    b->uc.uc_stack.ss_size = CO_STACK_SIZE - sizeof *b;
+    b->uc.uc_link = NULL;
+    makecontext(&b->uc, co_entry, 0);
+    t->sp = &b->uc;
+#endif
+}
+
+/* sim_run → corrotina */
+static void ctx_enter(CoTask *t) {
+#if defined(__x86_64__)
+    co_switch(&g_co.main_sp, t->sp);
+#else
+    swapcontext(&g_co.main_uc, (ucontext_t *)t->sp);
+#endif
+}
+
+/* corrotina → sim_run */
+static void ctx_leave(CoTask *t) {
+    assert(((CoStackBase *)t->stack)->canary == CO_CANARY && "estouro de pilha da corrotina");
+#if defined(__x86_64__)
+    co_switch(&t->sp, g_co.main_sp);
+#else
+    swapcontext((ucontext_t *)t->sp, &g_co.main_uc);
+#endif
+}
+
+/* ============================
+ * Pool de pilhas
+ * ============================ */
+static CoStackBase *stack_get(void) {
+    if (!g_co.free_list) {
+        size_t len = (size_t)CO_STACK_SIZE * CO_SLAB_STACKS;
+        char *slab = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (slab == MAP_FAILED) return NULL;
+        for (int i = CO_SLAB_STACKS - 1; i >= 0; --i) {
+            CoStackBase *b = (CoStackBase *)(slab + (size_t)i * CO_STACK_SIZE);
+            b->next_free = g_co.free_list;
+            g_co.free_list = b;
+        }
+        g_co.allocated += CO_SLAB_STACKS;
+    }
+    CoStackBase *b = g_co.free_list;
+    g_co.free_list = b->next_free;
+    b->canary = CO_CANARY;
+    g_co.in_use++;
+    return b;
+}
+
+static void stack_put(CoStackBase *b) {
+    if (!b) return;
+    b->next_free = g_co.free_list;
+    g_co.free_list = b;
+    g_co.in_use--;
+}
+
+void co_pool_stats(uint64_t *allocated, uint64_t *in_use) {
+    if (allocated) *allocated = g_co.allocated;
+    if (in_use)    *in_use    = g_co.in_use;
+}
+
+/* ============================
+ * Ciclo de vida
+ * ============================ */
+void co_init(CoTask *t, CoBehavior fn, void *arg) {
+    memset(t, 0, sizeof *t);
+    t->fn  = fn;
+    t->arg = arg;
+    t->op  = CO_OP_START;
+}
+
+static void co_entry(void) {
+    CoTask *t = g_co.cur;
+    t->fn(t, t->arg);
+    t->op = CO_OP_EXIT;
+    ctx_leave(t);
+    abort();   /* uma corrotina terminada nunca é retomada */
+}
+
+CoOp co_resume(System *S, Process *P, CoTask *t) {
+    if (t->op == CO_OP_EXIT) return CO_OP_EXIT;
+    if (t->op == CO_OP_START) {
+        t->stack = stack_get();
+        if (!t->stack) return t->op = CO_OP_EXIT;   /* sem memória: termina */
+        ctx_make(t);
+    }
+    t->S = S;
+    t->P = P;
+    g_co.cur = t;
+    ctx_enter(t);
+    g_co.cur = NULL;
+    if (t->op == CO_OP_EXIT) {
+        stack_put(t->stack);
+        t->stack = NULL;
+    }
+    return t->op;
+}
+
+void co_reset(CoTask *t) {
+    if (!t) return;
+    stack_put(t->stack);
+    t->stack    = NULL;
+    t->op       = CO_OP_START;
+    t->granted  = false;
+    t->sleeping = false;
+}
+
+/* ============================
+ * API do comportamento
+ * ============================ */
+void co_request(CoTask *t, const int req[MAX_R]) {
+    for (int j = 0; j < MAX_R; ++j) t->req[j] = req[j];
+    t->granted = false;
+    t->op = CO_OP_REQUEST;
+    ctx_leave(t);           /* volta quando o sim_run concedeu */
+}
+
+void co_release(CoTask *t, const int req[MAX_R]) {
+    for (int j = 0; j < MAX_R; ++j) t->req[j] = req[j];
+    t->op = CO_OP_RELEASE;
+    ctx_leave(t);
+}
+
+void co_compute(CoTask *t, uint64_t ticks) {
+    t->wake = ticks;        /* relativo; o sim_run converte */
+    t->op = CO_OP_COMPUTE;
+    ctx_leave(t);
+}
+
+/* ============================
+ * Timers (min-heap por wake)
+ * ============================ */
+static bool timer_less(const CoTimer *a, const CoTimer *b) {
+    if (a->wake != b->wake) return a->wake < b->wake;
+    return a->P->id < b->P->id;
+}
+
+void co_sleep(Process *P, uint64_t wake) {
+    CoTask *t = P->co;
+    if (g_co.heap_len == g_co.heap_cap) {
+        int cap = g_co.heap_cap ? 2 * g_co.heap_cap : 64;
+        CoTimer *h = realloc(g_co.heap, (size_t)cap * sizeof *h);
+        if (!h) { t->sleeping = false; return; }   /* sem timer: acorda já */
+        g_co.heap = h;
+        g_co.heap_cap = cap;
+    }
+    t->sleeping = true;
+    t->wake = wake;
+    CoTimer x = { wake, P };
+    int i = g_co.heap_len++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!timer_less(&x, &g_co.heap[parent])) break;
+        g_co.heap[i] = g_co.heap[parent];
+        i = parent;
+    }
+    g_co.heap[i] = x;
+}
+
+static CoTimer timer_pop(void) {
+    CoTimer top = g_co.heap[0];
+    CoTimer last = g_co.heap[--g_co.heap_len];
+    int i = 0;
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= g_co.heap_len) break;
+        if (c + 1 < g_co.heap_len && timer_less(&g_co.heap[c + 1], &g_co.heap[c])) c++;
+        if (!timer_less(&g_co.heap[c], &last)) break;
+        g_co.heap[i] = g_co.heap[c];
+        i = c;
+    }
+    if (g_co.heap_len > 0) g_co.heap[i] = last;
+    return top;
+}
+
+void co_wake_due(System *S) {
+    while (g_co.heap_len > 0 && g_co.heap[0].wake <= S->sim_clock) {
+        CoTimer x = timer_pop();
+        CoTask *t = x.P->co;
+        /* entrada velha: abortado (co_reset) ou dormiu de novo */
+        if (!t || !t->sleeping || t->wake != x.wake) continue;
+        t->sleeping = false;
+        x.P->state = P_READY;
+        sched_push_ready(S, x.P);
+        trace_state(S, x.P);
+    }
+    if (g_co.heap_len == 0) {
+        free(g_co.heap);
+        g_co.heap = NULL;
+        g_co.heap_cap = 0;
+    }
+}
+
+bool co_has_sleepers(void) {
+    return g_co.heap_len > 0;
+}
+
+uint64_t co_next_wake(void) {
+    return g_co.heap_len > 0 ? g_co.heap[0].wake : UINT64_MAX;
+}
@@ -3,42 +3,361 @@
  * Não modifica o estado do sistema.
  * --------------------------------------------------------------------- */
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 #include "detector.h"
+#include "simulator.h"
+#include "process.h"
+#include "timing.h"
+#include "flight.h"
+#include "trace.h"
+#include "scratch.h"
 
-static inline bool need_leq_work(const int need[MAX_R], const int work[MAX_R], int m) {
-    for (int j = 0; j < m; ++j) if (need[j] > work[j]) return false;
-    return true;
+/* Entrada da lista por recurso: processo i espera Need[i][j] > Work[j] */
+typedef struct NeedEntry {
+    int need;
+    int pid;
+} NeedEntry;
+
+static int cmp_need_entry(const void *a, const void *b) {
+    const NeedEntry *x = (const NeedEntry *)a, *y = (const NeedEntry *)b;
+    if (x->need != y->need) return (x->need < y->need) ? -1 : 1;
+    return (x->pid > y->pid) - (x->pid < y->pid);
 }
 
-bool detect_deadlock(const System *S) {
-    if (!S) return false;
+/*
+ * Redução do grafo com contadores:
+ * - pending[i] = nº de recursos j com Need[i][j] > Work[j];
+ * - por recurso j, lista dos processos bloqueados em j ordenada por Need;
+ * - quando Work[j] sobe, avança o cursor da lista j e só toca quem teve o
+ *   limiar cruzado; quem zera pending entra na worklist.
+ * Cada entrada é visitada uma vez: O(n·m) + ordenação O(n·m·log n).
+ * Colunas de instância única (UnitBits) entram por bits: o pending inicial
+ * é popcount(need & ~work), as listas dessas colunas não precisam de
+ * ordenação (limiar 1) e só os bits novos de work |= alloc são visitados.
+ * Sem memória para os buffers retorna -1: nunca um "sem deadlock" falso.
+ */
+static int detect_core(const System *S, bool waiting, DeadlockReport *out) {
+    if (out) out->count = 0;
+    if (!S) return 0;
 
-    int  m = S->m, n = S->n;
-    int  Work[MAX_R];
-    bool Finish[MAX_P];
+    int m = S->m, n = S->n;
+    const UnitBits *ub = S->bits.valid && S->bits.n_unit > 0 ? &S->bits : NULL;
+    int words = ub ? ub->words : 0;
+
+    /* Colunas contadas (todas, sem bitsets) */
+    int cols[MAX_R], mc = 0;
+    if (ub) {
+        mc = ub->n_counted;
+        memcpy(cols, ub->counted, (size_t)mc * sizeof *cols);
+    } else {
+        for (int j = 0; j < m; ++j) cols[mc++] = j;
+    }
 
-    for (int j = 0; j < m; ++j) Work[j] = S->Available[j];
+    int Work[MAX_R];
+    u64 WorkB[UB_WORDS] = {0};
+    int head[MAX_R + 1];     /* início da lista de cada coluna contada em 'ent' */
+    int cur[MAX_R];          /* cursor: próxima entrada ainda não satisfeita */
+    int uhead[MAX_R + 1];    /* idem para as colunas únicas em 'uent' (por j) */
 
+    size_t nm = (size_t)n * (size_t)mc;
+    char *buf = scratch_get(SCR_DETECT, nm * sizeof(NeedEntry) + nm * sizeof(int) +
+                           2 * (size_t)n * sizeof(int) + (size_t)n * (size_t)words * sizeof(u64));
+    if (!buf) return -1;
+    u64       *demb = (u64 *)buf;                buf += (size_t)n * (size_t)words * sizeof *demb;
+    NeedEntry *ent  = (NeedEntry *)buf;          buf += nm * sizeof *ent;
+    int       *dem  = (int *)buf;                buf += nm * sizeof *dem;
+    int       *pend = (int *)buf;                buf += (size_t)n * sizeof *pend;
+    int       *work = (int *)buf;                /* worklist (pilha) */
+    int       *uent = NULL;
+
+    for (int c = 0; c < mc; ++c) Work[c] = S->Available[cols[c]];
+    for (int w = 0; w < words; ++w) WorkB[w] = ub->avail[w];
+
+    /* Demanda de cada processo: Need (padrão) ou só o pedido corrente */
+    for (int i = 0; i < n; ++i) pend[i] = 0;
     for (int i = 0; i < n; ++i) {
-        bool zero = true;
-        for (int j = 0; j < m; ++j) if (S->procs[i].Need[j] != 0) { zero = false; break; }
-        Finish[i] = zero; /* quem não precisa de nada já é “finalizável” */
+        const Process *p = &S->procs[i];
+        int *row = dem + (size_t)i * (size_t)mc;
+        u64 *rowb = demb + (size_t)i * (size_t)words;
+        if (!waiting) {
+            for (int c = 0; c < mc; ++c) row[c] = p->Need[cols[c]];
+            for (int w = 0; w < words; ++w) rowb[w] = ub->need[i][w];
+            continue;
+        }
+        if (p->state != P_BLOCKED) {          /* não espera nada */
+            for (int c = 0; c < mc; ++c) row[c] = 0;
+            for (int w = 0; w < words; ++w) rowb[w] = 0;
+            continue;
+        }
+        int req[MAX_R] = {0};
+        (void)proc_peek_request(p, req);
+        for (int c = 0; c < mc; ++c) row[c] = req[cols[c]];
+        for (int w = 0; w < words; ++w) {
+            u64 bits = ub->unit[w], v = 0;
+            while (bits) {
+                int t = __builtin_ctzll(bits);
+                int r = req[w * 64 + t];
+                if (r > 1) pend[i]++;          /* acima da instância: nunca */
+                else if (r) v |= 1ull << t;
+                bits &= bits - 1;
+            }
+            rowb[w] = v;
+        }
+    }
+
+    /* Monta listas por recurso e contadores por processo */
+    int k = 0, top = 0;
+    for (int c = 0; c < mc; ++c) {
+        head[c] = k;
+        for (int i = 0; i < n; ++i) {
+            int need = dem[(size_t)i * (size_t)mc + (size_t)c];
+            if (need > Work[c]) {
+                ent[k].need = need;
+                ent[k].pid  = i;
+                ++k;
+                pend[i]++;
+            }
+        }
+        qsort(ent + head[c], (size_t)(k - head[c]), sizeof *ent, cmp_need_entry);
+        cur[c] = head[c];
     }
+    head[mc] = k;
 
-    bool progress = true;
-    while (progress) {
-        progress = false;
+    /* Colunas únicas: contagem por coluna dos bits faltando e preenchimento
+       (counting sort), proporcional aos bits, não a n·m */
+    if (words) {
+        memset(uhead, 0, (size_t)(m + 1) * sizeof *uhead);
+        for (int i = 0; i < n; ++i) {
+            const u64 *rowb = demb + (size_t)i * (size_t)words;
+            for (int w = 0; w < words; ++w) {
+                u64 miss = rowb[w] & ~WorkB[w];
+                pend[i] += __builtin_popcountll(miss);
+                while (miss) {
+                    uhead[w * 64 + __builtin_ctzll(miss) + 1]++;
+                    miss &= miss - 1;
+                }
+            }
+        }
+        for (int j = 0; j < m; ++j) uhead[j + 1] += uhead[j];
+        uent = scratch_get(SCR_DETECT_UNIT, (size_t)uhead[m] * sizeof *uent);
+        if (!uent) return -1;
         for (int i = 0; i < n; ++i) {
-            if (Finish[i]) continue;
-            if (need_leq_work(S->procs[i].Need, Work, m)) {
-                for (int j = 0; j < m; ++j) Work[j] += S->procs[i].Allocation[j];
-                Finish[i] = true;
-                progress = true;
+            const u64 *rowb = demb + (size_t)i * (size_t)words;
+            for (int w = 0; w < words; ++w) {
+                u64 miss = rowb[w] & ~WorkB[w];
+                while (miss) {
+                    uent[uhead[w * 64 + __builtin_ctzll(miss)]++] = i;
+                    miss &= miss - 1;
+                }
+            }
+        }
+        /* o preenchimento avançou cada início até o fim: desloca de volta */
+        for (int j = m; j > 0; --j) uhead[j] = uhead[j - 1];
+        uhead[0] = 0;
+    }
+
+    for (int i = 0; i < n; ++i) if (pend[i] == 0) work[top++] = i;
+
+    /* Worklist: finaliza e devolve Allocation, tocando só limiares cruzados */
+    int finished = 0;
+    while (top > 0) {
+        const Process *p = &S->procs[work[--top]];
+        pend[p->id] = -1;                 /* marca como finalizado */
+        ++finished;
+        for (int c = 0; c < mc; ++c) {
+            int j = cols[c];
+            if (p->Allocation[j] == 0) continue;
+            Work[c] += p->Allocation[j];
+            while (cur[c] < head[c + 1] && ent[cur[c]].need <= Work[c]) {
+                int q = ent[cur[c]++].pid;
+                if (--pend[q] == 0) work[top++] = q;
+            }
+        }
+        for (int w = 0; w < words; ++w) {
+            u64 fresh = ub->alloc[p->id][w] & ~WorkB[w];
+            WorkB[w] |= fresh;
+            while (fresh) {
+                int j = w * 64 + __builtin_ctzll(fresh);
+                for (int e = uhead[j]; e < uhead[j + 1]; ++e) {
+                    int q = uent[e];
+                    if (--pend[q] == 0) work[top++] = q;
+                }
+                fresh &= fresh - 1;
             }
         }
     }
 
-    /* deadlock se existir alguém não-finalizável */
-    for (int i = 0; i < n; ++i) if (!Finish[i]) return true;
-    return false;
+    int dead = n - finished;
+    if (out) {
+        for (int i = 0; i < n; ++i) if (pend[i] != -1) out->pids[out->count++] = i;
+    }
+
+    return dead;
+}
+
+int detect_deadlock_set(const System *S, DeadlockReport *out) {
+    return detect_core(S, false, out);
+}
+
+int detect_deadlock_waiting(const System *S, DeadlockReport *out) {
+    return detect_core(S, true, out);
+}
+
+bool detect_deadlock(const System *S) {
+    return detect_deadlock_set(S, NULL) != 0;   /* erro não afirma ausência */
+}
+
+/* ============================
+ * Agendamento (--detect)
+ * ============================ */
+
+static const char *const g_trigger_names[] = {
+    [DET_STALL]    = "stall",
+    [DET_EVERY_K]  = "every",
+    [DET_EVERY_T]  = "ticks",
+    [DET_BLOCKED]  = "blocked",
+    [DET_ADAPTIVE] = "adaptive",
+    [DET_NONE]     = "none",
+};
+
+const char *detect_trigger_str(DetectTrigger t) {
+    if ((int)t < 0 || (int)t >= ARRAY_LEN(g_trigger_names)) return "?";
+    return g_trigger_names[t];
+}
+
+bool detect_config_parse(const char *s, DetectConfig *out) {
+    if (!s || !out) return false;
+    DetectConfig c = { DET_STALL, 16, 0.5 };
+
+    const char *colon = strchr(s, ':');
+    size_t len = colon ? (size_t)(colon - s) : strlen(s);
+    int k = 0;
+    for (; k < ARRAY_LEN(g_trigger_names); ++k) {
+        if (strlen(g_trigger_names[k]) == len && strncmp(s, g_trigger_names[k], len) == 0) break;
+    }
+    if (k == ARRAY_LEN(g_trigger_names)) return false;
+    c.trigger = (DetectTrigger)k;
+
+    if (colon) {
+        char *end = NULL;
+        if (c.trigger == DET_BLOCKED) {
+            c.blocked_frac = strtod(colon + 1, &end);
+            if (c.blocked_frac <= 0.0 || c.blocked_frac > 1.0) return false;
+        } else if (c.trigger == DET_EVERY_K || c.trigger == DET_EVERY_T ||
+                   c.trigger == DET_ADAPTIVE) {
+            c.every = strtoull(colon + 1, &end, 0);
+            if (c.every == 0) return false;
+        } else {
+            return false;
+        }
+        if (!end || *end != '\0') return false;
+    } else if (c.trigger == DET_EVERY_K || c.trigger == DET_EVERY_T) {
+        return false;                       /* K/T obrigatórios */
+    }
+
+    *out = c;
+    return true;
+}
+
+void detector_begin(System *S) {
+    DetectState *st = &S->detect_st;
+    st->interval  = S->detect_cfg.every ? S->detect_cfg.every : 1;
+    if (S->detect_cfg.trigger == DET_ADAPTIVE) {
+        if (st->interval < DETECT_ADAPTIVE_MIN) st->interval = DETECT_ADAPTIVE_MIN;
+        if (st->interval > DETECT_ADAPTIVE_MAX) st->interval = DETECT_ADAPTIVE_MAX;
+    }
+    st->next_req  = S->metrics.total_requests + st->interval;
+    st->next_tick = S->sim_clock + st->interval;
+}
+
+/*
+ * Roda o detector e contabiliza. Deadlock "novo" = conjunto com algum
+ * processo ainda não reportado; a latência é medida do último bloqueio
+ * entre os membros (quando o ciclo fechou) até o tick atual.
+ * Retorna true se achou deadlock novo.
+ */
+static bool detector_run(System *S, bool waiting) {
+    DeadlockReport *rep = scratch_get(SCR_REPORT, sizeof *rep);   /* pids[MAX_P]: fora da pilha */
+    unsigned long long t0 = now_ns();
+    ub_ensure(S);
+    int dead = !rep ? -1 : waiting ? detect_deadlock_waiting(S, rep) : detect_deadlock_set(S, rep);
+    unsigned long long t1 = now_ns();
+    metrics_record_detector_call(&S->metrics, t1 - t0);
+    trace_host(TR_HOST_DETECT, t0, t1);
+    if (dead < 0) {                       /* não dá para afirmar nada: para */
+        S->fault = "detector sem memória para os buffers de trabalho";
+        return false;
+    }
+    if (dead == 0) return false;
+
+    bool fresh = false;
+    uint64_t formed = 0;
+    for (int k = 0; k < rep->count; ++k) {
+        Process *p = &S->procs[rep->pids[k]];
+        if (!p->in_deadlock) fresh = true;
+        p->in_deadlock = true;
+        if (p->blocked_since > formed) formed = p->blocked_since;
+    }
+    S->metrics.deadlocked_procs = (uint64_t)rep->count;
+    if (!fresh) return false;
+
+    uint64_t lat = S->sim_clock > formed ? S->sim_clock - formed : 0;
+    S->metrics.deadlocks_found += 1;
+    S->metrics.detector_hits += 1;
+    S->metrics.detect_latency_total += lat;
+    if (lat > S->metrics.detect_latency_max) S->metrics.detect_latency_max = lat;
+    if (S->metrics.time_to_first_deadlock == 0) {
+        S->metrics.time_to_first_deadlock = S->sim_clock;
+    }
+    flight_on_deadlock(S, rep);
+    return true;
+}
+
+void detector_on_tick(System *S) {
+    const DetectConfig *c = &S->detect_cfg;
+    DetectState *st = &S->detect_st;
+    int blocked = sched_blocked_count(&S->sched);
+    if (blocked == 0) return;           /* sem espera não há deadlock */
+
+    switch (c->trigger) {
+        case DET_EVERY_K:
+            if (S->metrics.total_requests < st->next_req) return;
+            (void)detector_run(S, true);
+            st->next_req = S->metrics.total_requests + st->interval;
+            return;
+        case DET_EVERY_T:
+            if (S->sim_clock < st->next_tick) return;
+            (void)detector_run(S, true);
+            st->next_tick = S->sim_clock + st->interval;
+            return;
+        case DET_BLOCKED: {
+            int active = S->n - S->n_finished;
+            if (active <= 0 || (double)blocked < c->blocked_frac * (double)active) return;
+            (void)detector_run(S, true);
+            return;
+        }
+        case DET_ADAPTIVE:
+            if (S->metrics.total_requests < st->next_req) return;
+            if (detector_run(S, true)) {
+                st->interval /= 2;             /* achou: aperta */
+                if (st->interval < DETECT_ADAPTIVE_MIN) st->interval = DETECT_ADAPTIVE_MIN;
+            } else {
+                st->interval *= 2;             /* vazio/repetido: recua */
+                if (st->interval > DETECT_ADAPTIVE_MAX) st->interval = DETECT_ADAPTIVE_MAX;
+            }
+            st->next_req = S->metrics.total_requests + st->interval;
+            return;
+        case DET_STALL:
+        case DET_NONE:
+        default:
+            return;
+    }
+}
+
+/* Travamento: todo processo vivo está bloqueado; usa Need como antes */
+void detector_on_stall(System *S) {
+    if (S->detect_cfg.trigger == DET_NONE) return;
+    if (sched_blocked_count(&S->sched) == 0) return;
+    (void)detector_run(S, false);
 }
@@ -1,72 +1,55 @@
 /* ---------------------------------------------------------------------
- * dispatcher.c — Decide concessão conforme o modo (OSTRICH ou BANKER)
- * Mede overhead do BANKER (ns) e atualiza métricas.
+ * dispatcher.c — Decide concessão conforme a política (BANKER, OSTRICH, ...)
+ * Atualiza métricas comuns; cada política mede o próprio overhead.
  * --------------------------------------------------------------------- */
-#ifndef _POSIX_C_SOURCE
-#define _POSIX_C_SOURCE 200809L
-#endif
-#include <time.h>
 #include "resources.h"
 #include "simulator.h"
 #include "process.h"
-#include "banker.h"
+#include "policy.h"
 #include "logger.h"
+#include "flight.h"
 
-static inline unsigned long long now_ns(void) {
-    struct timespec ts;
-#if defined(CLOCK_MONOTONIC_RAW)
-    /* Usa RAW quando disponível (Linux), mais estável contra NTP */
-    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
-#else
-    /* Fallback POSIX portátil */
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-#endif
-    return (unsigned long long)ts.tv_sec * 1000000000ull
-         + (unsigned long long)ts.tv_nsec;
-}
+typedef bool (*DecideFn)(System *S, Process *P, const int req[MAX_R]);
+typedef void (*BlockFn)(System *S, Process *P, const int req[MAX_R]);
 
-bool handle_request_current_mode(System *S, Process *P, const int req[MAX_R]) {
-    if (!S || !P || !req) return false;
-    S->metrics.total_requests++;
+/* Caminho comum a todas as políticas: contabiliza, delega a decisão e
+   registra o evento. Inline com decide/on_block constantes em cada
+   chamada de handle_request_current_mode: a decisão vira chamada direta. */
+static inline bool dispatch(System *S, Process *P, const int req[MAX_R],
+                            DecideFn decide, BlockFn on_block)
+{
+    metrics_record_request(&S->metrics);
 
-    /* ---------- BANKER ---------- */
-    if (S->mode == MODE_BANKER) {
-        /* pré-checagem: só mede safety se possível prosseguir */
-        for (int j = 0; j < S->m; ++j) {
-            int r = req[j];
-            if (r < 0 || r > P->Need[j] || r > S->Available[j]) {
-                S->metrics.blocks++;
-                logger_log_request(S, P, req, false);
-                return false;
-            }
+    if (P->waiting) P->retries++;
+    bool ok = decide(S, P, req);
+    if (ok) {
+        proc_end_wait(P, S->sim_clock);
+        metrics_record_grant(&S->metrics);
+        P->grants_since_start++;
+        if (P->restarted) {
+            P->restarted = false;
+            S->metrics.restarts++;
         }
-        unsigned long long t0 = now_ns();
-        bool ok = request_banker(S, P, req);
-        unsigned long long dt = now_ns() - t0;
-
-        S->metrics.banker_safety_calls++;
-        S->metrics.ns_in_safety_total += dt;
-        if (ok) S->metrics.grants++; else S->metrics.blocks++;
-        logger_log_request(S, P, req, ok);
-        return ok;
-    }
-
-    /* ---------- OSTRICH ---------- */
-    for (int j = 0; j < S->m; ++j) {
-        int r = req[j];
-        if (r < 0 || r > P->Need[j] || r > S->Available[j]) {
-            S->metrics.blocks++;
-            logger_log_request(S, P, req, false);
-            return false;
+    } else {
+        if (!P->waiting && P->state != P_READY) {    /* READY = abortado agora */
+            P->waiting = true;
+            P->blocked_since = S->sim_clock;
         }
+        metrics_record_block(&S->metrics);
+        if (on_block) on_block(S, P, req);
     }
-    for (int j = 0; j < S->m; ++j) {
-        int r = req[j];
-        S->Available[j]  -= r;
-        P->Allocation[j] += r;
-        P->Need[j]       -= r;
-    }
-    S->metrics.grants++;
-    logger_log_request(S, P, req, true);
-    return true;
-}
\ No newline at end of file
+    flight_record(S, P, req, ok);
+    logger_log_request(S, P, req, ok);
+    return ok;
+}
+
+/* BANKER e OSTRICH (sem on_block) têm cópia própria do caminho com a
+   decisão chamada direto; as demais, e envoltórios como o do check,
+   passam pela tabela de hooks. */
+bool handle_request_current_mode(System *S, Process *P, const int req[MAX_R]) {
+    if (!S || !P || !req) return false;
+    const Policy *pol = S->policy;
+    if (pol == &policy_banker)  return dispatch(S, P, req, banker_on_request, NULL);
+    if (pol == &policy_ostrich) return dispatch(S, P, req, ostrich_on_request, NULL);
+    return dispatch(S, P, req, pol->on_request, pol->on_block);
+}
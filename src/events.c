@@ -0,0 +1,314 @@
+/* ---------------------------------------------------------------------
+ * events.c — Motor de eventos discretos (calendário em heap binário)
+ * Ciclo de cada processo:
+ *   ARRIVAL → REQUEST → (concedido) HOLD_EXPIRE → REQUEST ... → RELEASE
+ *                     → (negado)   BLOCKED, repetido a cada liberação
+ * Liberações (fim de processo, aborto ou devolução parcial) varrem a
+ * fila de BLOCKED do escalonador; abortos feitos pela política voltam pela
+ * fila READY e recomeçam no instante seguinte. Eventos de um processo
+ * abortado ficam velhos (geração por pid) e são descartados no pop.
+ * --------------------------------------------------------------------- */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "events.h"
+#include "simulator.h"
+#include "process.h"
+#include "scheduler.h"
+#include "detector.h"
+#include "policy.h"
+#include "flight.h"
+#include "trace.h"
+
+/* ============================
+ * Distribuições e nomes
+ * ============================ */
+static const char *const g_engine_names[] = {
+    [ENGINE_TICK]  = "tick",
+    [ENGINE_EVENT] = "event",
+};
+
+const char *engine_str(SimEngine e) {
+    if ((int)e < 0 || (int)e >= ARRAY_LEN(g_engine_names)) return "?";
+    return g_engine_names[e];
+}
+
+bool engine_from_str(const char *s, SimEngine *out) {
+    if (!s || !out) return false;
+    for (int k = 0; k < ARRAY_LEN(g_engine_names); ++k) {
+        if (strcmp(s, g_engine_names[k]) == 0) { *out = (SimEngine)k; return true; }
+    }
+    return false;
+}
+
+bool dist_parse(const char *s, Dist *out) {
+    if (!s || !out) return false;
+    Dist d = { DIST_CONST, 0.0, 0.0 };
+    char *end = NULL;
+    if (strncmp(s, "const:", 6) == 0) {
+        d.kind = DIST_CONST;
+        d.a = strtod(s + 6, &end);
+    } else if (strncmp(s, "exp:", 4) == 0) {
+        d.kind = DIST_EXP;
+        d.a = strtod(s + 4, &end);
+    } else if (strncmp(s, "uniform:", 8) == 0) {
+        d.kind = DIST_UNIFORM;
+        d.a = strtod(s + 8, &end);
+        if (!end || *end != ':') return false;
+        d.b = strtod(end + 1, &end);
+        if (d.b < d.a) return false;
+    } else {
+        return false;
+    }
+    if (!end || *end != '\0' || d.a < 0.0) return false;
+    *out = d;
+    return true;
+}
+
+const char *dist_str(const Dist *d, char *buf, size_t len) {
+    switch (d->kind) {
+        case DIST_EXP:     snprintf(buf, len, "exp:%g", d->a); break;
+        case DIST_UNIFORM: snprintf(buf, len, "uniform:%g:%g", d->a, d->b); break;
+        case DIST_CONST:
+        default:           snprintf(buf, len, "const:%g", d->a); break;
+    }
+    return buf;
+}
+
+uint64_t dist_sample(const Dist *d, uint64_t *rng, uint64_t lo) {
+    double u = (double)(sched_rand_next(rng) >> 11) * 0x1.0p-53;   /* [0,1) */
+    double x;
+    switch (d->kind) {
+        case DIST_EXP:     x = -d->a * log(1.0 - u); break;
+        case DIST_UNIFORM: x = d->a + (d->b - d->a) * u; break;
+        case DIST_CONST:
+        default:           x = d->a; break;
+    }
+    uint64_t v = (uint64_t)llround(x);
+    return v < lo ? lo : v;
+}
+
+/* ============================
+ * Calendário (min-heap por t, seq)
+ * ============================ */
+typedef enum EvKind {
+    EV_ARRIVAL = 0,
+    EV_REQUEST,
+    EV_HOLD_EXPIRE,
+    EV_RELEASE
+} EvKind;
+
+typedef struct Event {
+    uint64_t t;
+    uint64_t seq;        /* desempate: ordem de agendamento */
+    int32_t  pid;
+    uint32_t gen;        /* geração do processo ao agendar  */
+    EvKind   kind;
+} Event;
+
+typedef struct EvEngine {
+    System   *S;
+    Event    *heap;
+    int       len, cap;
+    uint64_t  seq;
+    uint32_t *gen;       /* [n] incrementa a cada aborto */
+    uint64_t  rng;
+    bool      oom;
+} EvEngine;
+
+static bool ev_less(const Event *a, const Event *b) {
+    if (a->t != b->t) return a->t < b->t;
+    return a->seq < b->seq;
+}
+
+static void ev_push(EvEngine *E, EvKind kind, int pid, uint64_t t) {
+    if (E->len == E->cap) {
+        int cap = E->cap ? 2 * E->cap : 256;
+        Event *h = realloc(E->heap, (size_t)cap * sizeof *h);
+        if (!h) { E->oom = true; return; }
+        E->heap = h;
+        E->cap = cap;
+    }
+    Event x = { t, E->seq++, pid, E->gen[pid], kind };
+    int i = E->len++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!ev_less(&x, &E->heap[parent])) break;
+        E->heap[i] = E->heap[parent];
+        i = parent;
+    }
+    E->heap[i] = x;
+}
+
+static Event ev_pop(EvEngine *E) {
+    Event top = E->heap[0];
+    Event last = E->heap[--E->len];
+    int i = 0;
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= E->len) break;
+        if (c + 1 < E->len && ev_less(&E->heap[c + 1], &E->heap[c])) c++;
+        if (!ev_less(&E->heap[c], &last)) break;
+        E->heap[i] = E->heap[c];
+        i = c;
+    }
+    if (E->len > 0) E->heap[i] = last;
+    return top;
+}
+
+/* ============================
+ * Transições
+ * ============================ */
+
+/* Concedido: avança o roteiro e segura pelo tempo sorteado */
+static void ev_granted(EvEngine *E, Process *p) {
+    System *S = E->S;
+    proc_pop_request(p);
+    p->state = P_READY;
+    ev_push(E, EV_HOLD_EXPIRE, p->id,
+            S->sim_clock + dist_sample(&S->ev_cfg.hold, &E->rng, 1));
+}
+
+static void ev_request(EvEngine *E, Process *p) {
+    System *S = E->S;
+    int req[MAX_R] = {0};
+    if (!proc_peek_request(p, req)) {
+        ev_push(E, EV_RELEASE, p->id, S->sim_clock);
+        return;
+    }
+    p->state = P_RUNNING;
+    if (handle_request_current_mode(S, p, req)) {
+        ev_granted(E, p);
+    } else if (p->state == P_RUNNING) {
+        p->state = P_BLOCKED;
+        p->blocked_since = S->sim_clock;
+        sched_push_blocked(S, p);
+    }
+    /* senão: abortado pela política → volta por ev_drain_aborted */
+    trace_state(S, p);
+}
+
+/* Abortados (pela política) estão na fila READY: recomeçam em t+1 */
+static int ev_drain_aborted(EvEngine *E) {
+    System *S = E->S;
+    int k = 0, pid;
+    sched_begin_round(&S->sched);
+    while ((pid = sched_pop_ready(S)) >= 0) {
+        Process *p = &S->procs[pid];
+        if (p->state != P_READY) continue;
+        E->gen[pid]++;                      /* invalida HOLD_EXPIRE pendente */
+        ev_push(E, EV_REQUEST, pid, S->sim_clock + 1);
+        k++;
+    }
+    return k;
+}
+
+/* Recursos voltaram: repete o pedido corrente de cada BLOCKED, na ordem
+   do escalonador. Abortos devolvem recursos e disparam nova varredura. */
+static void ev_retry_blocked(EvEngine *E) {
+    System *S = E->S;
+    do {
+        int pid, req[MAX_R];
+        sched_begin_sweep(&S->sched);
+        while ((pid = sched_pop_sweep(S)) >= 0) {
+            Process *p = &S->procs[pid];
+            if (p->state != P_BLOCKED) continue;
+            if (!proc_peek_request(p, req)) {
+                p->state = P_READY;
+                ev_push(E, EV_RELEASE, pid, S->sim_clock);
+                continue;
+            }
+            p->state = P_RUNNING;
+            if (handle_request_current_mode(S, p, req)) {
+                ev_granted(E, p);
+            } else if (p->state == P_RUNNING) {
+                p->state = P_BLOCKED;
+                sched_push_blocked(S, p);
+            }
+            trace_state(S, p);
+        }
+    } while (ev_drain_aborted(E) > 0);
+}
+
+/* ============================
+ * Loop principal
+ * ============================ */
+void sim_run_events(System *S) {
+    if (!S) return;
+    void (*on_tick)(System *) = S->policy->on_tick;   /* hook lido uma vez */
+    EvEngine E = { .S = S, .rng = S->ev_cfg.seed };
+    E.gen = calloc((size_t)(S->n > 0 ? S->n : 1), sizeof *E.gen);
+    if (!E.gen) {
+        S->fault = "motor de eventos sem memória para as gerações";
+        return;
+    }
+
+    detector_begin(S);
+    sim_metrics_begin(S);
+    trace_available(S);
+
+    /* Chegadas: processo de renovação com a distribuição de entre-chegadas */
+    uint64_t t_arr = S->sim_clock;
+    for (int i = 0; i < S->n; ++i) {
+        Process *p = &S->procs[i];
+        if (p->state == P_FINISHED) continue;
+        t_arr += dist_sample(&S->ev_cfg.arrival, &E.rng, 0);
+        p->state = P_NEW;
+        ev_push(&E, EV_ARRIVAL, i, t_arr);
+    }
+    trace_states_all(S);
+
+    while (E.len > 0 && !E.oom && !S->fault) {
+        Event e = ev_pop(&E);
+        if (e.t > S->sim_clock) {
+            /* instante anterior assentado: gatilhos do detector */
+            sim_advance_clock(S, e.t);
+            if (on_tick) on_tick(S);
+        }
+        if (e.gen != E.gen[e.pid]) continue;      /* velho (abortado) */
+        S->metrics.events++;
+
+        Process *p = &S->procs[e.pid];
+        switch (e.kind) {
+            case EV_ARRIVAL:
+                p->state = P_READY;
+                p->arrival_clock = S->sim_clock;
+                ev_push(&E, EV_REQUEST, e.pid, S->sim_clock);
+                trace_state(S, p);
+                break;
+            case EV_REQUEST: {
+                if (p->state == P_FINISHED) break;
+                uint64_t rel0 = S->metrics.partial_releases;   /* devolução do ORDERED */
+                ev_request(&E, p);
+                if (ev_drain_aborted(&E) > 0 || S->metrics.partial_releases != rel0)
+                    ev_retry_blocked(&E);
+                break;
+            }
+            case EV_HOLD_EXPIRE:
+                if (p->state == P_FINISHED) break;
+                ev_push(&E, proc_script_done(p) ? EV_RELEASE : EV_REQUEST,
+                        e.pid, S->sim_clock);
+                break;
+            case EV_RELEASE:
+                if (p->state == P_FINISHED) break;
+                sim_finish_process(S, p);
+                p->finish_clock = S->sim_clock;
+                trace_state(S, p);
+                ev_retry_blocked(&E);
+                break;
+        }
+    }
+
+    /* Evento que não coube no calendário se perdeu: o resto da execução
+       não vale nada, então para com erro em vez de parecer um travamento */
+    if (E.oom) S->fault = "motor de eventos sem memória para o calendário";
+
+    /* Calendário vazio com processos em espera: travou */
+    if (!S->fault && sched_blocked_count(&S->sched) > 0 && S->policy->detect_on_stall)
+        detector_on_stall(S);
+    flight_on_run_end(S);
+
+    free(E.heap);
+    free(E.gen);
+}
@@ -0,0 +1,612 @@
+/* ---------------------------------------------------------------------
+ * explore.c — Busca exaustiva paralela com visitado por hash
+ * Passo de Pi = um sim_step_handle_process concedido: consome o pedido
+ * do topo do roteiro e, se era o último, termina devolvendo tudo. Cada
+ * worker faz DFS na própria deque (LIFO); quem fica sem trabalho rouba
+ * a entrada mais antiga de outro (subárvore maior). O visitado é uma
+ * tabela aberta de hashes de 64 bits inserida por CAS: colisões fariam
+ * um estado ser pulado (probabilidade ~ estados² / 2^64).
+ * Redução de ordem parcial por conjuntos teimosos (preservam todos os
+ * estados sem passo habilitado):
+ *  - um passo que nenhum outro processo pode desabilitar nem ser
+ *    desabilitado por ele é expandido sozinho (OSTRICH: colunas que
+ *    ninguém mais pede; BANKER: pedido nulo ou só término);
+ *  - senão, só os passos de um componente (partition.h): componentes
+ *    não compartilham recursos e o safety se decompõe por componente.
+ * --------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "explore.h"
+#include "policy.h"
+#include "timing.h"
+
+#define EXPLORE_WITNESS_MAX    1000   /* estados travados com caminho guardado */
+#define EXPLORE_WITNESS_STDOUT 5
+#define EX_FIN          0xFFu         /* cursor de processo terminado        */
+#define EX_NODES_CHUNK  4096
+#define EX_DEQUE_INIT   256
+
+/* Caminho até um estado: lista encadeada para trás (compartilhada) */
+typedef struct ExNode {
+    const struct ExNode *up;
+    int32_t pid;
+    int32_t depth;
+} ExNode;
+
+typedef struct ExChunk {
+    struct ExChunk *next;
+    int    used;
+    ExNode nodes[EX_NODES_CHUNK];
+} ExChunk;
+
+typedef struct ExItem {
+    uint8_t       cur[EXPLORE_MAX_P];   /* cursor por pid (EX_FIN = terminou) */
+    const ExNode *path;
+} ExItem;
+
+/* Deque por worker: dono empilha/desempilha no fim, ladrões tiram do
+   início. Contadores crescem sem volta; posição = contador & (cap-1). */
+typedef struct ExDeque {
+    pthread_mutex_t lock;
+    ExItem *buf;
+    size_t  cap, head, tail;
+} ExDeque;
+
+typedef struct ExShared {
+    const ExploreConfig *cfg;
+    ExploreResult *out;
+    int  n, m;
+    bool banker;
+    int  len[EXPLORE_MAX_P];
+    int  comp[EXPLORE_MAX_P];                     /* componente do Max          */
+    int32_t  max[EXPLORE_MAX_P][MAX_R];
+    int32_t  total[MAX_R];                        /* Available + alocado        */
+    int32_t  items[EXPLORE_MAX_P][MAX_REQS][MAX_R];
+    int32_t  pre[EXPLORE_MAX_P][MAX_REQS + 1][MAX_R];  /* Allocation no cursor c */
+    uint64_t qmask[EXPLORE_MAX_P][MAX_REQS + 1];  /* colunas > 0 do pedido c    */
+    uint64_t rmask[EXPLORE_MAX_P][MAX_REQS + 1];  /* idem, de c até o fim       */
+
+    _Atomic uint64_t *table;
+    uint64_t      tmask, limit;
+    atomic_ullong inserted;
+    atomic_bool   full;
+    atomic_long   pending;                        /* itens criados e não expandidos */
+
+    ExDeque        *dq;
+    int             threads;
+    pthread_mutex_t wlock;                        /* testemunhas                */
+} ExShared;
+
+typedef struct ExWorker {
+    ExShared *sh;
+    int       id;
+    ExChunk  *chunks;
+    uint64_t  transitions, pruned, deadlocked;
+    bool      all_finish;
+} ExWorker;
+
+static const int32_t g_zero_row[MAX_R];
+
+/* ============================
+ * Suporte
+ * ============================ */
+bool explore_supported(const System *S, char *why, size_t len) {
+    const char *msg = NULL;
+    if (S->policy != &policy_banker && S->policy != &policy_ostrich)
+        msg = "só as políticas banker e ostrich";
+    else if (S->n < 1 || S->n > EXPLORE_MAX_P || S->m < 1 || S->m > 64)
+        msg = "cenário grande demais";
+    for (int i = 0; i < S->n && !msg; ++i) {
+        if (S->procs[i].co) msg = "cenários com corrotinas não têm roteiro fixo";
+    }
+    if (msg && why) snprintf(why, len, "%s (n<=%d, m<=64)", msg, EXPLORE_MAX_P);
+    return msg == NULL;
+}
+
+/* ============================
+ * Visitado (hash de 64 bits)
+ * ============================ */
+static inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27; x *= 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+static uint64_t state_hash(const uint8_t cur[EXPLORE_MAX_P]) {
+    uint64_t w[EXPLORE_MAX_P / 8], h = 0x9e3779b97f4a7c15ull;
+    memcpy(w, cur, sizeof w);
+    for (size_t k = 0; k < sizeof w / sizeof w[0]; ++k) h = mix64(h ^ w[k]) + k;
+    return h ? h : 1;   /* 0 marca posição vazia */
+}
+
+/* 1 = novo, 0 = já visto, -1 = tabela cheia */
+static int table_insert(ExShared *sh, uint64_t h) {
+    if (atomic_load_explicit(&sh->full, memory_order_relaxed)) return -1;
+    uint64_t i = h & sh->tmask;
+    for (;;) {
+        uint64_t v = atomic_load_explicit(&sh->table[i], memory_order_relaxed);
+        if (v == h) return 0;
+        if (v == 0) {
+            if (atomic_compare_exchange_strong_explicit(&sh->table[i], &v, h,
+                                                        memory_order_relaxed, memory_order_relaxed)) {
+                if (atomic_fetch_add_explicit(&sh->inserted, 1, memory_order_relaxed) + 1 >= sh->limit)
+                    atomic_store_explicit(&sh->full, true, memory_order_relaxed);
+                return 1;
+            }
+            if (v == h) return 0;
+        }
+        i = (i + 1) & sh->tmask;
+    }
+}
+
+/* ============================
+ * Deques
+ * ============================ */
+static bool dq_init(ExDeque *d) {
+    d->buf = malloc(EX_DEQUE_INIT * sizeof *d->buf);
+    d->cap = EX_DEQUE_INIT;
+    d->head = d->tail = 0;
+    pthread_mutex_init(&d->lock, NULL);
+    return d->buf != NULL;
+}
+
+static void dq_free(ExDeque *d) {
+    free(d->buf);
+    pthread_mutex_destroy(&d->lock);
+}
+
+static bool dq_push(ExDeque *d, const ExItem *it) {
+    pthread_mutex_lock(&d->lock);
+    if (d->tail - d->head == d->cap) {
+        ExItem *nb = malloc(2 * d->cap * sizeof *nb);
+        if (!nb) {
+            pthread_mutex_unlock(&d->lock);
+            return false;
+        }
+        for (size_t k = d->head; k < d->tail; ++k) nb[k & (2 * d->cap - 1)] = d->buf[k & (d->cap - 1)];
+        free(d->buf);
+        d->buf = nb;
+        d->cap *= 2;
+    }
+    d->buf[d->tail++ & (d->cap - 1)] = *it;
+    pthread_mutex_unlock(&d->lock);
+    return true;
+}
+
+static bool dq_pop(ExDeque *d, ExItem *it) {
+    pthread_mutex_lock(&d->lock);
+    bool ok = d->tail > d->head;
+    if (ok) *it = d->buf[--d->tail & (d->cap - 1)];
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+static bool dq_steal(ExDeque *d, ExItem *it) {
+    pthread_mutex_lock(&d->lock);
+    bool ok = d->tail > d->head;
+    if (ok) *it = d->buf[d->head++ & (d->cap - 1)];
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+static const ExNode *node_new(ExWorker *w, const ExNode *up, int pid) {
+    if (!w->chunks || w->chunks->used == EX_NODES_CHUNK) {
+        ExChunk *c = malloc(sizeof *c);
+        if (!c) return NULL;
+        c->next = w->chunks;
+        c->used = 0;
+        w->chunks = c;
+    }
+    ExNode *nd = &w->chunks->nodes[w->chunks->used++];
+    nd->up = up;
+    nd->pid = pid;
+    nd->depth = up ? up->depth + 1 : 1;
+    return nd;
+}
+
+/* ============================
+ * Passos
+ * ============================ */
+
+/* Safety do BANKER com o pedido de Pi já aplicado (mesma redução do
+   safety_check, sobre os processos vivos) */
+static bool safe_after(const ExShared *sh, const uint8_t *cur, const int32_t *const alloc[],
+                       const int32_t avail[MAX_R], int i, const int32_t *req)
+{
+    int n = sh->n, m = sh->m;
+    int32_t work[MAX_R];
+    bool fin[EXPLORE_MAX_P];
+    int left = 0;
+    for (int j = 0; j < m; ++j) work[j] = avail[j] - req[j];
+    for (int q = 0; q < n; ++q) {
+        fin[q] = cur[q] == EX_FIN;
+        if (!fin[q]) left++;
+    }
+
+    bool progress = true;
+    while (progress && left > 0) {
+        progress = false;
+        for (int q = 0; q < n; ++q) {
+            if (fin[q]) continue;
+            int j = 0;
+            for (; j < m; ++j) {
+                int32_t got = alloc[q][j] + (q == i ? req[j] : 0);
+                if (sh->max[q][j] - got > work[j]) break;
+            }
+            if (j < m) continue;
+            for (j = 0; j < m; ++j) work[j] += alloc[q][j] + (q == i ? req[j] : 0);
+            fin[q] = true;
+            left--;
+            progress = true;
+        }
+    }
+    return left == 0;
+}
+
+/* Pi pode dar o próximo passo? (término puro ou pedido concedido) */
+static bool step_enabled(const ExShared *sh, const uint8_t *cur, const int32_t *const alloc[],
+                         const int32_t avail[MAX_R], int i)
+{
+    int c = cur[i];
+    if (c >= sh->len[i]) return true;
+    const int32_t *req = sh->items[i][c];
+    for (int j = 0; j < sh->m; ++j) {
+        int32_t r = req[j];
+        if (r < 0 || r > sh->max[i][j] - alloc[i][j] || r > avail[j]) return false;
+    }
+    return !sh->banker || safe_after(sh, cur, alloc, avail, i, req);
+}
+
+/* Conjunto teimoso entre os habilitados en[0..ne): escreve em pick */
+static int por_select(const ExShared *sh, const uint8_t *cur, const int *en, int ne, int *pick) {
+    /* 1) Passo independente de todos os outros vivos */
+    for (int e = 0; e < ne; ++e) {
+        int i = en[e];
+        uint64_t q = sh->qmask[i][cur[i] < sh->len[i] ? cur[i] : sh->len[i]];
+        bool alone = q == 0;
+        if (!alone && !sh->banker) {
+            alone = true;
+            for (int k = 0; k < sh->n && alone; ++k) {
+                if (k == i || cur[k] == EX_FIN) continue;
+                alone = (sh->rmask[k][cur[k]] & q) == 0;
+            }
+        }
+        if (alone) {
+            pick[0] = i;
+            return 1;
+        }
+    }
+
+    /* 2) Componente com menos passos habilitados */
+    int best = -1, best_cnt = ne + 1;
+    for (int e = 0; e < ne; ++e) {
+        int cnt = 0;
+        for (int f = 0; f < ne; ++f) cnt += sh->comp[en[f]] == sh->comp[en[e]];
+        if (cnt < best_cnt) { best_cnt = cnt; best = sh->comp[en[e]]; }
+    }
+    int np = 0;
+    for (int e = 0; e < ne; ++e) {
+        if (sh->comp[en[e]] == best) pick[np++] = en[e];
+    }
+    return np;
+}
+
+static void record_deadlock(ExWorker *w, const ExItem *it, uint64_t blocked) {
+    ExShared *sh = w->sh;
+    ExploreResult *out = sh->out;
+    w->deadlocked++;
+    pthread_mutex_lock(&sh->wlock);
+    if (out->n_witness < EXPLORE_WITNESS_MAX) {
+        int len = it->path ? it->path->depth : 0;
+        uint16_t *s = malloc((size_t)(len > 0 ? len : 1) * sizeof *s);
+        if (s) {
+            int k = len;
+            for (const ExNode *nd = it->path; nd; nd = nd->up) s[--k] = (uint16_t)nd->pid;
+            out->witness[out->n_witness++] = (ExploreWitness){ len, s, blocked };
+        }
+    }
+    pthread_mutex_unlock(&sh->wlock);
+}
+
+static void expand(ExWorker *w, const ExItem *it) {
+    ExShared *sh = w->sh;
+    int n = sh->n, m = sh->m;
+
+    const int32_t *alloc[EXPLORE_MAX_P];
+    int32_t avail[MAX_R];
+    for (int j = 0; j < m; ++j) avail[j] = sh->total[j];
+    for (int i = 0; i < n; ++i) {
+        alloc[i] = it->cur[i] == EX_FIN ? g_zero_row : sh->pre[i][it->cur[i]];
+        for (int j = 0; j < m; ++j) avail[j] -= alloc[i][j];
+    }
+
+    int en[EXPLORE_MAX_P], ne = 0;
+    bool live = false;
+    uint64_t blocked = 0;
+    for (int i = 0; i < n; ++i) {
+        if (it->cur[i] == EX_FIN) continue;
+        live = true;
+        if (step_enabled(sh, it->cur, alloc, avail, i)) en[ne++] = i;
+        else blocked |= 1ull << i;
+    }
+    if (ne == 0) {
+        if (live) record_deadlock(w, it, blocked);
+        else w->all_finish = true;
+        return;
+    }
+
+    int pick[EXPLORE_MAX_P], np = ne;
+    if (sh->cfg->por) np = por_select(sh, it->cur, en, ne, pick);
+    else memcpy(pick, en, (size_t)ne * sizeof *en);
+    w->pruned += (uint64_t)(ne - np);
+
+    for (int e = 0; e < np; ++e) {
+        int i = pick[e];
+        ExItem child = *it;
+        int c = it->cur[i] + 1;   /* último pedido (ou só término) → terminou */
+        child.cur[i] = c >= sh->len[i] ? EX_FIN : (uint8_t)c;
+        w->transitions++;
+
+        if (table_insert(sh, state_hash(child.cur)) <= 0) continue;
+        child.path = node_new(w, it->path, i);
+        if (!child.path) {
+            atomic_store_explicit(&sh->full, true, memory_order_relaxed);
+            continue;
+        }
+        atomic_fetch_add_explicit(&sh->pending, 1, memory_order_relaxed);
+        if (!dq_push(&sh->dq[w->id], &child)) {
+            atomic_store_explicit(&sh->full, true, memory_order_relaxed);
+            atomic_fetch_sub_explicit(&sh->pending, 1, memory_order_relaxed);
+        }
+    }
+}
+
+static bool steal(ExWorker *w, ExItem *it) {
+    ExShared *sh = w->sh;
+    for (int k = 1; k < sh->threads; ++k) {
+        if (dq_steal(&sh->dq[(w->id + k) % sh->threads], it)) return true;
+    }
+    return false;
+}
+
+static void *ex_worker_main(void *arg) {
+    ExWorker *w = arg;
+    ExShared *sh = w->sh;
+    ExItem it;
+    for (;;) {
+        if (dq_pop(&sh->dq[w->id], &it) || steal(w, &it)) {
+            expand(w, &it);
+            atomic_fetch_sub_explicit(&sh->pending, 1, memory_order_acq_rel);
+            continue;
+        }
+        if (atomic_load_explicit(&sh->pending, memory_order_acquire) == 0) break;
+        sched_yield();
+    }
+    return NULL;
+}
+
+/* ============================
+ * Driver
+ * ============================ */
+static void shared_load(ExShared *sh, const System *base, ExItem *root) {
+    int n = base->n, m = base->m;
+    sh->n = n;
+    sh->m = m;
+    sh->banker = base->policy == &policy_banker;
+    for (int j = 0; j < m; ++j) sh->total[j] = base->Available[j];
+
+    const Partition *pt = &base->part;     /* só leitura: find sem compressão */
+    memset(root, 0, sizeof *root);
+    for (int i = 0; i < n; ++i) {
+        const Process *p = &base->procs[i];
+        const ReqList *r = p->script;
+        int len = r ? r->len : 0, idx = r ? r->idx : 0;
+        sh->len[i] = len;
+        for (int j = 0; j < m; ++j) {
+            sh->max[i][j] = p->Max[j];
+            sh->pre[i][idx][j] = p->Allocation[j];
+            sh->total[j] += p->Allocation[j];
+        }
+        for (int s = idx; s < len; ++s) {
+            sh->qmask[i][s] = 0;
+            for (int j = 0; j < m; ++j) {
+                int32_t v = r->items[s][j];
+                sh->items[i][s][j] = v;
+                sh->pre[i][s + 1][j] = sh->pre[i][s][j] + v;
+                if (v > 0) sh->qmask[i][s] |= 1ull << j;
+            }
+        }
+        sh->qmask[i][len] = sh->rmask[i][len] = 0;
+        for (int s = len - 1; s >= idx; --s) sh->rmask[i][s] = sh->qmask[i][s] | sh->rmask[i][s + 1];
+
+        int anchor = pt->valid ? pt->anchor[i] : 0, c = anchor;
+        while (c >= 0 && pt->parent[c] != c) c = pt->parent[c];
+        sh->comp[i] = anchor >= 0 ? c : MAX_R + i;
+        root->cur[i] = p->state == P_FINISHED ? EX_FIN : (uint8_t)idx;
+    }
+}
+
+static int cmp_witness(const void *a, const void *b) {
+    const ExploreWitness *x = a, *y = b;
+    if (x->len != y->len) return x->len < y->len ? -1 : 1;
+    for (int k = 0; k < x->len; ++k) {
+        if (x->schedule[k] != y->schedule[k]) return x->schedule[k] < y->schedule[k] ? -1 : 1;
+    }
+    return 0;
+}
+
+bool explore_run(const System *base, const ExploreConfig *cfg, ExploreResult *out) {
+    if (!base || !cfg || !out || !explore_supported(base, NULL, 0)) return false;
+    memset(out, 0, sizeof *out);
+
+    int threads = cfg->threads;
+    if (threads <= 0) {
+        long c = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = c > 0 ? (int)c : 1;
+    }
+    int tlog = cfg->table_log2 > 0 ? cfg->table_log2 : EXPLORE_TABLE_LOG2;
+
+    ExShared  *sh   = calloc(1, sizeof *sh);
+    ExWorker  *ws   = calloc((size_t)threads, sizeof *ws);
+    pthread_t *tids = calloc((size_t)threads, sizeof *tids);
+    out->witness    = calloc(EXPLORE_WITNESS_MAX, sizeof *out->witness);
+    if (sh) {
+        sh->table = calloc((size_t)1 << tlog, sizeof *sh->table);
+        sh->dq    = calloc((size_t)threads, sizeof *sh->dq);
+    }
+    bool ok = sh && ws && tids && out->witness && sh->table && sh->dq;
+    int dqs = 0;
+    for (; ok && dqs < threads; ++dqs) ok = dq_init(&sh->dq[dqs]);
+    if (!ok) {
+        if (sh) {
+            for (int t = 0; t < dqs; ++t) dq_free(&sh->dq[t]);
+            free(sh->dq);
+            free((void *)sh->table);
+        }
+        free(sh); free(ws); free(tids);
+        explore_result_free(out);
+        return false;
+    }
+
+    sh->cfg = cfg;
+    sh->out = out;
+    sh->threads = threads;
+    sh->tmask = ((uint64_t)1 << tlog) - 1;
+    sh->limit = sh->tmask + 1 - ((sh->tmask + 1) >> 3);   /* 7/8 de ocupação */
+    atomic_init(&sh->inserted, 0);
+    atomic_init(&sh->full, false);
+    atomic_init(&sh->pending, 1);
+    pthread_mutex_init(&sh->wlock, NULL);
+
+    ExItem root;
+    shared_load(sh, base, &root);
+    table_insert(sh, state_hash(root.cur));
+    dq_push(&sh->dq[0], &root);
+
+    unsigned long long t0 = now_ns();
+    int started = 0;
+    for (int t = 0; t < threads; ++t) {
+        ws[t].sh = sh;
+        ws[t].id = t;
+        if (pthread_create(&tids[t], NULL, ex_worker_main, &ws[t]) != 0) break;
+        started++;
+    }
+    if (started == 0) ex_worker_main(&ws[0]);   /* sem threads: roda aqui */
+    for (int t = 0; t < started; ++t) pthread_join(tids[t], NULL);
+    out->wall_s = (double)(now_ns() - t0) / 1e9;
+
+    out->threads  = started > 0 ? started : 1;
+    out->por      = cfg->por;
+    out->states   = atomic_load(&sh->inserted);
+    out->complete = !atomic_load(&sh->full);
+    for (int t = 0; t < threads; ++t) {
+        out->transitions += ws[t].transitions;
+        out->por_pruned  += ws[t].pruned;
+        out->deadlocked  += ws[t].deadlocked;
+        out->all_finish  |= ws[t].all_finish;
+        for (ExChunk *c = ws[t].chunks, *nx; c; c = nx) {
+            nx = c->next;
+            free(c);
+        }
+    }
+    /* Ordem estável das testemunhas (a descoberta depende das threads) */
+    qsort(out->witness, (size_t)out->n_witness, sizeof *out->witness, cmp_witness);
+
+    for (int t = 0; t < threads; ++t) dq_free(&sh->dq[t]);
+    pthread_mutex_destroy(&sh->wlock);
+    free(sh->dq);
+    free((void *)sh->table);
+    free(sh);
+    free(ws);
+    free(tids);
+    return true;
+}
+
+void explore_result_free(ExploreResult *r) {
+    if (!r) return;
+    for (int k = 0; k < r->n_witness; ++k) free(r->witness[k].schedule);
+    free(r->witness);
+    r->witness = NULL;
+    r->n_witness = 0;
+}
+
+/* ============================
+ * Relatórios
+ * ============================ */
+static double states_per_s(const ExploreResult *r) {
+    return r->wall_s > 0.0 ? (double)r->states / r->wall_s : 0.0;
+}
+
+static void print_pid_list(FILE *f, uint64_t mask, const char *sep, const char *fmt) {
+    bool first = true;
+    for (int i = 0; i < 64; ++i) {
+        if (!(mask >> i & 1u)) continue;
+        fprintf(f, "%s", first ? "" : sep);
+        fprintf(f, fmt, i);
+        first = false;
+    }
+}
+
+void explore_print_summary(const ExploreResult *r, const char *mode, const char *scenario, FILE *f) {
+    fprintf(f, "mode=%s scenario=%s | explore threads=%d por=%s"
+               " | states=%llu transitions=%llu por_pruned=%llu"
+               " | deadlocked_states=%llu all_finish=%s complete=%s"
+               " | wall_s=%.3f states_per_s=%.0f\n",
+            mode, scenario, r->threads, r->por ? "on" : "off",
+            (unsigned long long)r->states, (unsigned long long)r->transitions,
+            (unsigned long long)r->por_pruned,
+            (unsigned long long)r->deadlocked, r->all_finish ? "yes" : "no",
+            r->complete ? "yes" : "no", r->wall_s, states_per_s(r));
+    for (int k = 0; k < r->n_witness && k < EXPLORE_WITNESS_STDOUT; ++k) {
+        const ExploreWitness *w = &r->witness[k];
+        fprintf(f, "  deadlock %d: blocked=", k + 1);
+        print_pid_list(f, w->blocked, ",", "P%d");
+        fprintf(f, " schedule=");
+        for (int s = 0; s < w->len; ++s) fprintf(f, "%sP%u", s ? " " : "", (unsigned)w->schedule[s]);
+        fputc('\n', f);
+    }
+    if ((uint64_t)r->n_witness < r->deadlocked || r->n_witness > EXPLORE_WITNESS_STDOUT)
+        fprintf(f, "  ... %llu estados travados no total\n", (unsigned long long)r->deadlocked);
+}
+
+bool explore_write_json(const ExploreResult *r, const char *mode, const char *scenario, const char *path) {
+    if (!r || !path) return false;
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f,
+        "{\n"
+        "  \"mode\": \"%s\",\n"
+        "  \"scenario\": \"%s\",\n"
+        "  \"threads\": %d,\n"
+        "  \"por\": %s,\n"
+        "  \"states\": %llu,\n"
+        "  \"transitions\": %llu,\n"
+        "  \"por_pruned\": %llu,\n"
+        "  \"deadlocked_states\": %llu,\n"
+        "  \"all_finish_reachable\": %s,\n"
+        "  \"complete\": %s,\n"
+        "  \"wall_s\": %.6f,\n"
+        "  \"states_per_s\": %.1f,\n"
+        "  \"witnesses\": [",
+        mode, scenario, r->threads, r->por ? "true" : "false",
+        (unsigned long long)r->states, (unsigned long long)r->transitions,
+        (unsigned long long)r->por_pruned, (unsigned long long)r->deadlocked,
+        r->all_finish ? "true" : "false", r->complete ? "true" : "false",
+        r->wall_s, states_per_s(r));
+    for (int k = 0; k < r->n_witness; ++k) {
+        const ExploreWitness *w = &r->witness[k];
+        fprintf(f, "%s\n    {\"blocked\": [", k ? "," : "");
+        print_pid_list(f, w->blocked, ", ", "%d");
+        fprintf(f, "], \"schedule\": [");
+        for (int s = 0; s < w->len; ++s) fprintf(f, "%s%u", s ? ", " : "", (unsigned)w->schedule[s]);
+        fprintf(f, "]}");
+    }
+    fprintf(f, "%s],\n  \"witnesses_truncated\": %s\n}\n", r->n_witness ? "\n  " : "",
+            (uint64_t)r->n_witness < r->deadlocked ? "true" : "false");
+    return fclose(f) == 0;
+}
@@ -0,0 +1,221 @@
+/* ---------------------------------------------------------------------
+ * flight.c — Gravador de voo (anel de eventos + dump com snapshot)
+ * Cada slot guarda clock/pid/granted e 2·m inteiros (req e delta de
+ * Available) num buffer contíguo alocado uma vez; registrar é O(m) sem
+ * alocação nem syscalls. Dumps são JSON, do evento mais antigo ao mais
+ * novo.
+ * --------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include "flight.h"
+#include "simulator.h"
+#include "process.h"
+#include "detector.h"
+#include "policy.h"
+
+typedef struct FlightEvent {
+    uint64_t clock;
+    int32_t  pid;
+    int32_t  granted;
+} FlightEvent;
+
+typedef struct FlightRing {
+    FlightEvent *ev;          /* [cap]                               */
+    int32_t     *cols;        /* [cap][2*m]: req | delta de Available */
+    uint32_t     cap;
+    uint64_t     total;       /* eventos registrados desde o open     */
+    int          m;
+    int          last_avail[MAX_R];
+    bool         have_last;
+    const char  *path;
+    unsigned     dumps;
+} FlightRing;
+
+static FlightRing g_fr;
+static volatile sig_atomic_t g_dump_requested = 0;
+
+static void on_sigusr1(int sig) {
+    (void)sig;
+    g_dump_requested = 1;
+}
+
+bool flight_open(const char *path, uint32_t capacity, int m) {
+    flight_close();
+    if (!path || capacity == 0 || m <= 0 || m > MAX_R) return false;
+    g_fr.ev   = calloc(capacity, sizeof *g_fr.ev);
+    g_fr.cols = calloc((size_t)capacity * 2u * (size_t)m, sizeof *g_fr.cols);
+    if (!g_fr.ev || !g_fr.cols) {
+        flight_close();
+        return false;
+    }
+    g_fr.cap   = capacity;
+    g_fr.m     = m;
+    g_fr.path  = path;
+    g_fr.total = 0;
+    g_fr.dumps = 0;
+    g_fr.have_last = false;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sa_handler = on_sigusr1;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR1, &sa, NULL);
+    return true;
+}
+
+void flight_close(void) {
+    free(g_fr.ev);
+    free(g_fr.cols);
+    memset(&g_fr, 0, sizeof g_fr);
+}
+
+bool flight_enabled(void) {
+    return g_fr.ev != NULL;
+}
+
+void flight_record(const System *S, const Process *P, const int req[MAX_R], bool granted) {
+    if (!g_fr.ev) return;
+    int m = g_fr.m;
+    uint32_t slot = (uint32_t)(g_fr.total % g_fr.cap);
+    FlightEvent *e = &g_fr.ev[slot];
+    int32_t *c = g_fr.cols + (size_t)slot * 2u * (size_t)m;
+
+    e->clock   = S->sim_clock;
+    e->pid     = P->id;
+    e->granted = granted ? 1 : 0;
+    for (int j = 0; j < m; ++j) {
+        int a = S->Available[j];
+        c[j]     = req[j];
+        c[m + j] = g_fr.have_last ? a - g_fr.last_avail[j] : 0;
+        g_fr.last_avail[j] = a;
+    }
+    g_fr.have_last = true;
+    g_fr.total++;
+
+    if (g_dump_requested) {
+        g_dump_requested = 0;
+        (void)flight_dump(S, "signal", NULL);
+    }
+}
+
+/* ============================
+ * Dump
+ * ============================ */
+
+static const char *pstate_str(PState s) {
+    switch (s) {
+        case P_NEW:      return "NEW";
+        case P_READY:    return "READY";
+        case P_RUNNING:  return "RUNNING";
+        case P_BLOCKED:  return "BLOCKED";
+        case P_FINISHED: return "FINISHED";
+        default:         return "?";
+    }
+}
+
+static void write_rc_row(FILE *f, const rc_t *v, int m) {
+    fputc('[', f);
+    for (int j = 0; j < m; ++j) fprintf(f, "%s%d", j ? ", " : "", (int)v[j]);
+    fputc(']', f);
+}
+
+static void write_int_row(FILE *f, const int *v, int m) {
+    fputc('[', f);
+    for (int j = 0; j < m; ++j) fprintf(f, "%s%d", j ? ", " : "", v[j]);
+    fputc(']', f);
+}
+
+static void write_snapshot(FILE *f, const System *S, const DeadlockReport *rep) {
+    int m = S->m;
+    fprintf(f, "  \"available\": ");
+    write_rc_row(f, S->Available, m);
+
+    fprintf(f, ",\n  \"deadlocked\": [");
+    for (int k = 0; rep && k < rep->count; ++k) fprintf(f, "%s%d", k ? ", " : "", rep->pids[k]);
+    fprintf(f, "],\n  \"processes\": [");
+
+    for (int i = 0; i < S->n; ++i) {
+        const Process *p = &S->procs[i];
+        fprintf(f, "%s\n    {\"pid\": %d, \"state\": \"%s\", \"max\": ",
+                i ? "," : "", p->id, pstate_str(p->state));
+        write_rc_row(f, p->Max, m);
+        fprintf(f, ", \"allocation\": ");
+        write_rc_row(f, p->Allocation, m);
+        fprintf(f, ", \"need\": ");
+        write_rc_row(f, p->Need, m);
+        int req[MAX_R] = {0};
+        bool has_next = proc_peek_request(p, req);
+        fprintf(f, ", \"script_idx\": %d, \"script_len\": %d, \"next_req\": ",
+                p->script ? p->script->idx : 0, p->script ? p->script->len : 0);
+        if (has_next) write_int_row(f, req, m);
+        else          fprintf(f, "null");
+        fprintf(f, ", \"aborts\": %u}", p->aborts);
+    }
+    fprintf(f, "\n  ]");
+}
+
+static void write_events(FILE *f) {
+    int m = g_fr.m;
+    uint64_t kept  = g_fr.total < g_fr.cap ? g_fr.total : g_fr.cap;
+    uint64_t first = g_fr.total - kept;
+
+    fprintf(f, ",\n  \"events_total\": %llu,\n  \"events\": [",
+            (unsigned long long)g_fr.total);
+    for (uint64_t k = first; k < g_fr.total; ++k) {
+        uint32_t slot = (uint32_t)(k % g_fr.cap);
+        const FlightEvent *e = &g_fr.ev[slot];
+        const int32_t *c = g_fr.cols + (size_t)slot * 2u * (size_t)m;
+        fprintf(f, "%s\n    {\"clock\": %llu, \"pid\": %d, \"granted\": %d, \"req\": ",
+                k > first ? "," : "", (unsigned long long)e->clock, e->pid, e->granted);
+        write_int_row(f, c, m);
+        fprintf(f, ", \"avail_delta\": ");
+        write_int_row(f, c + m, m);
+        fputc('}', f);
+    }
+    fprintf(f, "\n  ]");
+}
+
+bool flight_dump(const System *S, const char *reason, const DeadlockReport *rep) {
+    if (!g_fr.ev || !S) return false;
+
+    char path[4096];
+    if (g_fr.dumps == 0) snprintf(path, sizeof path, "%s", g_fr.path);
+    else                 snprintf(path, sizeof path, "%s.%u", g_fr.path, g_fr.dumps);
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    g_fr.dumps++;
+
+    fprintf(f,
+        "{\n"
+        "  \"reason\": \"%s\",\n"
+        "  \"mode\": \"%s\",\n"
+        "  \"clock\": %llu,\n"
+        "  \"n\": %d,\n"
+        "  \"m\": %d,\n",
+        reason ? reason : "manual",
+        S->policy ? S->policy->label : "?",
+        (unsigned long long)S->sim_clock, S->n, S->m);
+    write_snapshot(f, S, rep);
+    write_events(f);
+    fprintf(f, "\n}\n");
+    fclose(f);
+    return true;
+}
+
+void flight_on_deadlock(const System *S, const DeadlockReport *rep) {
+    if (!g_fr.ev) return;
+    (void)flight_dump(S, "deadlock", rep);
+}
+
+/* Fim travado (processos vivos) sem dump de deadlock já feito */
+void flight_on_run_end(const System *S) {
+    if (!g_fr.ev || !S) return;
+    if (g_dump_requested) {
+        g_dump_requested = 0;
+        (void)flight_dump(S, "signal", NULL);
+    }
+    if (S->n_finished >= S->n || g_fr.dumps > 0) return;
+    (void)flight_dump(S, "stalled", NULL);
+}
@@ -0,0 +1,148 @@
+/* ---------------------------------------------------------------------
+ * image.c — Compilação e carga por mmap de imagens de cenário
+ * Layout: [cabeçalho][pad][System][pad][ReqList × n_scripts], seções
+ * em múltiplos de IMAGE_ALIGN. No arquivo Process.script guarda o
+ * índice do roteiro + 1 (0 = sem roteiro); a carga troca por ponteiro.
+ * --------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "image.h"
+#include "policy.h"
+
+static uint64_t align_up(uint64_t x) {
+    return (x + IMAGE_ALIGN - 1) & ~(uint64_t)(IMAGE_ALIGN - 1);
+}
+
+static bool write_pad(FILE *f, uint64_t from, uint64_t to) {
+    static const char zeros[IMAGE_ALIGN];
+    while (from < to) {
+        size_t k = to - from < IMAGE_ALIGN ? (size_t)(to - from) : IMAGE_ALIGN;
+        if (fwrite(zeros, 1, k, f) != k) return false;
+        from += k;
+    }
+    return true;
+}
+
+/* ============================
+ * Compilação
+ * ============================ */
+bool image_write(const System *S, const char *scenario, const char *path) {
+    if (!S || !path) return false;
+
+    System *snap = malloc(sizeof *snap);
+    if (!snap) return false;
+    memcpy(snap, S, sizeof *snap);
+    snap->policy = NULL;
+    memset(&snap->sched, 0, sizeof snap->sched);   /* refeito na carga */
+
+    uint32_t ns = 0;
+    for (int i = 0; i < S->n; ++i) {
+        if (!S->procs[i].script) continue;
+        snap->procs[i].script = (ReqList *)(uintptr_t)(++ns);
+    }
+
+    ImageHeader h;
+    memset(&h, 0, sizeof h);
+    memcpy(h.magic, IMAGE_MAGIC, sizeof IMAGE_MAGIC);
+    h.version      = IMAGE_VERSION;
+    h.rc_bits      = RC_BITS;
+    h.max_p        = MAX_P;
+    h.max_r        = MAX_R;
+    h.max_reqs     = MAX_REQS;
+    h.n_scripts    = ns;
+    h.sys_size     = sizeof(System);
+    h.reqlist_size = sizeof(ReqList);
+    h.sys_off      = align_up(sizeof h);
+    h.scripts_off  = align_up(h.sys_off + h.sys_size);
+    h.file_size    = h.scripts_off + (uint64_t)ns * h.reqlist_size;
+    h.n            = S->n;
+    h.m            = S->m;
+    snprintf(h.scenario, sizeof h.scenario, "%s", scenario ? scenario : "?");
+
+    FILE *f = fopen(path, "wb");
+    if (!f) { free(snap); return false; }
+    bool ok = fwrite(&h, sizeof h, 1, f) == 1
+           && write_pad(f, sizeof h, h.sys_off)
+           && fwrite(snap, sizeof *snap, 1, f) == 1
+           && write_pad(f, h.sys_off + h.sys_size, h.scripts_off);
+    for (int i = 0; ok && i < S->n; ++i) {
+        const ReqList *rl = S->procs[i].script;
+        if (!rl) continue;
+        ReqList copy = *rl;
+        copy.idx = 0;
+        ok = fwrite(&copy, sizeof copy, 1, f) == 1;
+    }
+    free(snap);
+    if (fclose(f) != 0) ok = false;
+    return ok;
+}
+
+/* ============================
+ * Carga
+ * ============================ */
+static bool header_ok(const ImageHeader *h, uint64_t file_size) {
+    if (memcmp(h->magic, IMAGE_MAGIC, sizeof IMAGE_MAGIC) != 0) return false;
+    if (h->version != IMAGE_VERSION) return false;
+    if (h->rc_bits != RC_BITS || h->max_p != MAX_P || h->max_r != MAX_R ||
+        h->max_reqs != MAX_REQS) return false;
+    if (h->sys_size != sizeof(System) || h->reqlist_size != sizeof(ReqList)) return false;
+    if (h->sys_off % IMAGE_ALIGN || h->scripts_off % IMAGE_ALIGN) return false;
+    if (h->sys_off + h->sys_size > h->scripts_off) return false;
+    if (h->file_size != h->scripts_off + (uint64_t)h->n_scripts * h->reqlist_size) return false;
+    if (h->file_size > file_size) return false;
+    if (h->n < 1 || h->n > MAX_P || h->m < 1 || h->m > MAX_R) return false;
+    return true;
+}
+
+static void *map_section(int fd, uint64_t off, size_t len) {
+    if (len == 0) return NULL;
+    void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t)off);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+bool image_open(Image *img, const char *path, const struct Policy *policy) {
+    if (!img || !path) return false;
+    memset(img, 0, sizeof *img);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0
+           && pread(fd, &img->hdr, sizeof img->hdr, 0) == (ssize_t)sizeof img->hdr
+           && header_ok(&img->hdr, (uint64_t)st.st_size);
+    if (ok) {
+        img->sys_len     = (size_t)img->hdr.sys_size;
+        img->scripts_len = (size_t)(img->hdr.n_scripts * img->hdr.reqlist_size);
+        img->S       = map_section(fd, img->hdr.sys_off, img->sys_len);
+        img->scripts = map_section(fd, img->hdr.scripts_off, img->scripts_len);
+        ok = img->S && (img->scripts || img->hdr.n_scripts == 0);
+    }
+    close(fd);   /* o mapeamento sobrevive ao descritor */
+    if (!ok) { image_close(img); return false; }
+
+    System *S = img->S;
+    for (int i = 0; i < S->n; ++i) {
+        uintptr_t k = (uintptr_t)S->procs[i].script;
+        if (k > img->hdr.n_scripts) { image_close(img); return false; }
+        S->procs[i].script = k ? &img->scripts[k - 1] : NULL;
+    }
+    S->policy = policy;
+    S->detect_cfg = (DetectConfig){ DET_STALL, 16, 0.5 };
+    sched_init(&S->sched, SK_INDEX, 0);
+
+    if (!sys_invariants_ok(S)) { image_close(img); return false; }
+    return true;
+}
+
+void image_close(Image *img) {
+    if (!img) return;
+    if (img->S)       munmap(img->S, img->sys_len);
+    if (img->scripts) munmap(img->scripts, img->scripts_len);
+    img->S = NULL;
+    img->scripts = NULL;
+}
@@ -0,0 +1,287 @@
+/* ---------------------------------------------------------------------
+ * loadgen.c — Gerador de carga local para o --serve
+ * Cada cliente é uma conexão com um pedido em voo (laço fechado):
+ * registra um processo, pede fatias aleatórias da demanda até zerar Need
+ * (ou devolve tudo ao ser negado segurando algo), termina e recomeça.
+ * Só os pedidos Q contam como decisões; a latência é ida-e-volta.
+ * --------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/resource.h>
+#include "server.h"
+#include "scheduler.h"
+#include "timing.h"
+#include "metrics.h"
+
+typedef enum LGStep { LG_REG, LG_REQ, LG_FIN, LG_PARKED, LG_DONE } LGStep;
+
+typedef struct LGClient {
+    int      fd;
+    LGStep   step;
+    int      pid;
+    int      held[MAX_R];
+    int      want[MAX_R];        /* pedido em voo */
+    uint64_t t_sent;
+    size_t   in_len;
+    char     in[256];
+} LGClient;
+
+typedef struct LoadGen {
+    const LoadGenConfig *cfg;
+    uint64_t  rng;
+    uint64_t  issued, answered;
+    uint64_t  grants, denies, aborts, errors;
+    uint64_t *lat;               /* [ops] ns por decisão */
+    struct LGClient **parked;    /* sem pid livre: esperam alguém terminar */
+    int       n_parked;
+} LoadGen;
+
+static bool send_line(LGClient *c, const char *buf, int len) {
+    int off = 0;
+    while (off < len) {
+        ssize_t w = write(c->fd, buf + off, (size_t)(len - off));
+        if (w > 0) { off += (int)w; continue; }
+        if (w < 0 && errno == EINTR) continue;
+        return false;
+    }
+    return true;
+}
+
+static bool send_register(LoadGen *lg, LGClient *c) {
+    char buf[512];
+    int k = snprintf(buf, sizeof buf, "P");
+    for (int j = 0; j < lg->cfg->m; ++j) k += snprintf(buf + k, sizeof buf - (size_t)k, " %d", lg->cfg->max_claim);
+    buf[k++] = '\n';
+    memset(c->held, 0, sizeof c->held);
+    c->step = LG_REG;
+    return send_line(c, buf, k);
+}
+
+static bool send_finish(LGClient *c) {
+    char buf[32];
+    int k = snprintf(buf, sizeof buf, "F %d\n", c->pid);
+    c->step = LG_FIN;
+    return send_line(c, buf, k);
+}
+
+/* Pedido aleatório dentro do que falta (pelo menos uma unidade) */
+static bool send_request(LoadGen *lg, LGClient *c) {
+    if (lg->issued >= lg->cfg->ops) { c->step = LG_DONE; return true; }
+    int m = lg->cfg->m;
+    int any = -1;
+    for (int j = 0; j < m; ++j) {
+        int rest = lg->cfg->max_claim - c->held[j];
+        int cap = rest < 2 ? rest : 2;
+        c->want[j] = cap > 0 ? (int)(sched_rand_next(&lg->rng) % (uint64_t)(cap + 1)) : 0;
+        if (c->want[j] > 0) any = j;
+        else if (rest > 0 && any < 0) any = -2 - j;   /* lembra um j com sobra */
+    }
+    if (any == -1) return send_finish(c);           /* nada falta: termina */
+    if (any < -1) c->want[-2 - any] = 1;
+
+    char buf[512];
+    int k = snprintf(buf, sizeof buf, "Q %d", c->pid);
+    for (int j = 0; j < m; ++j) k += snprintf(buf + k, sizeof buf - (size_t)k, " %d", c->want[j]);
+    buf[k++] = '\n';
+    c->step = LG_REQ;
+    lg->issued++;
+    c->t_sent = now_ns();
+    return send_line(c, buf, k);
+}
+
+static bool holds_any(const LGClient *c, int m) {
+    for (int j = 0; j < m; ++j) if (c->held[j]) return true;
+    return false;
+}
+
+/* Reage a uma linha de resposta; false = cliente encerra */
+static bool on_reply(LoadGen *lg, LGClient *c, const char *line) {
+    int m = lg->cfg->m;
+    switch (c->step) {
+        case LG_REG:
+            if (line[0] == 'P') {
+                c->pid = atoi(line + 1);
+                return send_request(lg, c);
+            }
+            c->step = LG_PARKED;                        /* E full: espera um F */
+            lg->parked[lg->n_parked++] = c;
+            return true;
+        case LG_REQ: {
+            lg->lat[lg->answered++] = now_ns() - c->t_sent;
+            if (line[0] == 'G') {
+                lg->grants++;
+                for (int j = 0; j < m; ++j) c->held[j] += c->want[j];
+                return send_request(lg, c);
+            }
+            if (line[0] == 'X') {
+                lg->aborts++;
+                memset(c->held, 0, sizeof c->held);
+                return send_request(lg, c);
+            }
+            if (line[0] == 'D') {
+                lg->denies++;
+                if (holds_any(c, m)) return send_finish(c);  /* devolve e recomeça */
+                return send_request(lg, c);
+            }
+            lg->errors++;
+            return send_finish(c);
+        }
+        case LG_FIN:
+            if (lg->issued >= lg->cfg->ops) { c->step = LG_DONE; return true; }
+            if (lg->n_parked > 0) {                     /* pid liberado: acorda um */
+                LGClient *w = lg->parked[--lg->n_parked];
+                if (!send_register(lg, w)) w->step = LG_DONE;
+            }
+            return send_register(lg, c);
+        case LG_DONE:
+        default:
+            return true;
+    }
+}
+
+static int connect_unix(const char *path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof addr.sun_path) { close(fd); return -1; }
+    strcpy(addr.sun_path, path);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof addr) < 0) { close(fd); return -1; }
+    return fd;
+}
+
+static void write_report(const LoadGen *lg, int clients, double wall, FILE *f, bool json) {
+    uint64_t k = lg->answered;
+    const uint64_t *v = lg->lat;
+    double rate = wall > 0.0 ? (double)k / wall : 0.0;
+    if (json) {
+        fprintf(f,
+            "{\n"
+            "  \"clients\": %d,\n"
+            "  \"decisions\": %llu,\n"
+            "  \"grants\": %llu,\n"
+            "  \"denies\": %llu,\n"
+            "  \"aborts\": %llu,\n"
+            "  \"errors\": %llu,\n"
+            "  \"wall_s\": %.6f,\n"
+            "  \"decisions_per_s\": %.1f,\n"
+            "  \"latency_ns\": {\"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu}\n"
+            "}\n",
+            clients, (unsigned long long)k,
+            (unsigned long long)lg->grants, (unsigned long long)lg->denies,
+            (unsigned long long)lg->aborts, (unsigned long long)lg->errors,
+            wall, rate,
+            (unsigned long long)metrics_pct(v, k, 50),
+            (unsigned long long)metrics_pct(v, k, 90),
+            (unsigned long long)metrics_pct(v, k, 99),
+            (unsigned long long)metrics_pct(v, k, 99.9),
+            (unsigned long long)(k ? v[k - 1] : 0));
+        return;
+    }
+    fprintf(f, "loadgen clients=%d decisions=%llu grants=%llu denies=%llu aborts=%llu"
+               " | wall_s=%.3f decisions_per_s=%.1f"
+               " | lat_ns p50=%llu p90=%llu p99=%llu p999=%llu max=%llu\n",
+            clients, (unsigned long long)k,
+            (unsigned long long)lg->grants, (unsigned long long)lg->denies,
+            (unsigned long long)lg->aborts, wall, rate,
+            (unsigned long long)metrics_pct(v, k, 50),
+            (unsigned long long)metrics_pct(v, k, 90),
+            (unsigned long long)metrics_pct(v, k, 99),
+            (unsigned long long)metrics_pct(v, k, 99.9),
+            (unsigned long long)(k ? v[k - 1] : 0));
+}
+
+int loadgen_run(const LoadGenConfig *cfg) {
+    if (!cfg || !cfg->path || cfg->clients <= 0 || cfg->ops == 0 ||
+        cfg->m < 1 || cfg->m > MAX_R || cfg->max_claim < 1) return 2;
+
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        (void)setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    LoadGen lg;
+    memset(&lg, 0, sizeof lg);
+    lg.cfg = cfg;
+    lg.rng = cfg->seed;
+    lg.lat = malloc(cfg->ops * sizeof *lg.lat);
+    lg.parked = calloc((size_t)cfg->clients, sizeof *lg.parked);
+    LGClient *cl = calloc((size_t)cfg->clients, sizeof *cl);
+    struct pollfd *pfd = calloc((size_t)cfg->clients, sizeof *pfd);
+    if (!lg.lat || !lg.parked || !cl || !pfd) {
+        free(lg.lat); free(lg.parked); free(cl); free(pfd);
+        return 1;
+    }
+
+    int n = 0;
+    for (; n < cfg->clients; ++n) {
+        cl[n].fd = connect_unix(cfg->path);
+        if (cl[n].fd < 0) {
+            fprintf(stderr, "[loadgen] conexão %d falhou: %s\n", n, strerror(errno));
+            break;
+        }
+        pfd[n].fd = cl[n].fd;
+        pfd[n].events = POLLIN;
+    }
+    if (n == 0) { free(lg.lat); free(lg.parked); free(cl); free(pfd); return 1; }
+
+    unsigned long long t0 = now_ns();
+    for (int i = 0; i < n; ++i) {
+        if (!send_register(&lg, &cl[i])) cl[i].step = LG_DONE;
+    }
+
+    int live = n;
+    while (live > 0) {
+        if (poll(pfd, (nfds_t)n, 1000) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        live = 0;
+        for (int i = 0; i < n; ++i) {
+            LGClient *c = &cl[i];
+            if (c->step == LG_DONE) { pfd[i].fd = -1; continue; }
+            if (c->step != LG_PARKED) live++;
+            if (!(pfd[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            ssize_t r = read(c->fd, c->in + c->in_len, sizeof c->in - c->in_len - 1);
+            if (r <= 0) { c->step = LG_DONE; continue; }
+            c->in_len += (size_t)r;
+            size_t start = 0;
+            for (size_t k = 0; k < c->in_len; ++k) {
+                if (c->in[k] != '\n') continue;
+                c->in[k] = '\0';
+                if (!on_reply(&lg, c, c->in + start)) c->step = LG_DONE;
+                start = k + 1;
+            }
+            memmove(c->in, c->in + start, c->in_len - start);
+            c->in_len -= start;
+        }
+    }
+    double wall = (double)(now_ns() - t0) / 1e9;
+
+    for (int i = 0; i < n; ++i) close(cl[i].fd);
+    qsort(lg.lat, lg.answered, sizeof *lg.lat, metrics_cmp_u64);
+    write_report(&lg, n, wall, stdout, false);
+    if (cfg->json_path) {
+        FILE *f = fopen(cfg->json_path, "w");
+        if (f) {
+            write_report(&lg, n, wall, f, true);
+            fclose(f);
+        } else {
+            fprintf(stderr, "Falha ao escrever JSON: %s\n", cfg->json_path);
+        }
+    }
+
+    free(lg.lat);
+    free(lg.parked);
+    free(cl);
+    free(pfd);
+    return 0;
+}
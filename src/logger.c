@@ -1,25 +1,57 @@
 /* ---------------------------------------------------------------------
- * logger.c — CSV de eventos + export de métricas em JSON
+ * logger.c — Log de eventos (CSV ou binário) + export de métricas em JSON
+ * O binário não tem flush por evento: registros de tamanho fixo vão pelo
+ * buffer do stdio e o header é gravado no 1º evento (quando o modo é
+ * conhecido) ou no fechamento.
  * --------------------------------------------------------------------- */
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "logger.h"
+#include "policy.h"
+#include "timing.h"
+#include "trace.h"
 
 static FILE *g_csv = NULL;
 static int   g_m   = 0;
+static bool  g_bin = false;
+static bool  g_bin_header = false;     /* header binário já gravado */
 
-static const char* mode_str(Mode m) {
-    return (m == MODE_BANKER) ? "BANKER" : "OSTRICH";
+static const char* mode_str(const System *S) {
+    return S->policy ? S->policy->label : "?";
+}
+
+static bool ends_with(const char *s, const char *suf) {
+    size_t a = strlen(s), b = strlen(suf);
+    return a >= b && strcmp(s + a - b, suf) == 0;
+}
+
+static void bin_write_header(const char *mode) {
+    LogBinHeader h;
+    memset(&h, 0, sizeof h);
+    memcpy(h.magic, LOG_BIN_MAGIC, sizeof h.magic);
+    h.version = LOG_BIN_VERSION;
+    h.m = g_m;
+    snprintf(h.mode, sizeof h.mode, "%s", mode);
+    fwrite(&h, sizeof h, 1, g_csv);
+    g_bin_header = true;
 }
 
 bool logger_open_csv(const char *path, int m) {
     if (!path) return false;
-    g_csv = fopen(path, "w");
+    g_bin = ends_with(path, ".bin");
+    g_csv = fopen(path, g_bin ? "wb" : "w");
     if (!g_csv) return false;
     if (m < 0) m = 0;
     if (m > MAX_R) m = MAX_R;
     g_m = m;
 
+    if (g_bin) {
+        g_bin_header = false;
+        setvbuf(g_csv, NULL, _IOFBF, 1 << 20);
+        return true;
+    }
+
     /* header */
     fprintf(g_csv, "clock,pid,mode,granted");
     for (int j = 0; j < g_m; ++j) fprintf(g_csv, ",req%d", j);
@@ -33,30 +65,75 @@ void logger_log_request(const System *S, const Process *P,
                         const int req[MAX_R], bool granted)
 {
     if (!g_csv || !S || !P || !req) return;
+    if (g_bin) {
+        if (!g_bin_header) bin_write_header(mode_str(S));
+        int32_t rec[4 + 2 * MAX_R];
+        uint64_t clock = S->sim_clock;
+        memcpy(rec, &clock, sizeof clock);
+        rec[2] = P->id;
+        rec[3] = granted ? 1 : 0;
+        for (int j = 0; j < g_m; ++j) {
+            rec[4 + j] = req[j];
+            rec[4 + g_m + j] = S->Available[j];
+        }
+        fwrite(rec, LOG_BIN_RECORD(g_m), 1, g_csv);
+        return;
+    }
     fprintf(g_csv, "%llu,%d,%s,%d",
-            (unsigned long long)S->sim_clock, P->id, mode_str(S->mode),
+            (unsigned long long)S->sim_clock, P->id, mode_str(S),
             granted ? 1 : 0);
 
     for (int j = 0; j < g_m; ++j) fprintf(g_csv, ",%d", req[j]);
     for (int j = 0; j < g_m; ++j) fprintf(g_csv, ",%d", S->Available[j]);
     fputc('\n', g_csv);
     /* flush leve para não perder dados em testes curtos */
+    unsigned long long t0 = now_ns();
     fflush(g_csv);
+    trace_host(TR_HOST_LOG_FLUSH, t0, now_ns());
 }
 
 void logger_close_csv(void) {
     if (g_csv) {
+        if (g_bin && !g_bin_header) bin_write_header("?");
         fclose(g_csv);
         g_csv = NULL;
         g_m = 0;
     }
 }
 
+/* ",\n  \"nome\": {mean, p50, p99, max}" (ver sim_proc_dist) */
+static void write_proc_dist(const System *S, FILE *f, const char *name, ProcStat k) {
+    ProcDist d;
+    sim_proc_dist(S, k, &d);
+    fprintf(f, ",\n  \"%s\": {\"count\": %d, \"mean\": %.3f, \"p50\": %llu,"
+               " \"p99\": %llu, \"max\": %llu}",
+            name, d.count, d.mean, (unsigned long long)d.p50,
+            (unsigned long long)d.p99, (unsigned long long)d.max);
+}
+
+/* ",\n  \"resources\": [...]": unidades, unidade·ticks ocupados e fração */
+static void write_utilization(const System *S, FILE *f) {
+    fprintf(f, ",\n  \"resources\": [");
+    for (int j = 0; j < S->m; ++j) {
+        uint64_t units = S->metrics.res_units[j], busy = S->metrics.res_busy[j];
+        double cap = (double)units * (double)S->sim_clock;
+        fprintf(f, "%s\n    {\"id\": %d, \"units\": %llu, \"busy\": %llu, \"utilization\": %.4f}",
+                j ? "," : "", j, (unsigned long long)units, (unsigned long long)busy,
+                cap > 0.0 ? (double)busy / cap : 0.0);
+    }
+    fprintf(f, "\n  ]");
+}
+
 bool metrics_write_json(const System *S, const char *path) {
     if (!S || !path) return false;
     FILE *f = fopen(path, "w");
     if (!f) return false;
 
+    double   tat_mean;
+    uint64_t tat_p99;
+    sim_turnaround_stats(S, &tat_mean, &tat_p99);
+    char arr[48], hold[48];
+
     fprintf(f,
         "{\n"
         "  \"mode\": \"%s\",\n"
@@ -65,21 +142,50 @@ bool metrics_write_json(const System *S, const char *path) {
         "  \"total_requests\": %llu,\n"
         "  \"grants\": %llu,\n"
         "  \"blocks\": %llu,\n"
-        "  \"banker_safety_calls\": %llu,\n"
-        "  \"ns_in_safety_total\": %llu,\n"
-        "  \"deadlocks_found\": %llu,\n"
-        "  \"time_to_first_deadlock\": %llu\n"
-        "}\n",
-        (S->mode == MODE_BANKER) ? "BANKER" : "OSTRICH",
+        "  \"aborts\": %llu,\n"
+        "  \"restarts\": %llu,\n"
+        "  \"wasted_grants\": %llu,\n"
+        "  \"partial_releases\": %llu,\n"
+        "  \"scheduler\": \"%s\",\n"
+        "  \"seed\": %llu,\n"
+        "  \"makespan\": %llu,\n"
+        "  \"turnaround_mean\": %.3f,\n"
+        "  \"turnaround_p99\": %llu,\n"
+        "  \"blocks_per_grant\": %.4f,\n"
+        "  \"engine\": \"%s\",\n"
+        "  \"arrival\": \"%s\",\n"
+        "  \"hold\": \"%s\",\n"
+        "  \"events\": %llu,\n"
+        "  \"throughput\": %.6f",
+        mode_str(S),
         S->n, S->m,
         (unsigned long long)S->metrics.total_requests,
         (unsigned long long)S->metrics.grants,
         (unsigned long long)S->metrics.blocks,
-        (unsigned long long)S->metrics.banker_safety_calls,
-        (unsigned long long)S->metrics.ns_in_safety_total,
-        (unsigned long long)S->metrics.deadlocks_found,
-        (unsigned long long)S->metrics.time_to_first_deadlock
+        (unsigned long long)S->metrics.aborts,
+        (unsigned long long)S->metrics.restarts,
+        (unsigned long long)S->metrics.wasted_grants,
+        (unsigned long long)S->metrics.partial_releases,
+        sched_kind_str(S->sched.kind),
+        (unsigned long long)S->sched.seed,
+        (unsigned long long)S->sim_clock,
+        tat_mean,
+        (unsigned long long)tat_p99,
+        S->metrics.grants ? (double)S->metrics.blocks / (double)S->metrics.grants : 0.0,
+        engine_str(S->ev_cfg.engine),
+        dist_str(&S->ev_cfg.arrival, arr, sizeof arr),
+        dist_str(&S->ev_cfg.hold, hold, sizeof hold),
+        (unsigned long long)S->metrics.events,
+        S->sim_clock ? (double)S->n_finished / (double)S->sim_clock : 0.0
     );
+    write_proc_dist(S, f, "wait_ticks", PS_WAIT);
+    write_proc_dist(S, f, "retries", PS_RETRIES);
+    write_proc_dist(S, f, "turnaround", PS_TURNAROUND);
+    write_utilization(S, f);
+
+    /* métricas próprias da política */
+    if (S->policy && S->policy->write_metrics_json) S->policy->write_metrics_json(S, f);
+    fprintf(f, "\n}\n");
 
     fclose(f);
     return true;
@@ -9,12 +9,43 @@
 #include "simulator.h"
 #include "process.h"
 #include "logger.h"
+#include "policy.h"
+#include "montecarlo.h"
+#include "detector.h"
+#include "flight.h"
+#include "server.h"
+#include "shard.h"
+#include "image.h"
+#include "coroutine.h"
+#include "trace.h"
+#include "stats.h"
+#include "batch.h"
+#include "explore.h"
+#include "analyze.h"
+#include "bench.h"
+#include "check.h"
 
 /* ============================================================
  * Loaders de cenário
  * - Regra para BANKER: Max = Allocation_inicial + soma(script)
  * ============================================================ */
 
+/* Tabelas dos cenários fixos: o maior tem n=10 (--n maior é recusado) */
+#define FIXED_P 16
+
+/* Tabelas dos cenários sintéticos: no heap e com n linhas. Com MAX_P
+   grande (make MAX_P=1048576), tabelas [MAX_P] não cabem no .bss nem na
+   pilha. 'old' != NULL cresce um bloco que continua vivo na execução. */
+static void *scen_alloc(void *old, int n, size_t size, const char *who) {
+    size_t k = (size_t)(n > 0 ? n : 1);
+    void *p = old ? realloc(old, k * size) : calloc(k, size);
+    if (!p) {
+        fprintf(stderr, "[%s] sem memória para %d processos\n", who, n);
+        exit(2);
+    }
+    return p;
+}
+
 /* ----------------- CENÁRIO: TINY (n=2, m=2) -----------------
    Exemplo mínimo: poucos processos/recursos, sem deadlock.
    Mantém Max coerente com o script e alocação inicial. */
@@ -33,10 +64,10 @@ static void load_tiny(System *S) {
     int A[MAX_R] = {3,3};
 
     /* Max alinhado com claim (alloc + script) */
-    int Maxs[MAX_P][MAX_R] = { {3,2}, {2,2} };
-    int Alls[MAX_P][MAX_R] = { {0,1}, {2,0} };
+    int Maxs[FIXED_P][MAX_R] = { {3,2}, {2,2} };
+    int Alls[FIXED_P][MAX_R] = { {0,1}, {2,0} };
 
-    struct ReqList *Scripts[MAX_P] = { &r0, &r1 };
+    struct ReqList *Scripts[FIXED_P] = { &r0, &r1 };
     sys_load_from_arrays(S, A, Maxs, Alls, Scripts);
 }
 
@@ -53,8 +84,8 @@ static void load_medium(System *S) {
 
     int A[MAX_R] = {2, 2, 1};
 
-    int Maxs[MAX_P][MAX_R] = {0};
-    int Alls[MAX_P][MAX_R] = {0};
+    int Maxs[FIXED_P][MAX_R] = {0};
+    int Alls[FIXED_P][MAX_R] = {0};
 
     /* P0 */
     Alls[0][0] = 1; Alls[0][1] = 0; Alls[0][2] = 0;
@@ -102,7 +133,7 @@ static void load_medium(System *S) {
     (void)reqlist_push(&r[5], p5c, S->m);
     Maxs[5][0]=1; Maxs[5][1]=1; Maxs[5][2]=1;
 
-    struct ReqList *Scripts[MAX_P] = {
+    struct ReqList *Scripts[FIXED_P] = {
         &r[0], &r[1], &r[2], &r[3], &r[4], &r[5]
     };
     sys_load_from_arrays(S, A, Maxs, Alls, Scripts);
@@ -121,9 +152,9 @@ static void load_deadlock(System *S) {
     (void)reqlist_push(&r1, p1a, S->m);
 
     int A[MAX_R] = {0,0};
-    int Maxs[MAX_P][MAX_R] = { {1,1}, {1,1} };
-    int Alls[MAX_P][MAX_R] = { {1,0}, {0,1} };
-    struct ReqList *Scripts[MAX_P] = { &r0, &r1 };
+    int Maxs[FIXED_P][MAX_R] = { {1,1}, {1,1} };
+    int Alls[FIXED_P][MAX_R] = { {1,0}, {0,1} };
+    struct ReqList *Scripts[FIXED_P] = { &r0, &r1 };
     sys_load_from_arrays(S, A, Maxs, Alls, Scripts);
 }
 
@@ -139,8 +170,8 @@ static void load_cycle4(System *S) {
 
     int A[MAX_R] = {1,1};
 
-    int Maxs[MAX_P][MAX_R] = {0};
-    int Alls[MAX_P][MAX_R] = {0};
+    int Maxs[FIXED_P][MAX_R] = {0};
+    int Alls[FIXED_P][MAX_R] = {0};
 
     Alls[0][0] = 1; Alls[0][1] = 0;
     Alls[1][0] = 0; Alls[1][1] = 1;
@@ -157,7 +188,7 @@ static void load_cycle4(System *S) {
     Maxs[2][0]=1; Maxs[2][1]=1;
     Maxs[3][0]=1; Maxs[3][1]=1;
 
-    struct ReqList *Scripts[MAX_P] = { &r[0], &r[1], &r[2], &r[3] };
+    struct ReqList *Scripts[FIXED_P] = { &r[0], &r[1], &r[2], &r[3] };
     sys_load_from_arrays(S, A, Maxs, Alls, Scripts);
 }
 
@@ -173,8 +204,8 @@ static void load_hotspot(System *S) {
 
     int A[MAX_R] = {3,10,10,10}; /* R0 é gargalo */
 
-    int Maxs[MAX_P][MAX_R] = {0};
-    int Alls[MAX_P][MAX_R] = {0};
+    int Maxs[FIXED_P][MAX_R] = {0};
+    int Alls[FIXED_P][MAX_R] = {0};
 
     /* 0..3: demanda alta em R0 */
     for (int p = 0; p < 4; ++p) {
@@ -189,7 +220,7 @@ static void load_hotspot(System *S) {
         Maxs[p][0]=0; Maxs[p][1]=1; Maxs[p][2]=2; Maxs[p][3]=1;
     }
 
-    struct ReqList *Scripts[MAX_P] = {
+    struct ReqList *Scripts[FIXED_P] = {
         &r[0],&r[1],&r[2],&r[3],&r[4],&r[5],&r[6],&r[7]
     };
     sys_load_from_arrays(S, A, Maxs, Alls, Scripts);
@@ -207,8 +238,8 @@ static void load_contention90(System *S) {
 
     int A[MAX_R] = {4,4,3};
 
-    int Maxs[MAX_P][MAX_R] = {0};
-    int Alls[MAX_P][MAX_R] = {0};
+    int Maxs[FIXED_P][MAX_R] = {0};
+    int Alls[FIXED_P][MAX_R] = {0};
 
     for (int p = 0; p < 10; ++p) {
         int a[MAX_R] = {1,0,0}; (void)reqlist_push(&r[p], a, S->m);
@@ -216,29 +247,287 @@ static void load_contention90(System *S) {
         Maxs[p][0]=2; Maxs[p][1]=1; Maxs[p][2]=0;
     }
 
-    struct ReqList *Scripts[MAX_P] = {
+    struct ReqList *Scripts[FIXED_P] = {
         &r[0],&r[1],&r[2],&r[3],&r[4],&r[5],&r[6],&r[7],&r[8],&r[9]
     };
     sys_load_from_arrays(S, A, Maxs, Alls, Scripts);
 }
 
+/* -------- CENÁRIO: random (n, m livres; padrão n=256, m=8) --------
+   Carga sintética para medir vazão: cada processo usa até 3 recursos
+   sorteados, Max em 1..2 por recurso e roteiro de pedidos unitários em
+   ordem aleatória. Available = max(maior Max, soma(Max)/4) por recurso:
+   sempre viável, com contenção. Reproduzível por --scenario-seed. */
+static void load_random(System *S, uint64_t seed) {
+    static ReqList *r;                 /* roteiros: vivos durante a execução */
+    static int r_cap;
+    int A[MAX_R] = {0};
+    int (*Maxs)[MAX_R] = scen_alloc(NULL, S->n, sizeof *Maxs, "load_random");
+    int (*Alls)[MAX_R] = scen_alloc(NULL, S->n, sizeof *Alls, "load_random");
+    struct ReqList **Scripts = scen_alloc(NULL, S->n, sizeof *Scripts, "load_random");
+    long long sum[MAX_R] = {0};
+    uint64_t rng = seed;
+
+    if (S->n > r_cap) {
+        r = scen_alloc(r, S->n, sizeof *r, "load_random");
+        r_cap = S->n;
+    }
+    for (int i = 0; i < S->n; ++i) {
+        reqlist_init(&r[i]);
+        int units[3 * 2], k = 0;
+        int touch = S->m < 3 ? S->m : 3;
+        for (int t = 0; t < touch; ++t) {
+            int j = (int)(sched_rand_next(&rng) % (uint64_t)S->m);
+            if (Maxs[i][j]) continue;
+            Maxs[i][j] = 1 + (int)(sched_rand_next(&rng) % 2);
+            for (int u = 0; u < Maxs[i][j]; ++u) units[k++] = j;
+        }
+        for (int u = k - 1; u > 0; --u) {            /* embaralha (Fisher-Yates) */
+            int v = (int)(sched_rand_next(&rng) % (uint64_t)(u + 1));
+            int t = units[u]; units[u] = units[v]; units[v] = t;
+        }
+        for (int u = 0; u < k; ++u) {
+            int req[MAX_R] = {0};
+            req[units[u]] = 1;
+            (void)reqlist_push(&r[i], req, S->m);
+        }
+        for (int j = 0; j < S->m; ++j) {
+            sum[j] += Maxs[i][j];
+            if (Maxs[i][j] > A[j]) A[j] = Maxs[i][j];
+        }
+        Scripts[i] = &r[i];
+    }
+    for (int j = 0; j < S->m; ++j) {
+        if (sum[j] / 4 > A[j]) A[j] = (int)(sum[j] / 4);
+    }
+    sys_load_from_arrays(S, A, Maxs, Alls, Scripts);
+    free(Maxs); free(Alls); free(Scripts);
+}
+
+/* -------- CENÁRIO: workers (n, m livres; padrão n=256, m=8) --------
+   Processos com comportamento (corrotinas) em vez de roteiro: cada um
+   repete 'rounds' vezes — pega uma unidade de A, segura por 1..4 ticks,
+   usa B só se houver B livre naquele instante, pega a 2ª unidade de A,
+   trabalha e devolve as duas (devolução parcial, sem terminar).
+   Max = {A: 2, B: 1}; Available como no random. Reproduzível por
+   --scenario-seed. */
+typedef struct WorkerArg {
+    uint64_t rng;
+    int      a, b;        /* recurso principal e opcional */
+    int      rounds;
+} WorkerArg;
+
+static void worker_behavior(CoTask *t, void *arg) {
+    WorkerArg *w = (WorkerArg *)arg;
+    int one_a[MAX_R] = {0}, one_b[MAX_R] = {0}, two_a[MAX_R] = {0};
+    one_a[w->a] = 1;
+    two_a[w->a] = 2;
+    one_b[w->b] = 1;
+
+    for (int k = 0; k < w->rounds; ++k) {
+        co_request(t, one_a);
+        co_compute(t, 1 + sched_rand_next(&w->rng) % 4);
+        if (w->b != w->a && t->S->Available[w->b] > 0) {
+            co_request(t, one_b);
+            co_compute(t, 1 + sched_rand_next(&w->rng) % 2);
+            co_release(t, one_b);
+        }
+        co_request(t, one_a);
+        co_compute(t, 2);
+        co_release(t, two_a);
+    }
+}
+
+static void load_workers(System *S, uint64_t seed) {
+    static CoTask    *tasks;           /* corrotinas: vivas durante a execução */
+    static WorkerArg *args;
+    static int cap;
+    int (*Maxs)[MAX_R] = scen_alloc(NULL, S->n, sizeof *Maxs, "load_workers");
+    int (*Alls)[MAX_R] = scen_alloc(NULL, S->n, sizeof *Alls, "load_workers");
+    int A[MAX_R] = {0};
+    long long sum[MAX_R] = {0};
+    uint64_t rng = seed;
+
+    if (S->n > cap) {
+        tasks = scen_alloc(tasks, S->n, sizeof *tasks, "load_workers");
+        args  = scen_alloc(args, S->n, sizeof *args, "load_workers");
+        cap = S->n;
+    }
+    for (int i = 0; i < S->n; ++i) {
+        WorkerArg *w = &args[i];
+        w->rng    = sched_rand_next(&rng);
+        w->a      = (int)(sched_rand_next(&rng) % (uint64_t)S->m);
+        w->b      = (int)(sched_rand_next(&rng) % (uint64_t)S->m);
+        w->rounds = 4;
+        Maxs[i][w->a] = 2;
+        if (w->b != w->a) Maxs[i][w->b] = 1;
+        for (int j = 0; j < S->m; ++j) sum[j] += Maxs[i][j];
+    }
+    for (int j = 0; j < S->m; ++j) {
+        A[j] = sum[j] / 4 > 2 ? (int)(sum[j] / 4) : 2;
+    }
+    sys_load_from_arrays(S, A, Maxs, Alls, NULL);
+    free(Maxs); free(Alls);
+    for (int i = 0; i < S->n; ++i) {
+        co_init(&tasks[i], worker_behavior, &args[i]);
+        S->procs[i].co = &tasks[i];
+    }
+}
+
+/* -------- CENÁRIO: locks (n, m livres; padrão n=128, m=32) --------
+   Recursos tipo lock (uma instância cada): cada processo pega de 2 a 4
+   locks sorteados, um por vez e em ordem aleatória (sem ordem global,
+   então há espera circular). Todas as colunas são de instância única e
+   caem nos bitsets do safety/detector (unitbits.h). Para milhares de
+   locks, compile com MAX_R maior (make MAX_R=4096). */
+static void load_locks(System *S, uint64_t seed) {
+    static ReqList *r;                 /* heap: com MAX_R grande não cabe no .bss */
+    static int r_cap;
+    int A[MAX_R] = {0};
+    int (*Maxs)[MAX_R] = scen_alloc(NULL, S->n, sizeof *Maxs, "load_locks");
+    int (*Alls)[MAX_R] = scen_alloc(NULL, S->n, sizeof *Alls, "load_locks");
+    struct ReqList **Scripts = scen_alloc(NULL, S->n, sizeof *Scripts, "load_locks");
+    uint64_t rng = seed;
+
+    if (S->n > r_cap) {
+        r = scen_alloc(r, S->n, sizeof *r, "load_locks");
+        r_cap = S->n;
+    }
+    for (int j = 0; j < S->m; ++j) A[j] = 1;
+    for (int i = 0; i < S->n; ++i) {
+        reqlist_init(&r[i]);
+        int locks[4], k = 0;
+        int want = 2 + (int)(sched_rand_next(&rng) % 3);
+        if (want > S->m) want = S->m;
+        while (k < want) {
+            int j = (int)(sched_rand_next(&rng) % (uint64_t)S->m);
+            if (Maxs[i][j]) continue;
+            Maxs[i][j] = 1;
+            locks[k++] = j;                      /* já em ordem aleatória */
+        }
+        for (int u = 0; u < k; ++u) {
+            int req[MAX_R] = {0};
+            req[locks[u]] = 1;
+            (void)reqlist_push(&r[i], req, S->m);
+        }
+        Scripts[i] = &r[i];
+    }
+    sys_load_from_arrays(S, A, Maxs, Alls, Scripts);
+    free(Maxs); free(Alls); free(Scripts);
+}
+
 /* ============================================================
  * CLI helpers
  * ============================================================ */
 
-static int mode_from_str(const char *s) {
-    if (!s) return MODE_OSTRICH;
-    if (strcmp(s, "banker") == 0)  return MODE_BANKER;
-    if (strcmp(s, "ostrich") == 0) return MODE_OSTRICH;
-    return MODE_OSTRICH;
+/* "a,b,c" → v[0..]; devolve quantos valores leu (-1 se inválido) */
+static int parse_int_list(const char *s, int v[MAX_R]) {
+    int k = 0;
+    while (*s) {
+        char *end;
+        long x = strtol(s, &end, 10);
+        if (end == s || k == MAX_R) return -1;
+        v[k++] = (int)x;
+        s = end;
+        if (*s == ',') s++;
+        else if (*s) return -1;
+    }
+    return k;
+}
+
+/*
+ * --prio: prioridade estática de cada processo (--sched priority, menor
+ * primeiro). "id" (padrão: o próprio pid), "reverse", "random" (permutação
+ * sorteada pela semente do cenário) ou lista "a,b,c" para P0, P1, ... (os demais
+ * ficam com o pid). Retorna false se a especificação for inválida.
+ */
+static bool apply_prio(System *S, const char *spec, uint64_t seed) {
+    if (strcmp(spec, "id") == 0) return true;
+    if (strcmp(spec, "reverse") == 0) {
+        for (int i = 0; i < S->n; ++i) S->procs[i].prio = S->n - 1 - i;
+        return true;
+    }
+    if (strcmp(spec, "random") == 0) {
+        uint64_t rng = seed;
+        for (int i = 0; i < S->n; ++i) S->procs[i].prio = i;
+        for (int i = S->n - 1; i > 0; --i) {            /* Fisher-Yates */
+            int k = (int)(sched_rand_next(&rng) % (uint64_t)(i + 1));
+            int t = S->procs[i].prio;
+            S->procs[i].prio = S->procs[k].prio;
+            S->procs[k].prio = t;
+        }
+        return true;
+    }
+    const char *s = spec;
+    for (int i = 0; *s; ++i) {
+        char *end;
+        long x = strtol(s, &end, 10);
+        if (end == s || i >= S->n) return false;
+        S->procs[i].prio = (int)x;
+        s = end;
+        if (*s == ',') s++;
+        else if (*s) return false;
+    }
+    return true;
+}
+
+/* Seleciona o loader (S já passou por sim_init com n, m e política) */
+static bool load_scenario(System *S, const char *scenario, uint64_t seed) {
+    if      (strcmp(scenario, "tiny") == 0)          { load_tiny(S); }
+    else if (strcmp(scenario, "deadlock") == 0)      { load_deadlock(S); }
+    else if (strcmp(scenario, "medium") == 0)        { load_medium(S); }
+    else if (strcmp(scenario, "cycle-4") == 0)       { load_cycle4(S); }
+    else if (strcmp(scenario, "hotspot") == 0)       { load_hotspot(S); }
+    else if (strcmp(scenario, "contention-90") == 0) { load_contention90(S); }
+    else if (strcmp(scenario, "random") == 0)        { load_random(S, seed); }
+    else if (strcmp(scenario, "workers") == 0)       { load_workers(S, seed); }
+    else if (strcmp(scenario, "locks") == 0)         { load_locks(S, seed); }
+    else return false;
+    return true;
+}
+
+/* --batch: o sistema k da varredura é o cenário com semente scenario_seed+k */
+typedef struct BatchLoadCtx {
+    const char   *scenario;
+    int           n, m;
+    const Policy *policy;
+    uint64_t      seed;
+    DetectConfig  detect_cfg;
+} BatchLoadCtx;
+
+static bool batch_load(System *S, uint64_t k, void *arg) {
+    const BatchLoadCtx *c = arg;
+    sim_init(S, c->n, c->m, c->policy);
+    if (!load_scenario(S, c->scenario, c->seed + k)) return false;
+    S->detect_cfg = c->detect_cfg;
+    return true;
 }
 
 static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [--mode ", prog);
+    for (int i = 0; i < policy_count(); ++i)
+        fprintf(stderr, "%s%s", i ? "|" : "", policy_at(i)->name);
     fprintf(stderr,
-        "Uso: %s [--mode ostrich|banker]"
-        " [--scenario tiny|deadlock|medium|cycle-4|hotspot|contention-90]"
+        "]"
+        " [--scenario tiny|deadlock|medium|cycle-4|hotspot|contention-90|random|workers|locks]"
         " [--n N] [--m M]"
-        " [--log eventos.csv] [--metrics resumo.json]\n", prog);
+        " [--sched index|fifo|random|priority|srs|lnf] [--prio id|reverse|random|a,b,...] [--seed S]"
+        " [--scenario-seed S]"
+        " [--monte-carlo K [--threads T]] [--batch K] [--explore [--no-por]]"
+        " [--detect stall|every:K|ticks:T|blocked:F|adaptive[:K]|none]"
+        " [--flight N [--flight-out voo.json]]"
+        " [--serve sock|- --avail a,b,...]"
+        " [--loadgen sock [--clients C] [--ops N] [--claim X]]"
+        " [--shards K]"
+        " [--compile cenario.img | --image cenario.img]"
+        " [--engine tick|event [--arrival DIST] [--hold DIST]]"
+        " [--trace trace.json] [--stats stats.page]"
+        " [--log eventos.csv] [--metrics resumo.json]\n"
+        "     %s stat stats.page\n"
+        "     %s analyze eventos.csv|eventos.bin [saida.json]\n"
+        "     %s bench [--quick] [--out bench.json] [--baseline anterior.json] (ver %s bench --help)\n"
+        "     %s check [--seeds K] [--seed S]\n",
+        prog, prog, prog, prog, prog);
 }
 
 /* ============================================================
@@ -250,6 +539,24 @@ int main(int argc, char **argv) {
     const char *csv_path = NULL;
     const char *json_path= NULL;
     int n_override = -1, m_override = -1;
+    const char *sched_s = "index";
+    const char *prio_s  = "id";
+    unsigned long long seed = 1;
+    unsigned long long scen_seed = 0;
+    bool scen_seed_set = false;
+    unsigned long long mc_runs = 0, batch_k = 0;
+    int threads = 0;
+    bool explore = false, explore_por = true;
+    const char *detect_s = "stall";
+    unsigned long flight_n = 0;
+    const char *flight_path = "flight.json";
+    const char *serve_path = NULL, *loadgen_path = NULL, *avail_s = NULL;
+    int clients = 64, claim = 2;
+    unsigned long long ops = 100000;
+    int shards = 0;
+    const char *compile_path = NULL, *image_path = NULL;
+    const char *engine_s = "tick", *arrival_s = "const:0", *hold_s = "const:1";
+    const char *trace_path = NULL, *stats_path = NULL;
 
     static struct option opts[] = {
         {"mode",     required_argument, 0, 'm'},
@@ -258,12 +565,59 @@ int main(int argc, char **argv) {
         {"metrics",  required_argument, 0, 'j'},
         {"n",        required_argument, 0, 'N'},
         {"m",        required_argument, 0, 'M'},
+        {"sched",    required_argument, 0, 'S'},
+        {"prio",     required_argument, 0, 'Q'},
+        {"seed",     required_argument, 0, 'r'},
+        {"scenario-seed", required_argument, 0, 'U'},
+        {"monte-carlo", required_argument, 0, 'K'},
+        {"threads",  required_argument, 0, 'T'},
+        {"batch",    required_argument, 0, 'B'},
+        {"explore",  no_argument,       0, 'X'},
+        {"no-por",   no_argument,       0, 'Z'},
+        {"detect",   required_argument, 0, 'D'},
+        {"flight",   required_argument, 0, 'F'},
+        {"flight-out", required_argument, 0, 'O'},
+        {"serve",    required_argument, 0, 'V'},
+        {"avail",    required_argument, 0, 'A'},
+        {"loadgen",  required_argument, 0, 'G'},
+        {"clients",  required_argument, 0, 'C'},
+        {"ops",      required_argument, 0, 'o'},
+        {"claim",    required_argument, 0, 'x'},
+        {"shards",   required_argument, 0, 'P'},
+        {"compile",  required_argument, 0, 'c'},
+        {"image",    required_argument, 0, 'I'},
+        {"engine",   required_argument, 0, 'E'},
+        {"arrival",  required_argument, 0, 'a'},
+        {"hold",     required_argument, 0, 'H'},
+        {"trace",    required_argument, 0, 'R'},
+        {"stats",    required_argument, 0, 'W'},
         {"help",     no_argument,       0, 'h'},
         {0,0,0,0}
     };
 
+    /* Subcomando: acompanha a página de --stats de outra execução */
+    if (argc >= 2 && strcmp(argv[1], "stat") == 0) {
+        if (argc != 3) {
+            fprintf(stderr, "Uso: %s stat stats.page\n", argv[0]);
+            return 1;
+        }
+        return stats_watch(argv[2]);
+    }
+    /* Subcomando: uma passada sobre o log de eventos do --log */
+    if (argc >= 2 && strcmp(argv[1], "analyze") == 0) {
+        return analyze_main(argc, argv);
+    }
+    /* Subcomando: vazão ponta a ponta do sim_run numa grade de cargas */
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        return bench_main(argc, argv);
+    }
+    /* Subcomando: atalhos conferidos contra a redução clássica (make check) */
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return check_main(argc, argv, load_scenario);
+    }
+
     int c, idx=0;
-    while ((c = getopt_long(argc, argv, "m:s:l:j:N:M:h", opts, &idx)) != -1) {
+    while ((c = getopt_long(argc, argv, "m:s:l:j:N:M:S:Q:r:U:K:T:B:XZD:F:O:V:A:G:C:o:x:P:c:I:E:a:H:R:W:h", opts, &idx)) != -1) {
         switch (c) {
             case 'm': mode_s = optarg; break;
             case 's': scenario = optarg; break;
@@ -271,56 +625,338 @@ int main(int argc, char **argv) {
             case 'j': json_path = optarg; break;
             case 'N': n_override = atoi(optarg); break;
             case 'M': m_override = atoi(optarg); break;
+            case 'S': sched_s = optarg; break;
+            case 'Q': prio_s = optarg; break;
+            case 'r': seed = strtoull(optarg, NULL, 0); break;
+            case 'U': scen_seed = strtoull(optarg, NULL, 0); scen_seed_set = true; break;
+            case 'K': mc_runs = strtoull(optarg, NULL, 0); break;
+            case 'T': threads = atoi(optarg); break;
+            case 'B': batch_k = strtoull(optarg, NULL, 0); break;
+            case 'X': explore = true; break;
+            case 'Z': explore_por = false; break;
+            case 'D': detect_s = optarg; break;
+            case 'F': flight_n = strtoul(optarg, NULL, 0); break;
+            case 'O': flight_path = optarg; break;
+            case 'V': serve_path = optarg; break;
+            case 'A': avail_s = optarg; break;
+            case 'G': loadgen_path = optarg; break;
+            case 'C': clients = atoi(optarg); break;
+            case 'o': ops = strtoull(optarg, NULL, 0); break;
+            case 'x': claim = atoi(optarg); break;
+            case 'P': shards = atoi(optarg); break;
+            case 'c': compile_path = optarg; break;
+            case 'I': image_path = optarg; break;
+            case 'E': engine_s = optarg; break;
+            case 'a': arrival_s = optarg; break;
+            case 'H': hold_s = optarg; break;
+            case 'R': trace_path = optarg; break;
+            case 'W': stats_path = optarg; break;
             case 'h': default: usage(argv[0]); return (c=='h'?0:1);
         }
     }
 
-    Mode mode = (Mode)mode_from_str(mode_s);
+    /* O cenário tem semente própria (padrão: --seed). Fixa, ela mantém o
+       mesmo cenário quando --seed varia, como nas rodadas do monte-carlo. */
+    if (!scen_seed_set) scen_seed = seed;
+
+    /* Política resolvida uma única vez por execução */
+    const Policy *policy = policy_find(mode_s);
+    if (!policy) {
+        fprintf(stderr, "Modo desconhecido: %s\n", mode_s);
+        usage(argv[0]);
+        return 2;
+    }
+
+    SchedKind sched_kind;
+    if (!sched_kind_from_str(sched_s, &sched_kind)) {
+        fprintf(stderr, "Escalonador desconhecido: %s\n", sched_s);
+        usage(argv[0]);
+        return 2;
+    }
+
+    DetectConfig detect_cfg;
+    if (!detect_config_parse(detect_s, &detect_cfg)) {
+        fprintf(stderr, "Gatilho de detecção inválido: %s\n", detect_s);
+        usage(argv[0]);
+        return 2;
+    }
 
-    /* Defaults por cenário (alinhados com os loaders) */
-    int n = 2, m = 2;
-    if      (strcmp(scenario, "tiny") == 0)          { n = 2;  m = 2; }
-    else if (strcmp(scenario, "deadlock") == 0)      { n = 2;  m = 2; }
-    else if (strcmp(scenario, "medium") == 0)        { n = 6;  m = 3; }
-    else if (strcmp(scenario, "cycle-4") == 0)       { n = 4;  m = 2; }
-    else if (strcmp(scenario, "hotspot") == 0)       { n = 8;  m = 4; }
-    else if (strcmp(scenario, "contention-90") == 0) { n = 10; m = 3; }
-    else {
-        fprintf(stderr, "Cenário desconhecido: %s\n", scenario);
+    EventConfig ev_cfg = { ENGINE_TICK, { DIST_CONST, 0.0, 0.0 }, { DIST_CONST, 1.0, 0.0 }, (uint64_t)seed };
+    if (!engine_from_str(engine_s, &ev_cfg.engine)) {
+        fprintf(stderr, "Motor desconhecido: %s\n", engine_s);
+        usage(argv[0]);
         return 2;
     }
-    if (n_override > 0) n = n_override;
-    if (m_override > 0) m = m_override;
-
-    System S;
-    sim_init(&S, n, m, mode);
-
-    /* Seleciona loader */
-    if      (strcmp(scenario, "tiny") == 0)          { load_tiny(&S); }
-    else if (strcmp(scenario, "deadlock") == 0)      { load_deadlock(&S); }
-    else if (strcmp(scenario, "medium") == 0)        { load_medium(&S); }
-    else if (strcmp(scenario, "cycle-4") == 0)       { load_cycle4(&S); }
-    else if (strcmp(scenario, "hotspot") == 0)       { load_hotspot(&S); }
-    else if (strcmp(scenario, "contention-90") == 0) { load_contention90(&S); }
-    else {
-        fprintf(stderr, "Sem loader para cenário: %s\n", scenario);
-        sim_finalize(&S);
+    if (!dist_parse(arrival_s, &ev_cfg.arrival) || !dist_parse(hold_s, &ev_cfg.hold)) {
+        fprintf(stderr, "Distribuição inválida (const:X | exp:MÉDIA | uniform:A:B)\n");
+        usage(argv[0]);
         return 2;
     }
 
-    /* Abre log CSV (se pedido) */
+    /* Serviço online / gerador de carga: sem cenário embutido */
+    if (serve_path || loadgen_path) {
+        int avail[MAX_R] = {0};
+        int na = avail_s ? parse_int_list(avail_s, avail) : 0;
+        if (na < 0) {
+            fprintf(stderr, "Lista --avail inválida: %s\n", avail_s);
+            return 2;
+        }
+        int mm = m_override > 0 ? m_override : (na > 0 ? na : 3);
+        if (serve_path) {
+            if (na != mm) {
+                fprintf(stderr, "--serve precisa de --avail com %d valores\n", mm);
+                return 2;
+            }
+            for (int j = 0; j < mm; ++j) {       /* mesma regra do I */
+                if (!rc_fits(avail[j])) {
+                    fprintf(stderr, "--avail: %d não cabe em rc_t\n", avail[j]);
+                    return 2;
+                }
+            }
+            if (csv_path && !logger_open_csv(csv_path, mm)) {
+                fprintf(stderr, "Falha ao abrir CSV: %s\n", csv_path);
+            }
+            ServerConfig sc = { serve_path, policy, mm, {0}, json_path };
+            memcpy(sc.avail, avail, sizeof avail);
+            int rc = server_run(&sc);
+            logger_close_csv();
+            return rc;
+        }
+        LoadGenConfig lc = { loadgen_path, clients, ops, mm, claim, (uint64_t)seed, json_path };
+        return loadgen_run(&lc);
+    }
+
+    /* Cenário: imagem pré-compilada (mmap, sem parse) ou loader embutido */
+    System *S = NULL;
+    Image img = {0};
+    if (image_path) {
+        if (!image_open(&img, image_path, policy)) {
+            fprintf(stderr, "Imagem inválida ou incompatível com este binário: %s\n", image_path);
+            return 2;
+        }
+        S = img.S;
+        scenario = img.hdr.scenario;
+        if (n_override > 0 || m_override > 0)
+            fprintf(stderr, "[image] --n/--m ignorados (vêm da imagem)\n");
+    } else {
+        /* No heap: com MAX_P grande o System não cabe no .bss. Vive até o fim. */
+        S = calloc(1, sizeof *S);
+        if (!S) {
+            fprintf(stderr, "Sem memória para o System (%zu bytes; MAX_P=%d, MAX_R=%d)\n",
+                    sizeof *S, MAX_P, MAX_R);
+            return 1;
+        }
+
+        /* Defaults por cenário (alinhados com os loaders) */
+        int n = 2, m = 2;
+        bool fixed = true;
+        if      (strcmp(scenario, "tiny") == 0)          { n = 2;  m = 2; }
+        else if (strcmp(scenario, "deadlock") == 0)      { n = 2;  m = 2; }
+        else if (strcmp(scenario, "medium") == 0)        { n = 6;  m = 3; }
+        else if (strcmp(scenario, "cycle-4") == 0)       { n = 4;  m = 2; }
+        else if (strcmp(scenario, "hotspot") == 0)       { n = 8;  m = 4; }
+        else if (strcmp(scenario, "contention-90") == 0) { n = 10; m = 3; }
+        else if (strcmp(scenario, "random") == 0)        { n = 256; m = 8;  fixed = false; }
+        else if (strcmp(scenario, "workers") == 0)       { n = 256; m = 8;  fixed = false; }
+        else if (strcmp(scenario, "locks") == 0)         { n = 128; m = 32; fixed = false; }
+        else {
+            fprintf(stderr, "Cenário desconhecido: %s\n", scenario);
+            return 2;
+        }
+        if (n_override > 0) n = n_override;
+        if (m_override > 0) m = m_override;
+        if (n > MAX_P || m > MAX_R) {
+            fprintf(stderr, "--n/--m acima do limite (MAX_P=%d, MAX_R=%d; recompile com make MAX_P=... MAX_R=...)\n",
+                    MAX_P, MAX_R);
+            return 2;
+        }
+        if (fixed && n > FIXED_P) {
+            fprintf(stderr, "Cenário fixo %s: --n até %d\n", scenario, FIXED_P);
+            return 2;
+        }
+
+        sim_init(S, n, m, policy);
+
+        if (!load_scenario(S, scenario, (uint64_t)scen_seed)) {
+            fprintf(stderr, "Sem loader para cenário: %s\n", scenario);
+            sim_finalize(S);
+            return 2;
+        }
+    }
+    sched_init(&S->sched, sched_kind, (uint64_t)seed);
+    S->detect_cfg = detect_cfg;
+    S->ev_cfg = ev_cfg;
+    if (!apply_prio(S, prio_s, (uint64_t)scen_seed)) {
+        fprintf(stderr, "Prioridades inválidas (--prio id|reverse|random|a,b,... até n valores): %s\n", prio_s);
+        sim_finalize(S);
+        image_close(&img);
+        return 2;
+    }
+
+    /* Corrotinas não se copiam (clone/fork/imagem): só no sim_run direto */
+    if (S->procs[0].co && (mc_runs > 0 || shards > 1 || compile_path ||
+                           ev_cfg.engine == ENGINE_EVENT)) {
+        fprintf(stderr, "Cenário %s usa corrotinas: sem --monte-carlo, --shards, --compile"
+                        " ou --engine event\n",
+                scenario);
+        sim_finalize(S);
+        return 2;
+    }
+
+    /* Compilador de cenário: grava a imagem e sai */
+    if (compile_path) {
+        if (!image_write(S, scenario, compile_path)) {
+            fprintf(stderr, "Falha ao gravar imagem: %s\n", compile_path);
+            image_close(&img);
+            return 1;
+        }
+        printf("image=%s scenario=%s n=%d m=%d\n", compile_path, scenario, S->n, S->m);
+        image_close(&img);
+        return 0;
+    }
+
+    /* Lote: K sistemas (sementes seed..seed+K-1) em lanes SIMD, conferidos
+       contra o sim_run escalar */
+    if (batch_k > 0) {
+        char why[128];
+        if (image_path || mc_runs > 0 || shards > 1 || !batch_supported(S, why, sizeof why)) {
+            fprintf(stderr, "--batch: %s\n",
+                    image_path || mc_runs > 0 || shards > 1
+                        ? "não combina com --image, --monte-carlo ou --shards" : why);
+            image_close(&img);
+            return 2;
+        }
+        BatchLoadCtx bctx = { scenario, S->n, S->m, policy, (uint64_t)scen_seed, detect_cfg };
+        BatchConfig bcfg = { batch_k, batch_load, &bctx, true };
+        BatchResult bres;
+        if (!batch_run(&bcfg, &bres)) {
+            fprintf(stderr, "Falha no lote (algum sistema não coube nas lanes)\n");
+            return 1;
+        }
+        if (json_path && !batch_write_json(&bres, policy->label, scenario, json_path)) {
+            fprintf(stderr, "Falha ao escrever JSON: %s\n", json_path);
+        }
+        batch_print_summary(&bres, policy->label, scenario, stdout);
+        sim_finalize(S);
+        return bres.mismatches ? 1 : 0;
+    }
+
+    /* Exploração exaustiva: todas as intercalações do cenário carregado */
+    if (explore) {
+        char why[128];
+        if (mc_runs > 0 || shards > 1 || !explore_supported(S, why, sizeof why)) {
+            fprintf(stderr, "--explore: %s\n",
+                    mc_runs > 0 || shards > 1 ? "não combina com --monte-carlo ou --shards" : why);
+            sim_finalize(S);
+            image_close(&img);
+            return 2;
+        }
+        ExploreConfig ecfg = { threads, explore_por, EXPLORE_TABLE_LOG2 };
+        ExploreResult eres;
+        if (!explore_run(S, &ecfg, &eres)) {
+            fprintf(stderr, "Falha na exploração\n");
+            sim_finalize(S);
+            image_close(&img);
+            return 1;
+        }
+        if (json_path && !explore_write_json(&eres, policy->label, scenario, json_path)) {
+            fprintf(stderr, "Falha ao escrever JSON: %s\n", json_path);
+        }
+        explore_print_summary(&eres, policy->label, scenario, stdout);
+        if (!eres.complete)
+            fprintf(stderr, "[explore] visitado cheio: resultado parcial (recompile com"
+                            " -DEXPLORE_TABLE_LOG2=%d ou mais)\n", EXPLORE_TABLE_LOG2 + 2);
+        explore_result_free(&eres);
+        sim_finalize(S);
+        image_close(&img);
+        return 0;
+    }
+
+    /* Monte Carlo: K intercalações aleatórias do cenário carregado */
+    if (mc_runs > 0) {
+        if (csv_path) fprintf(stderr, "[monte-carlo] --log ignorado (sem I/O por requisição)\n");
+        if (flight_n) fprintf(stderr, "[monte-carlo] --flight ignorado (anel é por execução)\n");
+        if (ev_cfg.engine == ENGINE_EVENT)
+            fprintf(stderr, "[monte-carlo] --engine event ignorado (rodadas por tick)\n");
+        if (trace_path) fprintf(stderr, "[monte-carlo] --trace ignorado (trace é por execução)\n");
+        if (stats_path) fprintf(stderr, "[monte-carlo] --stats ignorado (um escritor por página)\n");
+        MCConfig cfg = { mc_runs, (uint64_t)seed, (uint64_t)scen_seed, threads };
+        MCResult res;
+        if (!mc_run(S, &cfg, &res)) {
+            fprintf(stderr, "Falha no monte-carlo\n");
+            sim_finalize(S);
+            image_close(&img);
+            return 1;
+        }
+        if (json_path && !mc_write_json(&res, policy->label, scenario, json_path)) {
+            fprintf(stderr, "Falha ao escrever JSON: %s\n", json_path);
+        }
+        mc_print_summary(&res, policy->label, scenario, stdout);
+        mc_result_free(&res);
+        sim_finalize(S);
+        image_close(&img);
+        return 0;
+    }
+
+    /* Abre log CSV (se pedido; por processo do SO, então não com --shards) */
+    if (csv_path && shards > 1) {
+        fprintf(stderr, "[shards] --log ignorado (um CSV por processo)\n");
+        csv_path = NULL;
+    }
     if (csv_path) {
-        if (!logger_open_csv(csv_path, S.m)) {
+        if (!logger_open_csv(csv_path, S->m)) {
             fprintf(stderr, "Falha ao abrir CSV: %s\n", csv_path);
         }
     }
 
-    /* Roda simulação */
-    sim_run(&S);
+    /* Gravador de voo (se pedido): só vai a disco em deadlock/travamento */
+    if (flight_n > 0 && shards > 1) {
+        fprintf(stderr, "[shards] --flight ignorado\n");
+        flight_n = 0;
+    }
+    if (ev_cfg.engine == ENGINE_EVENT && shards > 1) {
+        fprintf(stderr, "[shards] --engine event ignorado (workers rodam por tick)\n");
+        S->ev_cfg.engine = ENGINE_TICK;
+    }
+    if (trace_path && shards > 1) {
+        fprintf(stderr, "[shards] --trace ignorado\n");
+        trace_path = NULL;
+    }
+    if (trace_path && !trace_open(trace_path, S->m)) {
+        fprintf(stderr, "Falha ao abrir trace: %s\n", trace_path);
+    }
+    if (stats_path && shards > 1) {
+        fprintf(stderr, "[shards] --stats ignorado\n");
+        stats_path = NULL;
+    }
+    if (stats_path && !stats_open(stats_path, S, scenario)) {
+        fprintf(stderr, "Falha ao abrir página de estatísticas: %s\n", stats_path);
+    }
+    if (flight_n > 0 && !flight_open(flight_path, (uint32_t)flight_n, S->m)) {
+        fprintf(stderr, "Falha ao alocar gravador de voo (%lu eventos)\n", flight_n);
+    }
+
+    /* Roda simulação (um processo ou K shards) */
+    ShardResult shard_res;
+    bool shards_ok = true;
+    if (shards > 1) {
+        shards_ok = shard_run(S, shards, &shard_res);
+        if (!shards_ok) fprintf(stderr, "Falha em algum shard\n");
+    } else if (S->ev_cfg.engine == ENGINE_EVENT) {
+        sim_run_events(S);
+    } else {
+        sim_run(S);
+    }
+    if (S->fault) fprintf(stderr, "Erro na simulação: %s\n", S->fault);
+    flight_close();
+    stats_close(S);
+    if (trace_enabled() && !trace_close(S)) {
+        fprintf(stderr, "Falha ao escrever trace: %s\n", trace_path);
+    }
 
     /* Escreve métricas (se pedido) */
     if (json_path) {
-        if (!metrics_write_json(&S, json_path)) {
+        if (!metrics_write_json(S, json_path)) {
             fprintf(stderr, "Falha ao escrever JSON: %s\n", json_path);
         }
     }
@@ -330,24 +966,36 @@ int main(int argc, char **argv) {
 
     /* Resumo no stdout */
     printf("mode=%s scenario=%s | total=%llu grants=%llu blocks=%llu",
-           (mode==MODE_BANKER?"BANKER":"OSTRICH"), scenario,
-           (unsigned long long)S.metrics.total_requests,
-           (unsigned long long)S.metrics.grants,
-           (unsigned long long)S.metrics.blocks);
-
-    if (mode == MODE_BANKER) {
-        unsigned long long calls = S.metrics.banker_safety_calls;
-        unsigned long long ns    = S.metrics.ns_in_safety_total;
-        printf(" | safety_calls=%llu ns_total=%llu",
-               (unsigned long long)calls, (unsigned long long)ns);
-        if (calls) printf(" avg_ns=%llu", (unsigned long long)(ns/calls));
-    } else {
-        printf(" | deadlocks=%llu t_first=%llu",
-               (unsigned long long)S.metrics.deadlocks_found,
-               (unsigned long long)S.metrics.time_to_first_deadlock);
+           policy->label, scenario,
+           (unsigned long long)S->metrics.total_requests,
+           (unsigned long long)S->metrics.grants,
+           (unsigned long long)S->metrics.blocks);
+    if (policy->print_summary) policy->print_summary(S, stdout);
+
+    double   tat_mean;
+    uint64_t tat_p99;
+    sim_turnaround_stats(S, &tat_mean, &tat_p99);
+    printf(" | sched=%s makespan=%llu tat_mean=%.2f tat_p99=%llu bpg=%.3f",
+           sched_kind_str(S->sched.kind),
+           (unsigned long long)S->sim_clock, tat_mean,
+           (unsigned long long)tat_p99,
+           S->metrics.grants ? (double)S->metrics.blocks / (double)S->metrics.grants : 0.0);
+    if (shards > 1) shard_print_summary(&shard_res, stdout);
+    if (S->ev_cfg.engine == ENGINE_EVENT) {
+        printf(" | engine=event events=%llu thr=%.4f",
+               (unsigned long long)S->metrics.events,
+               S->sim_clock ? (double)S->n_finished / (double)S->sim_clock : 0.0);
+    }
+    if (S->procs[0].co) {
+        uint64_t stacks;
+        co_pool_stats(&stacks, NULL);
+        printf(" | releases=%llu stacks=%llu",
+               (unsigned long long)S->metrics.partial_releases, (unsigned long long)stacks);
     }
     puts("");
 
-    sim_finalize(&S);
-    return 0;
+    bool failed = S->fault || !shards_ok;
+    sim_finalize(S);
+    image_close(&img);                  /* com --image, S some junto */
+    return failed ? 1 : 0;
 }
@@ -0,0 +1,311 @@
+/* ---------------------------------------------------------------------
+ * montecarlo.c — Probabilidade de deadlock por amostragem de intercalações
+ * Pool de pthreads; cada worker tem seu System e cópias dos ReqList
+ * (só o cursor idx é rebobinado entre rodadas). Rodadas são distribuídas
+ * em blocos por um contador atômico.
+ * --------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "montecarlo.h"
+#include "scheduler.h"
+#include "timing.h"
+#include "metrics.h"
+#include "scratch.h"
+
+#define MC_CHUNK        64      /* rodadas por busca no contador global */
+#define MC_SEEDS_STDOUT 10      /* sementes com deadlock listadas no resumo */
+#define MC_SEEDS_JSON   100000  /* limite de sementes no JSON */
+#define MC_HIST_MAX     4096    /* histograma de ttfd só se max <= isso */
+
+typedef struct MCShared {
+    const System   *base;
+    const MCConfig *cfg;
+    MCResult       *out;
+    atomic_ullong   next;
+} MCShared;
+
+typedef struct MCWorker {
+    MCShared  *sh;
+    uint64_t   deadlocks;
+    uint64_t   stalls;
+    bool       ok;
+} MCWorker;
+
+static bool run_finished_all(const System *S) {
+    for (int i = 0; i < S->n; ++i) {
+        if (S->procs[i].state != P_FINISHED) return false;
+    }
+    return true;
+}
+
+static void *mc_worker_main(void *arg) {
+    MCWorker *w = (MCWorker *)arg;
+    const System *base = w->sh->base;
+    const MCConfig *cfg = w->sh->cfg;
+    MCResult *out = w->sh->out;
+    int n = base->n;
+
+    System  *S  = malloc(sizeof *S);
+    ReqList *rl = malloc((size_t)(n > 0 ? n : 1) * sizeof *rl);
+    if (!S || !rl) {
+        free(S); free(rl);
+        w->ok = false;
+        return NULL;
+    }
+    for (int i = 0; i < n; ++i) {
+        if (base->procs[i].script) rl[i] = *base->procs[i].script;
+    }
+
+    bool ok = true;
+    while (ok) {
+        uint64_t k0 = atomic_fetch_add(&w->sh->next, MC_CHUNK);
+        if (k0 >= cfg->runs) break;
+        uint64_t k1 = k0 + MC_CHUNK < cfg->runs ? k0 + MC_CHUNK : cfg->runs;
+
+        for (uint64_t k = k0; k < k1; ++k) {
+            sim_clone(S, base);
+            for (int i = 0; i < n; ++i) {
+                const ReqList *src = base->procs[i].script;
+                if (!src) continue;
+                rl[i].idx = src->idx;
+                S->procs[i].script = &rl[i];
+            }
+            sched_init(&S->sched, SK_RANDOM, cfg->seed + k);
+
+            sim_run(S);
+            if (S->fault) {
+                fprintf(stderr, "[monte-carlo] rodada %llu: %s\n", (unsigned long long)k, S->fault);
+                ok = false;
+                break;
+            }
+
+            bool dl = S->metrics.deadlocks_found > 0;
+            out->deadlocked[k] = dl ? 1 : 0;
+            out->ttfd[k] = S->metrics.time_to_first_deadlock;
+            if (dl) w->deadlocks++;
+            if (!run_finished_all(S)) w->stalls++;
+        }
+    }
+
+    free(S);
+    free(rl);
+    scratch_free();
+    w->ok = ok;
+    return NULL;
+}
+
+bool mc_run(const System *base, const MCConfig *cfg, MCResult *out) {
+    if (!base || !cfg || !out || cfg->runs == 0) return false;
+    memset(out, 0, sizeof *out);
+
+    int threads = cfg->threads;
+    if (threads <= 0) {
+        long c = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = c > 0 ? (int)c : 1;
+    }
+    if ((uint64_t)threads > cfg->runs) threads = (int)cfg->runs;
+
+    out->runs = cfg->runs;
+    out->seed = cfg->seed;
+    out->scenario_seed = cfg->scenario_seed;
+    out->threads = threads;
+    out->deadlocked = calloc(cfg->runs, sizeof *out->deadlocked);
+    out->ttfd       = calloc(cfg->runs, sizeof *out->ttfd);
+    MCWorker  *ws   = calloc((size_t)threads, sizeof *ws);
+    pthread_t *tids = calloc((size_t)threads, sizeof *tids);
+    if (!out->deadlocked || !out->ttfd || !ws || !tids) {
+        free(ws); free(tids);
+        mc_result_free(out);
+        return false;
+    }
+
+    MCShared sh = { base, cfg, out, 0 };
+    atomic_init(&sh.next, 0);
+
+    unsigned long long t0 = now_ns();
+    int started = 0;
+    for (int t = 0; t < threads; ++t) {
+        ws[t].sh = &sh;
+        if (pthread_create(&tids[t], NULL, mc_worker_main, &ws[t]) != 0) break;
+        started++;
+    }
+    bool ok = started > 0;
+    for (int t = 0; t < started; ++t) {
+        pthread_join(tids[t], NULL);
+        ok = ok && ws[t].ok;
+        out->deadlocks += ws[t].deadlocks;
+        out->stalls    += ws[t].stalls;
+    }
+    out->wall_s = (double)(now_ns() - t0) / 1e9;
+    out->threads = started;
+
+    free(ws);
+    free(tids);
+    if (!ok) mc_result_free(out);
+    return ok;
+}
+
+void mc_result_free(MCResult *r) {
+    if (!r) return;
+    free(r->deadlocked);
+    free(r->ttfd);
+    r->deadlocked = NULL;
+    r->ttfd = NULL;
+}
+
+/* ============================
+ * Estatísticas
+ * ============================ */
+
+/* Intervalo de Wilson (95%) para proporção d/k */
+static void wilson95(uint64_t d, uint64_t k, double *lo, double *hi) {
+    const double z = 1.959963984540054;
+    if (k == 0) { *lo = 0.0; *hi = 1.0; return; }
+    double p = (double)d / (double)k, kk = (double)k;
+    double denom  = 1.0 + z * z / kk;
+    double center = (p + z * z / (2.0 * kk)) / denom;
+    double half   = z * sqrt(p * (1.0 - p) / kk + z * z / (4.0 * kk * kk)) / denom;
+    *lo = center - half < 0.0 ? 0.0 : center - half;
+    *hi = center + half > 1.0 ? 1.0 : center + half;
+}
+
+typedef struct TtfdDist {
+    uint64_t  count, min, max, p50, p90, p99;
+    double    mean;
+    uint64_t *sorted;   /* [count] */
+} TtfdDist;
+
+static void ttfd_dist(const MCResult *r, TtfdDist *d) {
+    memset(d, 0, sizeof *d);
+    if (r->deadlocks == 0) return;
+    d->sorted = malloc(r->deadlocks * sizeof *d->sorted);
+    if (!d->sorted) return;
+    double sum = 0.0;
+    for (uint64_t k = 0; k < r->runs; ++k) {
+        if (!r->deadlocked[k]) continue;
+        d->sorted[d->count++] = r->ttfd[k];
+        sum += (double)r->ttfd[k];
+    }
+    qsort(d->sorted, d->count, sizeof *d->sorted, metrics_cmp_u64);
+    d->min  = d->sorted[0];
+    d->max  = d->sorted[d->count - 1];
+    d->p50  = metrics_pct(d->sorted, d->count, 50);
+    d->p90  = metrics_pct(d->sorted, d->count, 90);
+    d->p99  = metrics_pct(d->sorted, d->count, 99);
+    d->mean = sum / (double)d->count;
+}
+
+static double per_core_rate(const MCResult *r) {
+    if (r->wall_s <= 0.0 || r->threads <= 0) return 0.0;
+    return (double)r->runs / r->wall_s / (double)r->threads;
+}
+
+void mc_print_summary(const MCResult *r, const char *mode, const char *scenario, FILE *f) {
+    double lo, hi;
+    wilson95(r->deadlocks, r->runs, &lo, &hi);
+    TtfdDist d;
+    ttfd_dist(r, &d);
+
+    fprintf(f, "mode=%s scenario=%s | runs=%llu threads=%d seed=%llu"
+               " | deadlocks=%llu p=%.6f ci95=[%.6f,%.6f] stalls=%llu",
+            mode, scenario,
+            (unsigned long long)r->runs, r->threads, (unsigned long long)r->seed,
+            (unsigned long long)r->deadlocks,
+            r->runs ? (double)r->deadlocks / (double)r->runs : 0.0, lo, hi,
+            (unsigned long long)r->stalls);
+    if (d.count) {
+        fprintf(f, " | ttfd_min=%llu ttfd_p50=%llu ttfd_p99=%llu ttfd_max=%llu",
+                (unsigned long long)d.min, (unsigned long long)d.p50,
+                (unsigned long long)d.p99, (unsigned long long)d.max);
+    }
+    fprintf(f, " | wall_s=%.3f runs_per_s_core=%.1f", r->wall_s, per_core_rate(r));
+
+    if (r->deadlocks) {
+        fprintf(f, " | scenario_seed=%llu seeds=", (unsigned long long)r->scenario_seed);
+        uint64_t shown = 0;
+        for (uint64_t k = 0; k < r->runs && shown < MC_SEEDS_STDOUT; ++k) {
+            if (!r->deadlocked[k]) continue;
+            fprintf(f, "%s%llu", shown ? "," : "", (unsigned long long)(r->seed + k));
+            shown++;
+        }
+        if (r->deadlocks > shown) fprintf(f, ",...");
+    }
+    fputc('\n', f);
+    free(d.sorted);
+}
+
+bool mc_write_json(const MCResult *r, const char *mode, const char *scenario, const char *path) {
+    if (!r || !path) return false;
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+
+    double lo, hi;
+    wilson95(r->deadlocks, r->runs, &lo, &hi);
+    TtfdDist d;
+    ttfd_dist(r, &d);
+
+    fprintf(f,
+        "{\n"
+        "  \"mode\": \"%s\",\n"
+        "  \"scenario\": \"%s\",\n"
+        "  \"runs\": %llu,\n"
+        "  \"threads\": %d,\n"
+        "  \"seed\": %llu,\n"
+        "  \"scenario_seed\": %llu,\n"
+        "  \"deadlocks\": %llu,\n"
+        "  \"stalls\": %llu,\n"
+        "  \"deadlock_probability\": %.6f,\n"
+        "  \"ci95_low\": %.6f,\n"
+        "  \"ci95_high\": %.6f,\n"
+        "  \"wall_s\": %.6f,\n"
+        "  \"runs_per_s\": %.1f,\n"
+        "  \"runs_per_s_per_core\": %.1f,\n",
+        mode, scenario,
+        (unsigned long long)r->runs, r->threads, (unsigned long long)r->seed,
+        (unsigned long long)r->scenario_seed,
+        (unsigned long long)r->deadlocks, (unsigned long long)r->stalls,
+        r->runs ? (double)r->deadlocks / (double)r->runs : 0.0, lo, hi,
+        r->wall_s, r->wall_s > 0.0 ? (double)r->runs / r->wall_s : 0.0,
+        per_core_rate(r));
+
+    fprintf(f,
+        "  \"time_to_first_deadlock\": {\"count\": %llu, \"min\": %llu, \"mean\": %.3f,"
+        " \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"max\": %llu",
+        (unsigned long long)d.count, (unsigned long long)d.min, d.mean,
+        (unsigned long long)d.p50, (unsigned long long)d.p90,
+        (unsigned long long)d.p99, (unsigned long long)d.max);
+    if (d.count && d.max <= MC_HIST_MAX) {
+        /* histograma esparso: "tick": rodadas */
+        fprintf(f, ", \"histogram\": {");
+        uint64_t i = 0;
+        bool first = true;
+        while (i < d.count) {
+            uint64_t v = d.sorted[i], c = 0;
+            while (i < d.count && d.sorted[i] == v) { c++; i++; }
+            fprintf(f, "%s\"%llu\": %llu", first ? "" : ", ",
+                    (unsigned long long)v, (unsigned long long)c);
+            first = false;
+        }
+        fprintf(f, "}");
+    }
+    fprintf(f, "},\n");
+
+    fprintf(f, "  \"deadlock_seeds\": [");
+    uint64_t shown = 0;
+    for (uint64_t k = 0; k < r->runs && shown < MC_SEEDS_JSON; ++k) {
+        if (!r->deadlocked[k]) continue;
+        fprintf(f, "%s%llu", shown ? ", " : "", (unsigned long long)(r->seed + k));
+        shown++;
+    }
+    fprintf(f, "],\n  \"deadlock_seeds_truncated\": %s\n}\n",
+            r->deadlocks > shown ? "true" : "false");
+
+    free(d.sorted);
+    fclose(f);
+    return true;
+}
@@ -6,3 +6,51 @@
 #include "resources.h"
 #include "simulator.h"
 #include "process.h"
+#include "policy.h"
+#include "detector.h"
+
+/* Concede direto: sem safety check (deadlock possível, medido pelo detector) */
+bool ostrich_on_request(System *S, Process *P, const int req[MAX_R]) {
+    if (!req_within_bounds(S, P, req)) return false;
+    return sys_grant(S, P, req);
+}
+
+static void ostrich_write_metrics_json(const System *S, FILE *f) {
+    fprintf(f,
+        ",\n  \"deadlocks_found\": %llu"
+        ",\n  \"time_to_first_deadlock\": %llu"
+        ",\n  \"deadlocked_procs\": %llu"
+        ",\n  \"detect_trigger\": \"%s\""
+        ",\n  \"detector_calls\": %llu"
+        ",\n  \"ns_in_detector_total\": %llu"
+        ",\n  \"detect_latency_mean\": %.3f"
+        ",\n  \"detect_latency_max\": %llu",
+        (unsigned long long)S->metrics.deadlocks_found,
+        (unsigned long long)S->metrics.time_to_first_deadlock,
+        (unsigned long long)S->metrics.deadlocked_procs,
+        detect_trigger_str(S->detect_cfg.trigger),
+        (unsigned long long)S->metrics.detector_calls,
+        (unsigned long long)S->metrics.ns_in_detector_total,
+        S->metrics.detector_hits
+            ? (double)S->metrics.detect_latency_total / (double)S->metrics.detector_hits : 0.0,
+        (unsigned long long)S->metrics.detect_latency_max);
+}
+
+static void ostrich_print_summary(const System *S, FILE *f) {
+    fprintf(f, " | deadlocks=%llu t_first=%llu det_calls=%llu det_ns=%llu",
+            (unsigned long long)S->metrics.deadlocks_found,
+            (unsigned long long)S->metrics.time_to_first_deadlock,
+            (unsigned long long)S->metrics.detector_calls,
+            (unsigned long long)S->metrics.ns_in_detector_total);
+}
+
+const Policy policy_ostrich = {
+    .name               = "ostrich",
+    .label              = "OSTRICH",
+    .detect_on_stall    = true,
+    .on_request         = ostrich_on_request,
+    .on_tick            = detector_on_tick,
+    .write_metrics_json = ostrich_write_metrics_json,
+    .print_summary      = ostrich_print_summary,
+};
+
@@ -0,0 +1,80 @@
+/* ---------------------------------------------------------------------
+ * partition.c — Manutenção dos componentes independentes
+ * part_add é O(m) + união O(1) das listas; part_remove é O(1).
+ * --------------------------------------------------------------------- */
+#include "partition.h"
+#include "simulator.h"
+#include "process.h"
+
+void part_reset(Partition *pt) {
+    pt->valid = true;
+    for (int j = 0; j < MAX_R; ++j) {
+        pt->parent[j] = j;
+        pt->head[j] = pt->tail[j] = -1;
+        pt->size[j] = 0;
+    }
+    for (int i = 0; i < MAX_P; ++i) {
+        pt->next[i] = pt->prev[i] = -1;
+        pt->anchor[i] = -1;
+    }
+}
+
+/* Junta as listas das raízes a e b; devolve a nova raiz */
+static int part_union(Partition *pt, int a, int b) {
+    a = part_find(pt, a);
+    b = part_find(pt, b);
+    if (a == b) return a;
+    if (pt->size[a] < pt->size[b]) { int t = a; a = b; b = t; }
+    pt->parent[b] = a;
+    if (pt->head[b] >= 0) {
+        if (pt->head[a] < 0) {
+            pt->head[a] = pt->head[b];
+        } else {
+            pt->next[pt->tail[a]] = pt->head[b];
+            pt->prev[pt->head[b]] = pt->tail[a];
+        }
+        pt->tail[a] = pt->tail[b];
+    }
+    pt->size[a] += pt->size[b];
+    pt->head[b] = pt->tail[b] = -1;
+    pt->size[b] = 0;
+    return a;
+}
+
+void part_add(System *S, int pid) {
+    Partition *pt = &S->part;
+    const Process *p = &S->procs[pid];
+    if (pt->anchor[pid] >= 0) part_remove(S, pid);
+
+    int root = -1;
+    for (int j = 0; j < S->m; ++j) {
+        if (p->Max[j] == 0) continue;
+        root = root < 0 ? part_find(pt, j) : part_union(pt, root, j);
+    }
+    if (root < 0) return;                 /* Max nulo: não disputa nada */
+
+    pt->anchor[pid] = root;
+    pt->next[pid] = -1;
+    pt->prev[pid] = pt->tail[root];
+    if (pt->tail[root] >= 0) pt->next[pt->tail[root]] = pid;
+    else                     pt->head[root] = pid;
+    pt->tail[root] = pid;
+    pt->size[root]++;
+}
+
+void part_remove(System *S, int pid) {
+    Partition *pt = &S->part;
+    if (pt->anchor[pid] < 0) return;
+    int root = part_find(pt, pt->anchor[pid]);
+    int pv = pt->prev[pid], nx = pt->next[pid];
+    if (pv >= 0) pt->next[pv] = nx; else pt->head[root] = nx;
+    if (nx >= 0) pt->prev[nx] = pv; else pt->tail[root] = pv;
+    pt->size[root]--;
+    pt->next[pid] = pt->prev[pid] = -1;
+    pt->anchor[pid] = -1;
+}
+
+void part_build(System *S) {
+    part_reset(&S->part);
+    for (int i = 0; i < S->n; ++i) part_add(S, i);
+}
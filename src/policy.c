@@ -0,0 +1,34 @@
+/* ---------------------------------------------------------------------
+ * policy.c — Registro de políticas de admissão (seleção por --mode)
+ * Para adicionar uma política: defina um 'const Policy' no seu .c,
+ * declare-o em policy.h e acrescente-o à tabela abaixo.
+ * --------------------------------------------------------------------- */
+#include <string.h>
+#include <strings.h>
+#include "policy.h"
+
+static const Policy *const g_registry[] = {
+    &policy_banker,
+    &policy_ostrich,
+    &policy_ordered,
+    &policy_wait_die,
+    &policy_wound_wait,
+    &policy_claim,
+};
+
+int policy_count(void) {
+    return ARRAY_LEN(g_registry);
+}
+
+const Policy *policy_at(int i) {
+    if (i < 0 || i >= policy_count()) return NULL;
+    return g_registry[i];
+}
+
+const Policy *policy_find(const char *name) {
+    if (!name) return NULL;
+    for (int i = 0; i < policy_count(); ++i) {
+        if (strcasecmp(g_registry[i]->name, name) == 0) return g_registry[i];
+    }
+    return NULL;
+}
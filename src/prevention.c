@@ -0,0 +1,215 @@
+/* ---------------------------------------------------------------------
+ * prevention.c — Políticas de prevenção em O(m) por requisição
+ *   ORDERED    : ordem global de recursos (índice crescente);
+ *   WAIT-DIE   : mais velho espera, mais novo morre (não-preemptivo);
+ *   WOUND-WAIT : mais velho fere (aborta) o mais novo, mais novo espera.
+ * A decisão só olha a linha do requisitante e os holders extremos por
+ * recurso (holder_old/holder_young do System). Abortos usam
+ * sim_abort_process() (release_all_resources + reqlist_rewind, e a
+ * alocação da carga volta a ser pedida antes do roteiro); o
+ * ORDERED não aborta: devolve parte do que detém e readquire em ordem.
+ * --------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdbool.h>
+#include "resources.h"
+#include "simulator.h"
+#include "process.h"
+#include "policy.h"
+
+/* ============================
+ * Holders extremos por recurso
+ * ============================ */
+
+/* Recalcula holder_old/holder_young de j varrendo os processos: só roda
+   na liberação de quem era extremo, nunca no caminho da decisão. */
+static void holders_rescan(System *S, int j, const Process *skip) {
+    int old = -1, young = -1;
+    for (int i = 0; i < S->n; ++i) {
+        const Process *q = &S->procs[i];
+        if (q == skip || q->Allocation[j] == 0) continue;
+        if (old   < 0 || q->ts < S->procs[old].ts)   old = i;
+        if (young < 0 || q->ts > S->procs[young].ts) young = i;
+    }
+    S->holder_old[j]   = old;
+    S->holder_young[j] = young;
+}
+
+static void holders_ensure(System *S) {
+    if (S->holders_valid) return;
+    for (int j = 0; j < S->m; ++j) holders_rescan(S, j, NULL);
+    S->holders_valid = true;
+}
+
+/* P passou a deter os recursos de 'req' */
+static void holders_on_grant(System *S, const Process *P, const int req[MAX_R]) {
+    for (int j = 0; j < S->m; ++j) {
+        if (req[j] == 0) continue;
+        int o = S->holder_old[j], y = S->holder_young[j];
+        if (o < 0 || P->ts < S->procs[o].ts) S->holder_old[j]   = P->id;
+        if (y < 0 || P->ts > S->procs[y].ts) S->holder_young[j] = P->id;
+    }
+}
+
+/* on_release: P vai devolver tudo (fim de roteiro ou aborto) */
+static void holders_on_release(System *S, Process *P) {
+    if (!S->holders_valid) return;
+    for (int j = 0; j < S->m; ++j) {
+        if (P->Allocation[j] == 0) continue;
+        if (S->holder_old[j] == P->id || S->holder_young[j] == P->id)
+            holders_rescan(S, j, P);
+    }
+}
+
+/* 0 <= req <= Need (sem olhar Available) */
+static inline bool req_within_need(const System *S, const Process *P, const int req[MAX_R]) {
+    for (int j = 0; j < S->m; ++j) {
+        if (req[j] < 0 || req[j] > P->Need[j]) return false;
+    }
+    return true;
+}
+
+static inline bool grant_and_track(System *S, Process *P, const int req[MAX_R]) {
+    if (!sys_grant(S, P, req)) return false;
+    holders_on_grant(S, P, req);
+    return true;
+}
+
+/* ============================
+ * ORDERED
+ * ============================ */
+
+/* P devolve o que detém de índice >= lo e guarda para readquirir */
+static void ordered_release_from(System *S, Process *P, int lo) {
+    int rel[MAX_R] = {0};
+    for (int j = lo; j < S->m; ++j) rel[j] = P->Allocation[j];
+    if (!sys_rollback(S, P, rel)) return;
+    for (int j = lo; j < S->m; ++j) P->reacq[j] = (rc_t)rel[j];
+    P->reacq_pending = true;
+    S->holders_valid = false;
+    S->metrics.partial_releases++;            /* devolução: conta como progresso */
+}
+
+/*
+ * Um pedido respeita a ordem se todo recurso pedido tem índice maior que
+ * qualquer recurso já detido. Só pedidos conformes podem esperar. Um pedido
+ * fora de ordem é concedido se couber agora; senão P devolve o que detém a
+ * partir do menor índice pedido e passa a esperar por pedido + devolvido,
+ * que agora é conforme. Ninguém espera segurando um índice acima do que
+ * espera: sem ciclo, sem aborto e sem trabalho perdido.
+ */
+static bool ordered_on_request(System *S, Process *P, const int req[MAX_R]) {
+    holders_ensure(S);
+    if (!req_within_need(S, P, req)) return false;
+
+    int want[MAX_R];
+    const int *r = req;
+    if (P->reacq_pending) {
+        for (int j = 0; j < S->m; ++j) want[j] = req[j] + P->reacq[j];
+        r = want;
+    }
+
+    int held_hi = -1, req_lo = MAX_R;
+    for (int j = 0; j < S->m; ++j) {
+        if (P->Allocation[j] > 0) held_hi = j;
+        if (r[j] > 0 && j < req_lo) req_lo = j;
+    }
+
+    if (req_within_bounds(S, P, r)) {
+        if (!grant_and_track(S, P, r)) return false;
+        if (P->reacq_pending) {
+            for (int j = 0; j < S->m; ++j) P->reacq[j] = 0;
+            P->reacq_pending = false;
+        }
+        return true;
+    }
+    if (req_lo > held_hi) return false;            /* conforme: espera */
+
+    S->metrics.order_violations++;
+    ordered_release_from(S, P, req_lo);
+    return false;
+}
+
+/* ============================
+ * WAIT-DIE / WOUND-WAIT
+ * ============================ */
+
+/* Pedido não cabe em Available: P espera (true) ou morre (false)?
+   P espera só se for mais velho que todos os holders em conflito. */
+static bool wait_die_may_wait(const System *S, const Process *P, const int req[MAX_R]) {
+    for (int j = 0; j < S->m; ++j) {
+        if (req[j] <= S->Available[j]) continue;
+        int o = S->holder_old[j];
+        if (o >= 0 && o != P->id && S->procs[o].ts < P->ts) return false;
+    }
+    return true;
+}
+
+static bool wait_die_on_request(System *S, Process *P, const int req[MAX_R]) {
+    holders_ensure(S);
+    if (!req_within_need(S, P, req)) return false;
+    if (req_within_bounds(S, P, req)) return grant_and_track(S, P, req);
+
+    if (!wait_die_may_wait(S, P, req)) sim_abort_process(S, P);  /* die */
+    return false;
+}
+
+/* P fere o holder mais novo de cada recurso em conflito, se for mais novo
+   que P; depois tenta de novo. Se ainda não couber, P espera. */
+static bool wound_wait_on_request(System *S, Process *P, const int req[MAX_R]) {
+    holders_ensure(S);
+    if (!req_within_need(S, P, req)) return false;
+    if (req_within_bounds(S, P, req)) return grant_and_track(S, P, req);
+
+    for (int j = 0; j < S->m; ++j) {
+        if (req[j] <= S->Available[j]) continue;
+        int y = S->holder_young[j];
+        if (y >= 0 && y != P->id && S->procs[y].ts > P->ts)
+            sim_abort_process(S, &S->procs[y]);      /* wound */
+    }
+    if (req_within_bounds(S, P, req)) return grant_and_track(S, P, req);
+    return false;                                    /* wait */
+}
+
+/* ============================
+ * Export de métricas
+ * ============================ */
+
+static void ordered_write_metrics_json(const System *S, FILE *f) {
+    fprintf(f, ",\n  \"order_violations\": %llu",
+            (unsigned long long)S->metrics.order_violations);
+}
+
+static void prevention_print_summary(const System *S, FILE *f) {
+    fprintf(f, " | aborts=%llu restarts=%llu wasted=%llu",
+            (unsigned long long)S->metrics.aborts,
+            (unsigned long long)S->metrics.restarts,
+            (unsigned long long)S->metrics.wasted_grants);
+}
+
+const Policy policy_ordered = {
+    .name               = "ordered",
+    .label              = "ORDERED",
+    .detect_on_stall    = false,
+    .on_request         = ordered_on_request,
+    .on_release         = holders_on_release,
+    .write_metrics_json = ordered_write_metrics_json,
+    .print_summary      = prevention_print_summary,
+};
+
+const Policy policy_wait_die = {
+    .name               = "wait-die",
+    .label              = "WAIT-DIE",
+    .detect_on_stall    = false,
+    .on_request         = wait_die_on_request,
+    .on_release         = holders_on_release,
+    .print_summary      = prevention_print_summary,
+};
+
+const Policy policy_wound_wait = {
+    .name               = "wound-wait",
+    .label              = "WOUND-WAIT",
+    .detect_on_stall    = false,
+    .on_request         = wound_wait_on_request,
+    .on_release         = holders_on_release,
+    .print_summary      = prevention_print_summary,
+};
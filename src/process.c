@@ -4,6 +4,7 @@
  * --------------------------------------------------------------------- */
 
 #include "process.h"
+#include "coroutine.h"
 
 
 void reqlist_init(ReqList *rl){
@@ -81,6 +82,24 @@ void proc_reset(Process *p, int id) {
     }
     p->script = NULL;  /* ainda não implementado */
     p->wait_time_acc = 0;
+    p->retries = 0;
+    p->waiting = false;
+    p->ts = (uint64_t)id;
+    p->grants_since_start = 0;
+    p->aborts = 0;
+    p->restarted = false;
+    p->reacq_pending = false;
+    for (int j = 0; j < MAX_R; j++) p->reacq[j] = 0;
+    for (int j = 0; j < MAX_R; j++) p->Init[j] = 0;
+    p->init_pending = false;
+    p->prio = id;
+    p->in_ready = false;
+    p->in_blocked = false;
+    p->arrival_clock = 0;
+    p->finish_clock = 0;
+    p->blocked_since = 0;
+    p->in_deadlock = false;
+    p->co = NULL;
 }
 
 /*
@@ -103,7 +122,38 @@ bool proc_invariants_ok(const Process *p) {
     if (p == NULL) return false;
     for (int j = 0; j < MAX_R; j++) {
         if (p->Need[j] != p->Max[j] - p->Allocation[j]) return false;
-        if (p->Need[j] < 0) return false;
+        if (!rc_fits(p->Need[j])) return false;
     }
     return true;
 }
+
+/*
+ * proc_peek_request
+ * Após um restart com alocação de carga: essa alocação (Init). Processo
+ * com roteiro: próximo item. Com corrotina: o pedido que ela fez e
+ * ainda não foi concedido.
+ */
+bool proc_peek_request(const Process *p, int out_req[MAX_R]) {
+    if (p == NULL) return false;
+    if (p->init_pending) {
+        for (int j = 0; j < MAX_R; j++) out_req[j] = p->Init[j];
+        return true;
+    }
+    if (p->co) {
+        if (p->co->op != CO_OP_REQUEST || p->co->granted) return false;
+        for (int j = 0; j < MAX_R; j++) out_req[j] = p->co->req[j];
+        return true;
+    }
+    return p->script && reqlist_peek(p->script, out_req);
+}
+
+void proc_pop_request(Process *p) {
+    if (p == NULL) return;
+    if (p->init_pending)  p->init_pending = false;
+    else if (p->co)       p->co->granted = true;
+    else if (p->script)   (void)reqlist_pop(p->script);
+}
+
+bool proc_script_done(const Process *p) {
+    return !p->init_pending && (p->script == NULL || reqlist_empty(p->script));
+}
@@ -0,0 +1,178 @@
+/* ---------------------------------------------------------------------
+ * scheduler.c — Filas READY/BLOCKED do sim_run
+ * FIFO usa anel O(1); as demais ordens usam heap binário com chave
+ * calculada no push (O(log n) por operação, sem varredura linear).
+ * --------------------------------------------------------------------- */
+#include <string.h>
+#include "scheduler.h"
+#include "simulator.h"
+#include "process.h"
+
+static const char *const g_kind_names[] = {
+    [SK_INDEX]    = "index",
+    [SK_FIFO]     = "fifo",
+    [SK_RANDOM]   = "random",
+    [SK_PRIORITY] = "priority",
+    [SK_SRS]      = "srs",
+    [SK_LNF]      = "lnf",
+};
+
+const char *sched_kind_str(SchedKind k) {
+    if ((int)k < 0 || (int)k >= ARRAY_LEN(g_kind_names)) return "?";
+    return g_kind_names[k];
+}
+
+bool sched_kind_from_str(const char *s, SchedKind *out) {
+    if (!s || !out) return false;
+    for (int k = 0; k < ARRAY_LEN(g_kind_names); ++k) {
+        if (strcmp(s, g_kind_names[k]) == 0) { *out = (SchedKind)k; return true; }
+    }
+    return false;
+}
+
+static void queue_clear(SchedQueue *q) {
+    q->len = 0;
+    q->head = 0;
+}
+
+void sched_init(Scheduler *sc, SchedKind kind, uint64_t seed) {
+    if (!sc) return;
+    sc->kind = kind;
+    sc->seed = seed;
+    sc->rng  = seed;
+    sc->seq  = 0;
+    sc->rcur = 0;
+    sc->bcur = 0;
+    for (int i = 0; i < 2; ++i) {
+        queue_clear(&sc->ready[i]);
+        queue_clear(&sc->blocked[i]);
+    }
+}
+
+/* ============================
+ * Chave de ordenação
+ * ============================ */
+static uint64_t sched_key(Scheduler *sc, const System *S, const Process *P) {
+    switch (sc->kind) {
+        case SK_RANDOM:   return sched_rand_next(&sc->rng);
+        case SK_PRIORITY: return (uint64_t)(int64_t)P->prio ^ 0x8000000000000000ull;
+        case SK_SRS:      return (uint64_t)(P->script ? reqlist_count(P->script) : 0) + P->init_pending;
+        case SK_LNF: {
+            uint64_t sum = 0;
+            for (int j = 0; j < S->m; ++j) sum += P->Need[j];
+            return UINT64_MAX - sum;
+        }
+        case SK_INDEX:
+        case SK_FIFO:
+        default:             return (uint64_t)P->id;
+    }
+}
+
+/* ============================
+ * Heap binário (min por key, tie) e anel
+ * ============================ */
+static inline bool entry_less(const SchedEntry *a, const SchedEntry *b) {
+    if (a->key != b->key) return a->key < b->key;
+    return a->tie < b->tie;
+}
+
+static void heap_push(SchedQueue *q, SchedEntry x) {
+    int i = q->len++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!entry_less(&x, &q->e[parent])) break;
+        q->e[i] = q->e[parent];
+        i = parent;
+    }
+    q->e[i] = x;
+}
+
+static SchedEntry heap_pop(SchedQueue *q) {
+    SchedEntry top = q->e[0];
+    SchedEntry last = q->e[--q->len];
+    int i = 0;
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= q->len) break;
+        if (c + 1 < q->len && entry_less(&q->e[c + 1], &q->e[c])) c++;
+        if (!entry_less(&q->e[c], &last)) break;
+        q->e[i] = q->e[c];
+        i = c;
+    }
+    if (q->len > 0) q->e[i] = last;
+    return top;
+}
+
+static void queue_push(Scheduler *sc, SchedQueue *q, const System *S, const Process *P) {
+    if (q->len >= MAX_P) return;  /* cada pid entra no máximo uma vez */
+    SchedEntry x = { 0, sc->seq++, P->id };
+    if (sc->kind == SK_FIFO) {
+        q->e[(q->head + q->len) % MAX_P] = x;
+        q->len++;
+        return;
+    }
+    x.key = sched_key(sc, S, P);
+    heap_push(q, x);
+}
+
+static int queue_pop(Scheduler *sc, SchedQueue *q) {
+    if (q->len == 0) return -1;
+    if (sc->kind == SK_FIFO) {
+        int pid = q->e[q->head].pid;
+        q->head = (q->head + 1) % MAX_P;
+        q->len--;
+        return pid;
+    }
+    return heap_pop(q).pid;
+}
+
+/* ============================
+ * Interface usada pelo sim_run
+ * ============================ */
+void sched_push_ready(System *S, Process *P) {
+    if (P->in_ready) return;
+    Scheduler *sc = &S->sched;
+    P->in_ready = true;
+    queue_push(sc, &sc->ready[sc->rcur ^ 1], S, P);
+}
+
+void sched_push_blocked(System *S, Process *P) {
+    if (P->in_blocked) return;
+    Scheduler *sc = &S->sched;
+    P->in_blocked = true;
+    queue_push(sc, &sc->blocked[sc->bcur], S, P);
+}
+
+void sched_begin_round(Scheduler *sc) {
+    sc->rcur ^= 1;
+}
+
+int sched_pop_ready(System *S) {
+    Scheduler *sc = &S->sched;
+    int pid = queue_pop(sc, &sc->ready[sc->rcur]);
+    if (pid >= 0) S->procs[pid].in_ready = false;
+    return pid;
+}
+
+void sched_begin_sweep(Scheduler *sc) {
+    sc->bcur ^= 1;
+}
+
+int sched_pop_sweep(System *S) {
+    Scheduler *sc = &S->sched;
+    int pid = queue_pop(sc, &sc->blocked[sc->bcur ^ 1]);
+    if (pid >= 0) S->procs[pid].in_blocked = false;
+    return pid;
+}
+
+int sched_ready_count(const Scheduler *sc) {
+    return sc->ready[0].len + sc->ready[1].len;
+}
+
+int sched_blocked_count(const Scheduler *sc) {
+    return sc->blocked[0].len + sc->blocked[1].len;
+}
+
+bool sched_pending(const Scheduler *sc) {
+    return sched_ready_count(sc) + sched_blocked_count(sc) > 0;
+}
@@ -0,0 +1,28 @@
+/* ---------------------------------------------------------------------
+ * scratch.c — Buffers de trabalho por thread (crescem por dobra)
+ * --------------------------------------------------------------------- */
+#include <stdlib.h>
+#include "scratch.h"
+
+static _Thread_local struct { void *p; size_t cap; } g_scratch[SCR_COUNT];
+
+void *scratch_get(ScratchSlot k, size_t bytes) {
+    if (bytes == 0) bytes = 1;
+    if (bytes > g_scratch[k].cap) {
+        size_t cap = g_scratch[k].cap ? g_scratch[k].cap : 4096;
+        while (cap < bytes) cap *= 2;
+        void *p = realloc(g_scratch[k].p, cap);
+        if (!p) return NULL;
+        g_scratch[k].p = p;
+        g_scratch[k].cap = cap;
+    }
+    return g_scratch[k].p;
+}
+
+void scratch_free(void) {
+    for (int k = 0; k < SCR_COUNT; ++k) {
+        free(g_scratch[k].p);
+        g_scratch[k].p = NULL;
+        g_scratch[k].cap = 0;
+    }
+}
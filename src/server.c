@@ -0,0 +1,505 @@
+/* ---------------------------------------------------------------------
+ * server.c — Controle de admissão online sobre socket Unix / stdin
+ * Laço único com poll(): cada leitura é consumida inteira (todas as
+ * linhas completas viram decisões) e as respostas saem num único write
+ * por conexão. Sem threads: o System residente não precisa de trava.
+ * --------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/resource.h>
+#include "server.h"
+#include "simulator.h"
+#include "process.h"
+#include "policy.h"
+#include "logger.h"
+#include "timing.h"
+
+#define SRV_IN_CAP   65536   /* bytes pendentes por conexão (linha parcial incluída) */
+#define SRV_BACKLOG  4096
+
+typedef struct Conn {
+    int    fd;
+    uint64_t id;                  /* dono dos pids registrados por ela (> 0) */
+    size_t in_len;
+    char   in[SRV_IN_CAP];
+    char  *out;
+    size_t out_len, out_cap;
+} Conn;
+
+typedef struct Server {
+    System   *S;
+    long long total[MAX_R];       /* instâncias por recurso (Available + alocado) */
+    int       free_pids[MAX_P];   /* pilha de pids liberados por F */
+    int       n_free;
+    uint32_t  seen_aborts[MAX_P]; /* abortos já avisados a cada pid */
+    uint64_t  owner[MAX_P];       /* Conn.id que registrou o pid (0 = livre) */
+    uint64_t  next_ts, next_conn;
+    uint64_t  decisions, batches, ns_deciding;
+    uint64_t  reaped;             /* pids terminados porque a conexão caiu */
+} Server;
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void on_stop(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
+static void install_signals(void) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sa_handler = on_stop;           /* sem SA_RESTART: poll volta com EINTR */
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+}
+
+static void raise_fd_limit(void) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        (void)setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+/* ============================
+ * Saída bufferizada por conexão
+ * ============================ */
+static bool out_reserve(Conn *c, size_t extra) {
+    if (c->out_len + extra <= c->out_cap) return true;
+    size_t cap = c->out_cap ? c->out_cap : 4096;
+    while (cap < c->out_len + extra) cap *= 2;
+    char *p = realloc(c->out, cap);
+    if (!p) return false;
+    c->out = p;
+    c->out_cap = cap;
+    return true;
+}
+
+static void reply(Conn *c, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void reply(Conn *c, const char *fmt, ...) {
+    if (!out_reserve(c, 256)) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int k = vsnprintf(c->out + c->out_len, c->out_cap - c->out_len, fmt, ap);
+    va_end(ap);
+    if (k > 0 && (size_t)k < c->out_cap - c->out_len) c->out_len += (size_t)k;
+}
+
+/* Tenta esvaziar o buffer; false = conexão morreu */
+static bool flush_out(Conn *c) {
+    size_t off = 0;
+    while (off < c->out_len) {
+        ssize_t w = write(c->fd, c->out + off, c->out_len - off);
+        if (w > 0) { off += (size_t)w; continue; }
+        if (w < 0 && errno == EINTR) continue;
+        if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        return false;
+    }
+    memmove(c->out, c->out + off, c->out_len - off);
+    c->out_len -= off;
+    return true;
+}
+
+/* ============================
+ * Comandos
+ * ============================ */
+
+/* Lê até 'k' inteiros de s; devolve quantos leu */
+static int parse_ints(const char *s, int *v, int k) {
+    int got = 0;
+    while (got < k) {
+        char *end;
+        long x = strtol(s, &end, 10);
+        if (end == s) break;
+        v[got++] = (int)x;
+        s = end;
+    }
+    return got;
+}
+
+static void server_reset(Server *sv, const int avail[MAX_R]) {
+    System *S = sv->S;
+    sim_reset(S);
+    S->n = 0;
+    for (int j = 0; j < S->m; ++j) {
+        S->Available[j] = (rc_t)avail[j];
+        sv->total[j] = avail[j];
+    }
+    sv->n_free = 0;
+    sv->next_ts = 0;
+    memset(sv->seen_aborts, 0, sizeof sv->seen_aborts);
+    memset(sv->owner, 0, sizeof sv->owner);
+}
+
+/* Pid vivo e registrado por esta conexão (as outras não o enxergam) */
+static Process *lookup(Server *sv, const Conn *c, int pid) {
+    System *S = sv->S;
+    if (pid < 0 || pid >= S->n || sv->owner[pid] != c->id) return NULL;
+    Process *P = &S->procs[pid];
+    if (P->state == P_FINISHED || P->state == P_NEW) return NULL;
+    return P;
+}
+
+/* Termina P: devolve tudo e devolve o pid à pilha de livres */
+static void finish_pid(Server *sv, Process *P) {
+    System *S = sv->S;
+    int pid = P->id;
+    if (S->policy->on_release) S->policy->on_release(S, P);
+    release_all_resources(S, P);
+    part_remove(S, pid);
+    proc_reset(P, pid);
+    P->state = P_FINISHED;
+    sv->owner[pid] = 0;
+    sv->free_pids[sv->n_free++] = pid;
+}
+
+/* Conexão caiu: termina os processos que ela registrou, senão os recursos
+   deles ficariam presos para sempre */
+static void conn_reap(Server *sv, const Conn *c) {
+    System *S = sv->S;
+    for (int pid = 0; pid < S->n; ++pid) {
+        if (sv->owner[pid] != c->id) continue;
+        Process *P = &S->procs[pid];
+        if (P->state == P_FINISHED || P->state == P_NEW) continue;
+        finish_pid(sv, P);
+        sv->reaped++;
+    }
+}
+
+/* Algum pid vivo registrado por outra conexão que não c */
+static bool others_own(const Server *sv, const Conn *c) {
+    const System *S = sv->S;
+    for (int pid = 0; pid < S->n; ++pid) {
+        if (sv->owner[pid] != 0 && sv->owner[pid] != c->id) return true;
+    }
+    return false;
+}
+
+static void cmd_register(Server *sv, Conn *c, const int *x) {
+    System *S = sv->S;
+    for (int j = 0; j < S->m; ++j) {
+        if (x[j] < 0 || x[j] > sv->total[j]) { reply(c, "E claim\n"); return; }
+    }
+    int pid;
+    if (sv->n_free > 0)    pid = sv->free_pids[--sv->n_free];
+    else if (S->n < MAX_P) pid = S->n++;
+    else { reply(c, "E full\n"); return; }
+
+    Process *P = &S->procs[pid];
+    proc_reset(P, pid);
+    for (int j = 0; j < S->m; ++j) P->Max[j] = (rc_t)x[j];
+    proc_compute_need(P);
+    for (int j = 0; j < S->m; ++j) sys_cell_changed(S, P, j, 0);
+    sys_env_invalidate(S);             /* Pi novo fora das sequências dos envelopes */
+    P->ts = sv->next_ts++;
+    P->state = P_READY;
+    part_add(S, pid);
+    sv->seen_aborts[pid] = 0;
+    sv->owner[pid] = c->id;
+    reply(c, "P %d\n", pid);
+}
+
+static void cmd_request(Server *sv, Conn *c, int pid, const int *r) {
+    System *S = sv->S;
+    Process *P = lookup(sv, c, pid);
+    if (!P) { reply(c, "E pid\n"); return; }
+
+    /* Ferido por outro (wound-wait) desde a última resposta: avisa antes */
+    if (P->aborts != sv->seen_aborts[pid]) {
+        sv->seen_aborts[pid] = P->aborts;
+        reply(c, "X\n");
+        return;
+    }
+
+    /* Fora da reivindicação (negativo ou > Need <= Max): nunca seria
+       concedido, e um D faria o cliente repetir para sempre */
+    int req[MAX_R] = {0};
+    for (int j = 0; j < S->m; ++j) {
+        if (r[j] < 0 || r[j] > P->Need[j]) { reply(c, "E req\n"); return; }
+        req[j] = r[j];
+    }
+
+    unsigned long long t0 = now_ns();
+    P->state = P_RUNNING;
+    bool ok = handle_request_current_mode(S, P, req);
+    sv->ns_deciding += now_ns() - t0;
+    sv->decisions++;
+
+    if (P->aborts != sv->seen_aborts[pid]) {
+        sv->seen_aborts[pid] = P->aborts;
+        reply(c, "X\n");
+        return;
+    }
+    P->state = P_READY;          /* negado: o cliente decide quando tentar de novo */
+    reply(c, ok ? "G\n" : "D\n");
+}
+
+static void cmd_release(Server *sv, Conn *c, int pid, const int *r) {
+    System *S = sv->S;
+    Process *P = lookup(sv, c, pid);
+    if (!P) { reply(c, "E pid\n"); return; }
+    int rel[MAX_R] = {0};
+    for (int j = 0; j < S->m; ++j) {
+        if (r[j] < 0 || r[j] > P->Allocation[j]) { reply(c, "E release\n"); return; }
+        rel[j] = r[j];
+    }
+    /* devolver parcial = desfazer parte da alocação (Need volta a crescer) */
+    if (!sys_rollback(S, P, rel)) { reply(c, "E release\n"); return; }
+    S->holders_valid = false;
+    reply(c, "K\n");
+}
+
+static void cmd_finish(Server *sv, Conn *c, int pid) {
+    Process *P = lookup(sv, c, pid);
+    if (!P) { reply(c, "E pid\n"); return; }
+    finish_pid(sv, P);
+    reply(c, "K\n");
+}
+
+static void cmd_stats(Server *sv, Conn *c) {
+    const Metrics *mt = &sv->S->metrics;
+    reply(c, "S procs=%d total=%llu grants=%llu blocks=%llu aborts=%llu batches=%llu avg_ns=%llu\n",
+          sv->S->n - sv->n_free,
+          (unsigned long long)mt->total_requests, (unsigned long long)mt->grants,
+          (unsigned long long)mt->blocks, (unsigned long long)mt->aborts,
+          (unsigned long long)sv->batches,
+          (unsigned long long)(sv->decisions ? sv->ns_deciding / sv->decisions : 0));
+}
+
+static void handle_line(Server *sv, Conn *c, char *line) {
+    int m = sv->S->m;
+    int v[MAX_R + 1];
+    char op = line[0];
+    const char *args = line + 1;
+
+    switch (op) {
+        case 'Q': case 'L':
+            if (parse_ints(args, v, m + 1) != m + 1) { reply(c, "E args\n"); return; }
+            if (op == 'Q') cmd_request(sv, c, v[0], v + 1);
+            else           cmd_release(sv, c, v[0], v + 1);
+            return;
+        case 'P':
+            if (parse_ints(args, v, m) != m) { reply(c, "E args\n"); return; }
+            cmd_register(sv, c, v);
+            return;
+        case 'F':
+            if (parse_ints(args, v, 1) != 1) { reply(c, "E args\n"); return; }
+            cmd_finish(sv, c, v[0]);
+            return;
+        case 'I':
+            /* Reinício apaga os pids de todos: só com os pids todos desta conexão */
+            if (others_own(sv, c)) { reply(c, "E busy\n"); return; }
+            if (parse_ints(args, v, m) != m) { reply(c, "E args\n"); return; }
+            for (int j = 0; j < m; ++j) {
+                if (!rc_fits(v[j])) { reply(c, "E avail\n"); return; }
+            }
+            server_reset(sv, v);
+            reply(c, "K\n");
+            return;
+        case 'S':
+            cmd_stats(sv, c);
+            return;
+        case '\0': case '\r':
+            return;
+        default:
+            reply(c, "E op\n");
+            return;
+    }
+}
+
+/* Consome todas as linhas completas do buffer (um lote por leitura) */
+static void process_batch(Server *sv, Conn *c) {
+    size_t start = 0;
+    for (size_t i = 0; i < c->in_len; ++i) {
+        if (c->in[i] != '\n') continue;
+        c->in[i] = '\0';
+        handle_line(sv, c, c->in + start);
+        start = i + 1;
+    }
+    memmove(c->in, c->in + start, c->in_len - start);
+    c->in_len -= start;
+    sv->batches++;
+    sv->S->sim_clock++;
+}
+
+/* Lê o que houver; false = EOF/erro (fechar) */
+static bool conn_read(Server *sv, Conn *c) {
+    if (c->in_len == SRV_IN_CAP) return false;      /* linha gigante: descarta cliente */
+    ssize_t r = read(c->fd, c->in + c->in_len, SRV_IN_CAP - c->in_len);
+    if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return true;
+    if (r <= 0) return false;
+    c->in_len += (size_t)r;
+    process_batch(sv, c);
+    return true;
+}
+
+/* ============================
+ * Laços (stdin e socket)
+ * ============================ */
+
+static int serve_stdio(Server *sv) {
+    Conn *c = calloc(1, sizeof *c);
+    if (!c) return 1;
+    c->fd = STDIN_FILENO;
+    c->id = ++sv->next_conn;
+    while (!g_stop) {
+        if (!conn_read(sv, c)) break;
+        int in_fd = c->fd;
+        c->fd = STDOUT_FILENO;
+        bool ok = flush_out(c);
+        c->fd = in_fd;
+        if (!ok) break;
+    }
+    free(c->out);
+    free(c);
+    return 0;
+}
+
+static int listen_unix(const char *path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof addr.sun_path) { close(fd); return -1; }
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof addr) < 0 || listen(fd, SRV_BACKLOG) < 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+static int serve_socket(Server *sv, const char *path) {
+    int lfd = listen_unix(path);
+    if (lfd < 0) {
+        fprintf(stderr, "[serve] falha ao escutar em %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    size_t cap = 64, nconn = 0;
+    struct pollfd *pfd = malloc(cap * sizeof *pfd);
+    Conn **conn = malloc(cap * sizeof *conn);
+    if (!pfd || !conn) { free(pfd); free(conn); close(lfd); return 1; }
+    pfd[0].fd = lfd;
+    pfd[0].events = POLLIN;
+    conn[0] = NULL;
+    nconn = 1;
+
+    while (!g_stop) {
+        int k = poll(pfd, (nfds_t)nconn, -1);
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        /* Conexões novas */
+        if (pfd[0].revents & POLLIN) {
+            int cfd;
+            while ((cfd = accept(lfd, NULL, NULL)) >= 0) {
+                if (nconn == cap) {
+                    size_t nc = cap * 2;
+                    struct pollfd *np = realloc(pfd, nc * sizeof *np);
+                    if (np) pfd = np;
+                    Conn **nn = realloc(conn, nc * sizeof *nn);
+                    if (nn) conn = nn;
+                    if (!np || !nn) { close(cfd); break; }
+                    cap = nc;
+                }
+                Conn *c = calloc(1, sizeof *c);
+                if (!c) { close(cfd); break; }
+                fcntl(cfd, F_SETFL, fcntl(cfd, F_GETFL) | O_NONBLOCK);
+                c->fd = cfd;
+                c->id = ++sv->next_conn;
+                conn[nconn] = c;
+                pfd[nconn].fd = cfd;
+                pfd[nconn].events = POLLIN;
+                pfd[nconn].revents = 0;
+                nconn++;
+            }
+        }
+
+        /* Lotes: lê, decide e responde; remove fechadas compactando */
+        size_t w = 1;
+        for (size_t i = 1; i < nconn; ++i) {
+            Conn *c = conn[i];
+            bool alive = true;
+            short ev = pfd[i].revents;
+            if (ev & (POLLIN | POLLHUP | POLLERR)) alive = conn_read(sv, c);
+            if (alive && c->out_len) alive = flush_out(c);
+            if (!alive) {
+                conn_reap(sv, c);
+                close(c->fd);
+                free(c->out);
+                free(c);
+                continue;
+            }
+            pfd[i].events = (short)(POLLIN | (c->out_len ? POLLOUT : 0));
+            pfd[i].revents = 0;
+            pfd[w] = pfd[i];
+            conn[w] = c;
+            w++;
+        }
+        nconn = w;
+    }
+
+    for (size_t i = 1; i < nconn; ++i) {
+        close(conn[i]->fd);
+        free(conn[i]->out);
+        free(conn[i]);
+    }
+    free(pfd);
+    free(conn);
+    close(lfd);
+    unlink(path);
+    return 0;
+}
+
+int server_run(const ServerConfig *cfg) {
+    if (!cfg || !cfg->path || !cfg->policy || cfg->m < 1 || cfg->m > MAX_R) return 2;
+
+    Server *sv = calloc(1, sizeof *sv);       /* tabelas [MAX_P]: fora da pilha */
+    if (!sv) return 1;
+    sv->S = malloc(sizeof *sv->S);
+    if (!sv->S) { free(sv); return 1; }
+    sim_init(sv->S, 0, cfg->m, cfg->policy);
+    server_reset(sv, cfg->avail);
+
+    install_signals();
+    raise_fd_limit();
+
+    unsigned long long t0 = now_ns();
+    int rc = strcmp(cfg->path, "-") == 0 ? serve_stdio(sv) : serve_socket(sv, cfg->path);
+    double wall = (double)(now_ns() - t0) / 1e9;
+
+    if (cfg->metrics_path && !metrics_write_json(sv->S, cfg->metrics_path)) {
+        fprintf(stderr, "Falha ao escrever JSON: %s\n", cfg->metrics_path);
+    }
+    fprintf(stderr, "[serve] mode=%s decisions=%llu grants=%llu blocks=%llu aborts=%llu"
+                    " batches=%llu reaped=%llu avg_decision_ns=%llu wall_s=%.3f\n",
+            cfg->policy->label,
+            (unsigned long long)sv->decisions,
+            (unsigned long long)sv->S->metrics.grants,
+            (unsigned long long)sv->S->metrics.blocks,
+            (unsigned long long)sv->S->metrics.aborts,
+            (unsigned long long)sv->batches,
+            (unsigned long long)sv->reaped,
+            (unsigned long long)(sv->decisions ? sv->ns_deciding / sv->decisions : 0),
+            wall);
+    free(sv->S);
+    free(sv);
+    return rc;
+}
@@ -0,0 +1,497 @@
+/* ---------------------------------------------------------------------
+ * shard.c — Workers em processos separados + commit no pool compartilhado
+ *
+ * Invariante: cada shard decide com a política normal sobre o próprio
+ * escrow (Available local). Com o BANKER, cada shard fica seguro sobre o
+ * seu escrow, e a soma de sistemas seguros com pool >= 0 é segura: o
+ * safety global fica confirmado sem varrer os outros shards.
+ *
+ * Commit (só quando a decisão local nega): pega do pool, sob o mutex e
+ * tudo-ou-nada, o que falta para o pedido caber e decide de novo; se
+ * ainda negar, pega também o déficit que torna o shard seguro após a
+ * concessão (safe_deficit) e decide de novo; se negar, devolve. A cada
+ * rodada o que excede o necessário para continuar seguro volta ao pool.
+ * Um shard travado doa todo o livre e espera o pool mudar: quem pegar
+ * o déficit termina sozinho e devolve tudo, então o doador não fica sem
+ * saída. Se todos os ativos estão esperando, um processo cujo Need cabe
+ * no pool é escoltado até terminar (shard_rescue); sem nenhum, a
+ * execução acaba (stalled).
+ * --------------------------------------------------------------------- */
+#define _DEFAULT_SOURCE            /* MAP_ANONYMOUS, usleep */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "shard.h"
+#include "process.h"
+#include "policy.h"
+#include "timing.h"
+
+typedef struct ProcOut {
+    PState   state;
+    uint64_t finish_clock;
+    uint64_t arrival_clock;
+    uint64_t wait_time_acc;
+    uint64_t blocked_since;
+    uint64_t retries;
+    bool     waiting;
+    rc_t     Allocation[MAX_R];
+    rc_t     Need[MAX_R];
+} ProcOut;
+
+typedef struct ShardShared {
+    pthread_mutex_t lock;
+    uint64_t        gen;          /* muda a cada devolução ao pool */
+    int             active;       /* shards ainda rodando          */
+    int             waiting;      /* shards travados esperando     */
+    uint64_t        tried_gen;    /* geração em que 'tried' conta  */
+    int             tried;        /* resgates tentados nessa geração */
+    bool            stalled;
+    int             pool[MAX_R];  /* Available autoritativo (não reservado) */
+    ShardStat       stat[SHARD_MAX];
+    ProcOut         out[MAX_P];
+} ShardShared;
+
+/* Estado do worker (um por processo do SO) */
+static ShardShared  *g_sh;
+static const Policy *g_base;
+static Policy        g_shard_policy;
+static ShardStat    *g_stat;
+static uint64_t      g_deficit_fail_gen = UINT64_MAX;
+static uint64_t      g_rescued_gen = UINT64_MAX;
+static int           g_escort = -1;      /* pid local escoltado (resgate) */
+
+/* ============================
+ * Pool
+ * ============================ */
+
+/* O que entra e sai do pool muda as instâncias em posse do shard:
+   res_units acompanha, e o res_busy (res_units - Available) do
+   sim_advance_clock continua medindo só o que os processos seguram. */
+
+/* Pega 'want' do pool se couber inteiro */
+static bool pool_take(System *L, const int want[MAX_R]) {
+    int m = L->m;
+    bool any = false;
+    for (int j = 0; j < m; ++j) {
+        if (want[j] == 0) continue;
+        any = true;
+        if (__atomic_load_n(&g_sh->pool[j], __ATOMIC_RELAXED) < want[j]) return false;
+    }
+    if (!any) return false;
+
+    pthread_mutex_lock(&g_sh->lock);
+    for (int j = 0; j < m; ++j) {
+        if (g_sh->pool[j] < want[j]) {
+            pthread_mutex_unlock(&g_sh->lock);
+            return false;
+        }
+    }
+    for (int j = 0; j < m; ++j) g_sh->pool[j] -= want[j];
+    pthread_mutex_unlock(&g_sh->lock);
+
+    for (int j = 0; j < m; ++j) {
+        L->Available[j] = (rc_t)(L->Available[j] + want[j]);
+        L->metrics.res_units[j] += (uint64_t)want[j];
+    }
+    return true;
+}
+
+static void pool_give(System *L, const int give[MAX_R]) {
+    int m = L->m;
+    bool any = false;
+    for (int j = 0; j < m; ++j) {
+        if (give[j] == 0) continue;
+        any = true;
+        L->Available[j] = (rc_t)(L->Available[j] - give[j]);
+        L->metrics.res_units[j] -= (uint64_t)give[j];
+    }
+    if (!any) return;
+    sys_env_invalidate(L);             /* Available encolheu fora do sys_grant */
+    pthread_mutex_lock(&g_sh->lock);
+    for (int j = 0; j < m; ++j) g_sh->pool[j] += give[j];
+    g_sh->gen++;
+    pthread_mutex_unlock(&g_sh->lock);
+    g_stat->returns++;
+}
+
+/*
+ * Quanto o shard precisa ter a mais para ficar seguro partindo de 'work':
+ * redução gulosa que, a cada passo, termina o processo vivo de menor
+ * déficit total e soma esse déficit em D. Com work + D a ordem gulosa
+ * termina todos, então o estado fica seguro (cota superior do mínimo).
+ * Se P != NULL, considera P já com 'req' concedido. O(k²·m).
+ */
+static void safe_deficit(const System *L, const int work0[MAX_R],
+                         const Process *P, const int req[MAX_R], int D[MAX_R]) {
+    int m = L->m, n = L->n;
+    int work[MAX_R];
+    bool *done = calloc((size_t)n + 1, sizeof *done);
+    for (int j = 0; j < m; ++j) { work[j] = work0[j]; D[j] = 0; }
+    if (!done) {                                 /* sem memória: pede a soma de Need */
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < m; ++j) D[j] += L->procs[i].Need[j];
+        return;
+    }
+
+    for (;;) {
+        int best = -1;
+        long long best_def = 0;
+        for (int i = 0; i < n; ++i) {
+            const Process *q = &L->procs[i];
+            if (done[i] || q->state == P_FINISHED) continue;
+            long long def = 0;
+            for (int j = 0; j < m; ++j) {
+                int need = q->Need[j] - (q == P ? req[j] : 0);
+                if (need > work[j]) def += need - work[j];
+            }
+            if (best < 0 || def < best_def) { best = i; best_def = def; }
+            if (def == 0) break;
+        }
+        if (best < 0) break;
+        const Process *q = &L->procs[best];
+        for (int j = 0; j < m; ++j) {
+            int need = q->Need[j] - (q == P ? req[j] : 0);
+            if (need > work[j]) { D[j] += need - work[j]; work[j] = need; }
+            work[j] += q->Allocation[j] + (q == P ? req[j] : 0);
+        }
+        done[best] = true;
+    }
+    free(done);
+}
+
+/* ============================
+ * Política do shard (envolve a base)
+ * ============================ */
+
+static bool try_with(System *L, Process *P, const int req[MAX_R], const int want[MAX_R]) {
+    if (!pool_take(L, want)) return false;
+    if (g_base->on_request(L, P, req)) {
+        g_stat->commits++;
+        return true;
+    }
+    g_stat->aborted++;
+    pool_give(L, want);
+    return false;
+}
+
+static bool shard_on_request(System *L, Process *P, const int req[MAX_R]) {
+    if (P->id == g_escort) {                          /* reserva já cobre Need */
+        if (!req_within_bounds(L, P, req)) return false;
+        return sys_grant(L, P, req);
+    }
+    if (g_base->on_request(L, P, req)) return true;
+    if (P->state != P_RUNNING) return false;          /* abortado pela base */
+
+    /* 1) Só o que falta para o pedido caber (basta sem safety) */
+    int want[MAX_R], work[MAX_R] = {0}, D[MAX_R];
+    for (int j = 0; j < L->m; ++j) {
+        int gap = req[j] - L->Available[j];
+        want[j] = gap > 0 ? gap : 0;
+    }
+    if (try_with(L, P, req, want)) return true;
+
+    /* 2) Mais o déficit que deixa o shard seguro após a concessão.
+          Caro (O(k²·m)): não repete enquanto o pool não mudar. */
+    uint64_t gen = __atomic_load_n(&g_sh->gen, __ATOMIC_RELAXED);
+    if (gen == g_deficit_fail_gen) return false;
+    for (int j = 0; j < L->m; ++j) work[j] = L->Available[j] + want[j] - req[j];
+    safe_deficit(L, work, P, req, D);
+    for (int j = 0; j < L->m; ++j) want[j] += D[j];
+    if (try_with(L, P, req, want)) return true;
+    g_deficit_fail_gen = gen;
+    return false;
+}
+
+static void shard_on_release(System *L, Process *P) {
+    if (P->id == g_escort) g_escort = -1;
+    if (g_base->on_release) g_base->on_release(L, P);
+}
+
+/* Fim de rodada: devolve o que excede o necessário para continuar seguro
+   (o déficit guloso partindo de Available = 0) */
+static void shard_on_tick(System *L) {
+    int zero[MAX_R] = {0}, keep[MAX_R], give[MAX_R];
+    bool any = false;
+    for (int j = 0; j < L->m; ++j) any = any || L->Available[j] > 0;
+    if (any) {
+        safe_deficit(L, zero, NULL, zero, keep);
+        for (int j = 0; j < L->m; ++j) {
+            int s = L->Available[j] - keep[j];
+            give[j] = s > 0 ? s : 0;
+        }
+        pool_give(L, give);
+    }
+    if (g_base->on_tick) g_base->on_tick(L);
+}
+
+typedef enum WaitResult { WAIT_WAKE, WAIT_RESCUE, WAIT_STALL } WaitResult;
+
+/*
+ * Travado: espera o pool mudar. Se todos os ativos estão esperando, cada
+ * shard tem uma chance de resgate por geração do pool (ver
+ * shard_rescue); se todos tentaram sem mudar o pool, a execução acaba.
+ */
+static WaitResult wait_for_pool(void) {
+    WaitResult res = WAIT_WAKE;
+    pthread_mutex_lock(&g_sh->lock);
+    uint64_t g = g_sh->gen;
+    g_sh->waiting++;
+    for (;;) {
+        if (g_sh->gen != g) break;
+        if (g_sh->stalled) { res = WAIT_STALL; break; }
+        if (g_sh->waiting == g_sh->active) {
+            if (g_sh->tried_gen != g) { g_sh->tried_gen = g; g_sh->tried = 0; }
+            if (g_rescued_gen != g) {
+                g_rescued_gen = g;
+                g_sh->tried++;
+                res = WAIT_RESCUE;
+                break;
+            }
+            if (g_sh->tried >= g_sh->active) {
+                g_sh->stalled = true;
+                res = WAIT_STALL;
+                break;
+            }
+        }
+        pthread_mutex_unlock(&g_sh->lock);
+        usleep(50);
+        pthread_mutex_lock(&g_sh->lock);
+    }
+    g_sh->waiting--;
+    pthread_mutex_unlock(&g_sh->lock);
+    return res;
+}
+
+/*
+ * Resgate (todos travados): o pool tem todo o livre do sistema. Se o
+ * estado global é seguro, algum processo tem Need <= pool; o shard que o
+ * tiver reserva Need - Available para ele e o escolta: os pedidos dele
+ * são concedidos sem o safety local (que está inseguro após a doação),
+ * pois a reserva garante que ele termina sozinho e devolve tudo.
+ */
+static bool shard_rescue(System *L) {
+    int best = -1;
+    long long best_sum = 0;
+    int want[MAX_R] = {0};
+    for (int i = 0; i < L->n; ++i) {
+        const Process *p = &L->procs[i];
+        if (p->state == P_FINISHED) continue;
+        long long sum = 0;
+        bool fits = true;
+        for (int j = 0; j < L->m && fits; ++j) {
+            int gap = p->Need[j] - L->Available[j];
+            if (gap <= 0) continue;
+            fits = gap <= __atomic_load_n(&g_sh->pool[j], __ATOMIC_RELAXED);
+            sum += gap;
+        }
+        if (fits && (best < 0 || sum < best_sum)) { best = i; best_sum = sum; }
+    }
+    if (best < 0) return false;
+    const Process *p = &L->procs[best];
+    for (int j = 0; j < L->m; ++j) {
+        int gap = p->Need[j] - L->Available[j];
+        want[j] = gap > 0 ? gap : 0;
+    }
+    if (best_sum > 0 && !pool_take(L, want)) return false;
+    g_escort = best;
+    g_stat->rescues++;
+    return true;
+}
+
+/* ============================
+ * Worker
+ * ============================ */
+
+static void shard_worker(const System *S, int s, int lo, int hi) {
+    int ns = hi - lo, m = S->m;
+    g_stat = &g_sh->stat[s];
+    g_stat->procs = ns;
+
+    System *L = malloc(sizeof *L);
+    size_t rows = ns > 0 ? (size_t)ns : 1;
+    int (*maxs)[MAX_R]   = calloc(rows, sizeof *maxs);
+    int (*allocs)[MAX_R] = calloc(rows, sizeof *allocs);
+    struct ReqList **scripts = calloc(rows, sizeof *scripts);
+    if (!L || !maxs || !allocs || !scripts || ns <= 0) {
+        pthread_mutex_lock(&g_sh->lock);
+        g_sh->active--;
+        pthread_mutex_unlock(&g_sh->lock);
+        g_stat->ok = ns <= 0;
+        return;
+    }
+
+    g_shard_policy = *g_base;
+    g_shard_policy.on_request      = shard_on_request;
+    g_shard_policy.on_tick         = shard_on_tick;
+    g_shard_policy.on_release      = shard_on_release;
+    g_shard_policy.detect_on_stall = false;   /* travar aqui não é deadlock global */
+
+    for (int i = 0; i < ns; ++i) {
+        const Process *p = &S->procs[lo + i];
+        for (int j = 0; j < m; ++j) {
+            maxs[i][j]   = p->Max[j];
+            allocs[i][j] = p->Allocation[j];
+        }
+        scripts[i] = p->script;
+    }
+    int zero[MAX_R] = {0};
+    sim_init(L, ns, m, &g_shard_policy);
+    sched_init(&L->sched, S->sched.kind, S->sched.seed + (uint64_t)s);
+    sys_load_from_arrays(L, zero, (const int (*)[MAX_R])maxs,
+                         (const int (*)[MAX_R])allocs, scripts);
+    for (int i = 0; i < ns; ++i) L->procs[i].prio = S->procs[lo + i].prio;
+
+    unsigned long long t0 = now_ns();
+    for (;;) {
+        sim_run(L);
+        if (L->n_finished >= ns) break;
+
+        /* Travado: doa todo o livre (o shard fica inseguro até pegar de
+           volta o déficit num commit) e espera alguém devolver algo */
+        int give[MAX_R] = {0};
+        for (int j = 0; j < m; ++j) give[j] = L->Available[j];
+        pool_give(L, give);
+        g_deficit_fail_gen = UINT64_MAX;
+        WaitResult w;
+        while ((w = wait_for_pool()) == WAIT_RESCUE && !shard_rescue(L)) {}
+        if (w == WAIT_STALL) break;
+    }
+    g_stat->wall_s = (double)(now_ns() - t0) / 1e9;
+
+    /* Devolve tudo que está livre e publica resultados */
+    int give[MAX_R] = {0};
+    for (int j = 0; j < m; ++j) give[j] = L->Available[j];
+    pthread_mutex_lock(&g_sh->lock);
+    for (int j = 0; j < m; ++j) g_sh->pool[j] += give[j];
+    g_sh->gen++;
+    g_sh->active--;
+    pthread_mutex_unlock(&g_sh->lock);
+
+    for (int i = 0; i < ns; ++i) {
+        ProcOut *o = &g_sh->out[lo + i];
+        const Process *p = &L->procs[i];
+        o->state         = p->state;
+        o->finish_clock  = p->finish_clock;
+        o->arrival_clock = p->arrival_clock;
+        o->wait_time_acc = p->wait_time_acc;
+        o->blocked_since = p->blocked_since;
+        o->retries       = p->retries;
+        o->waiting       = p->waiting;
+        memcpy(o->Allocation, p->Allocation, sizeof o->Allocation);
+        memcpy(o->Need, p->Need, sizeof o->Need);
+    }
+    g_stat->metrics   = L->metrics;
+    g_stat->sim_clock = L->sim_clock;
+    g_stat->ok        = true;
+
+    free(L); free(maxs); free(allocs); free(scripts);
+}
+
+/* ============================
+ * Coordenador
+ * ============================ */
+
+bool shard_run(System *S, int shards, ShardResult *out) {
+    if (!S || !out || shards < 1) return false;
+    if (shards > SHARD_MAX) shards = SHARD_MAX;
+    if (shards > S->n) shards = S->n;
+    memset(out, 0, sizeof *out);
+    out->shards = shards;
+
+    ShardShared *sh = mmap(NULL, sizeof *sh, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (sh == MAP_FAILED) return false;
+    memset(sh, 0, sizeof *sh);
+
+    pthread_mutexattr_t ma;
+    pthread_mutexattr_init(&ma);
+    pthread_mutexattr_setpshared(&ma, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&sh->lock, &ma);
+    pthread_mutexattr_destroy(&ma);
+    /* Instâncias do sistema inteiro: os shards só veem o que têm em mãos */
+    uint64_t units[MAX_R];
+    for (int j = 0; j < S->m; ++j) {
+        sh->pool[j] = S->Available[j];
+        units[j] = (uint64_t)S->Available[j];
+        for (int i = 0; i < S->n; ++i) units[j] += (uint64_t)S->procs[i].Allocation[j];
+    }
+    sh->active = shards;
+
+    g_sh   = sh;
+    g_base = S->policy;
+    fflush(NULL);                      /* nada bufferizado duplicado nos filhos */
+
+    unsigned long long t0 = now_ns();
+    pid_t pids[SHARD_MAX];
+    int started = 0;
+    for (int s = 0; s < shards; ++s) {
+        int lo = (int)((long long)S->n * s / shards);
+        int hi = (int)((long long)S->n * (s + 1) / shards);
+        pid_t pid = fork();
+        if (pid == 0) {
+            shard_worker(S, s, lo, hi);
+            _exit(0);
+        }
+        if (pid < 0) {
+            pthread_mutex_lock(&sh->lock);
+            sh->active -= shards - s;   /* os que não nasceram não esperam */
+            pthread_mutex_unlock(&sh->lock);
+            break;
+        }
+        pids[started++] = pid;
+    }
+    for (int k = 0; k < started; ++k) waitpid(pids[k], NULL, 0);
+    out->wall_s = (double)(now_ns() - t0) / 1e9;
+
+    /* Junta resultados no System do coordenador */
+    bool ok = started == shards;
+    metrics_reset(&S->metrics);
+    S->sim_clock = 0;
+    for (int s = 0; s < shards; ++s) {
+        out->stat[s] = sh->stat[s];
+        ok = ok && sh->stat[s].ok;
+        metrics_merge(&S->metrics, &sh->stat[s].metrics);
+        if (sh->stat[s].sim_clock > S->sim_clock) S->sim_clock = sh->stat[s].sim_clock;
+    }
+    for (int j = 0; j < S->m; ++j) S->metrics.res_units[j] = units[j];
+    S->n_finished = 0;
+    for (int i = 0; i < S->n; ++i) {
+        Process *p = &S->procs[i];
+        const ProcOut *o = &sh->out[i];
+        p->state         = o->state;
+        p->finish_clock  = o->finish_clock;
+        p->arrival_clock = o->arrival_clock;
+        p->wait_time_acc = o->wait_time_acc;
+        p->blocked_since = o->blocked_since;
+        p->retries       = o->retries;
+        p->waiting       = o->waiting;
+        memcpy(p->Allocation, o->Allocation, sizeof p->Allocation);
+        memcpy(p->Need, o->Need, sizeof p->Need);
+        if (p->state == P_FINISHED) {
+            S->n_finished++;
+            for (int j = 0; j < S->m; ++j) p->Max[j] = 0;
+        }
+    }
+    for (int j = 0; j < S->m; ++j) S->Available[j] = (rc_t)sh->pool[j];
+    out->stalled = sh->stalled || S->n_finished < S->n;
+
+    pthread_mutex_destroy(&sh->lock);
+    munmap(sh, sizeof *sh);
+    return ok;
+}
+
+void shard_print_summary(const ShardResult *r, FILE *f) {
+    uint64_t req = 0, commits = 0, aborted = 0;
+    for (int s = 0; s < r->shards; ++s) {
+        req     += r->stat[s].metrics.total_requests;
+        commits += r->stat[s].commits;
+        aborted += r->stat[s].aborted;
+    }
+    fprintf(f, " | shards=%d commits=%llu commit_fail=%llu stalled=%d wall_s=%.3f req_per_s=%.0f",
+            r->shards, (unsigned long long)commits, (unsigned long long)aborted,
+            r->stalled ? 1 : 0, r->wall_s,
+            r->wall_s > 0.0 ? (double)req / r->wall_s : 0.0);
+}
@@ -3,22 +3,41 @@
  * Simulador do sistema de gerenciamento de processos.
  */
 #include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 #include "simulator.h"
 #include "process.h"
 #include "detector.h"
+#include "policy.h"
+#include "flight.h"
+#include "coroutine.h"
+#include "trace.h"
+#include "stats.h"
 
 /*
  * sim_init
  * Inicializa o simulador: preparar o sistema do zero, com contadores zerados e processos resetados.
  */
-void sim_init(System *s, int n, int m, Mode mode) {
+void sim_init(System *s, int n, int m, const struct Policy *policy) {
     if (s == NULL) return;
     s->n = n;
     s->m = m;
-    s->mode = mode;
+    s->policy = policy;
     s->sim_clock = 0;
+    s->holders_valid = false;
+    s->env_gen = s->env_floor = 0;
+    memset(s->env_comp, 0, sizeof s->env_comp);
+    sys_need_invalidate(s);
+    s->n_finished = 0;
+    s->fault = NULL;
+    s->detect_cfg = (DetectConfig){ DET_STALL, 16, 0.5 };
+    s->ev_cfg = (EventConfig){ ENGINE_TICK, { DIST_CONST, 0.0, 0.0 }, { DIST_CONST, 1.0, 0.0 }, 0 };
+    memset(&s->detect_st, 0, sizeof s->detect_st);
+    part_reset(&s->part);
 
     metrics_reset(&s->metrics);
+    sched_init(&s->sched, SK_INDEX, 0);
 
     for (int j = 0; j < MAX_R; j++) {
         s->Available[j] = 0;
@@ -32,13 +51,20 @@ void sim_init(System *s, int n, int m, Mode mode) {
 
 /*
  * sim_reset
- * Limpa os recursos utilizados pelo simulador: limpar estado de execução preservando a configuração (n, m, mode).
+ * Limpa os recursos utilizados pelo simulador: limpar estado de execução preservando a configuração (n, m, policy).
  */
 void sim_reset(System *s) {
     if ( s == NULL ) return;
     s->sim_clock = 0;
+    s->holders_valid = false;
+    sys_need_invalidate(s);
+    s->n_finished = 0;
+    s->fault = NULL;
+    memset(&s->detect_st, 0, sizeof s->detect_st);
+    part_reset(&s->part);
 
     metrics_reset(&s->metrics);
+    sched_init(&s->sched, s->sched.kind, s->sched.seed);
     for (int j = 0; j < MAX_R; j++) {
         s->Available[j] = 0;
     }
@@ -50,7 +76,7 @@ void sim_reset(System *s) {
 
 /*
  * sim_finalize
- * Limpa os recursos utilizados pelo simulador: limpar estado de execução preservando a configuração (n, m, mode).
+ * Limpa os recursos utilizados pelo simulador: limpar estado de execução preservando a configuração (n, m, policy).
  */
 void sim_finalize(System *s) {
     if (s == NULL) return;
@@ -67,7 +93,7 @@ bool sys_invariants_ok(const System *s){
 
     // Available não-negativo
     for (int j = 0; j < s->m; j++) {
-        if (s->Available[j] < 0) return false;
+        if (!rc_fits(s->Available[j])) return false;
     }
 
     for (int j = s->m; j < MAX_R; j++) {
@@ -103,9 +129,9 @@ bool sys_invariants_ok(const System *s){
  */
 void sys_load_from_arrays(System *s,
                           const int available0[MAX_R],
-                          const int maxs[MAX_P][MAX_R],
-                          const int allocs[MAX_P][MAX_R],
-                          struct ReqList *scripts[MAX_P])
+                          const int maxs[][MAX_R],      /* s->n linhas */
+                          const int allocs[][MAX_R],
+                          struct ReqList *scripts[])
 {
     assert(s != NULL);
     /* n e m devem ter sido definidos antes em sim_init */
@@ -114,13 +140,24 @@ void sys_load_from_arrays(System *s,
 
     /* ---- Available ---- */
     for (int j = 0; j < s->m; ++j) {
-        s->Available[j] = (available0 ? available0[j] : 0);
+        int a = available0 ? available0[j] : 0;
+        assert(rc_fits(a) && "Available fora da faixa de rc_t (veja RC_BITS)");
+        s->Available[j] = (rc_t)a;
     }
 
     for (int j = s->m; j < MAX_R; ++j) {
         s->Available[j] = 0;
     }
 
+    /* Total de instâncias por recurso precisa caber em rc_t:
+       garante que liberar alocações nunca estoura Available. */
+    for (int j = 0; j < s->m; ++j) {
+        long long total = s->Available[j];
+        for (int i = 0; i < s->n; ++i) total += allocs ? allocs[i][j] : 0;
+        assert(rc_fits(total) && "total de instancias excede RC_MAX (veja RC_BITS)");
+        (void)total;
+    }
+
     /* ---- Processos ativos 0..n-1 ---- */
     for (int i = 0; i < s->n; ++i) {
         Process *p = &s->procs[i];
@@ -130,8 +167,12 @@ void sys_load_from_arrays(System *s,
 
         /* Copiar Max/Allocation até m-1; manter zeros no restante */
         for (int j = 0; j < s->m; ++j) {
-            p->Max[j]        = maxs   ? maxs[i][j]   : 0;
-            p->Allocation[j] = allocs ? allocs[i][j] : 0;
+            int mx = maxs   ? maxs[i][j]   : 0;
+            int al = allocs ? allocs[i][j] : 0;
+            assert(rc_fits(mx) && rc_fits(al) && "Max/Allocation fora da faixa de rc_t");
+            p->Max[j]        = (rc_t)mx;
+            p->Allocation[j] = (rc_t)al;
+            p->Init[j]       = (rc_t)al;
         }
         for (int j = s->m; j < MAX_R; ++j) {
             p->Max[j]        = 0;
@@ -155,26 +196,184 @@ void sys_load_from_arrays(System *s,
            s->procs[i].state = P_FINISHED; */
     }
 
+    s->holders_valid = false;
+    sys_need_invalidate(s);
+    s->n_finished = 0;
+    part_build(s);
+
     assert(sys_invariants_ok(s) && "invariantes globais violadas apos load");
 }
 
 
+/*
+ * sim_clone
+ * Cópia barata para rodar várias simulações do mesmo cenário: copia o
+ * cabeçalho, só os n processos ativos e o que vem depois da tabela,
+ * exceto as filas (o destino recebe um escalonador vazio do mesmo tipo).
+ */
+void sim_clone(System *dst, const System *src) {
+    if (!dst || !src || dst == src) return;
+    memcpy(dst, src, offsetof(System, procs));
+    memcpy(dst->procs, src->procs, (size_t)src->n * sizeof(Process));
+    memcpy((char *)dst + offsetof(System, policy),
+           (const char *)src + offsetof(System, policy),
+           offsetof(System, sched) - offsetof(System, policy));
+    sched_init(&dst->sched, src->sched.kind, src->sched.seed);
+    dst->bits.valid = false;
+    dst->cg.valid = false;
+    dst->env_gen = dst->env_floor = 0;
+    memset(dst->env_comp, 0, sizeof dst->env_comp);
+}
+
+void sim_metrics_begin(System *S) {
+    sys_need_invalidate(S);
+    for (int j = 0; j < S->m; ++j) {
+        uint64_t units = (uint64_t)S->Available[j];
+        for (int i = 0; i < S->n; ++i) units += (uint64_t)S->procs[i].Allocation[j];
+        if (units > S->metrics.res_units[j]) S->metrics.res_units[j] = units;
+    }
+}
+
+void sim_advance_clock(System *S, uint64_t to) {
+    if (to <= S->sim_clock) return;
+    uint64_t dt = to - S->sim_clock;
+    for (int j = 0; j < S->m; ++j) {
+        uint64_t units = S->metrics.res_units[j], avail = (uint64_t)S->Available[j];
+        if (units > avail) S->metrics.res_busy[j] += (units - avail) * dt;
+    }
+    S->sim_clock = to;
+    trace_available(S);
+    stats_publish(S);
+}
+
 /* Liberação simplificada (essa já é útil de verdade) */
 void release_all_resources(System *S, Process *P) {
     if (!S || !P) return;
     for (int j = 0; j < S->m; ++j) {
-        S->Available[j] += P->Allocation[j];
+        /* não estoura: o load garante total de instâncias <= RC_MAX */
+        bool ok = rc_add(&S->Available[j], P->Allocation[j]);
+        assert(ok && "overflow em Available ao liberar");
+        if (!ok) S->Available[j] = RC_MAX;
         P->Allocation[j] = 0;
+        rc_t old_need    = P->Need[j];
         P->Need[j]       = 0;   /* ou: recompute depois com proc_compute_need(P) */
         P->Max[j]        = 0;
+        sys_cell_changed(S, P, j, old_need);
     }
 }
 
-bool handle_request_current_mode(System *S, Process *P, const int req[MAX_R]);
-void release_all_resources(System *S, Process *P);
-//void enqueue_ready(int pid);
-//void enqueue_blocked(int pid);
-//int  blocked_count(void);
+/* Termina P: avisa a política, devolve tudo e marca FINISHED.
+   O relógio só avança no fim da rodada: quem termina nela conta sim_clock+1. */
+void sim_finish_process(System *S, Process *p) {
+    proc_end_wait(p, S->sim_clock);
+    if (S->policy->on_release) S->policy->on_release(S, p);
+    release_all_resources(S, p);
+    part_remove(S, p->id);
+    p->state = P_FINISHED;
+    p->finish_clock = S->sim_clock + 1;
+    S->n_finished++;
+}
+
+/*
+ * sim_abort_process
+ * Rollback completo de P (wait-die/wound-wait/ordered): devolve a alocação,
+ * volta ao início do roteiro com Need = Max e fica READY para recomeçar.
+ * O roteiro só cobre Max - Init: se P começou com alocação de carga, o
+ * primeiro passo do recomeço é pedi-la de novo (init_pending).
+ */
+void sim_abort_process(System *S, Process *p) {
+    if (!S || !p || p->state == P_FINISHED) return;
+
+    rc_t keep[MAX_R];
+    for (int j = 0; j < S->m; ++j) keep[j] = p->Max[j];
+
+    if (S->policy->on_release) S->policy->on_release(S, p);
+    release_all_resources(S, p);
+
+    for (int j = 0; j < S->m; ++j) p->Max[j] = keep[j];
+    proc_compute_need(p);
+    for (int j = 0; j < S->m; ++j) sys_cell_changed(S, p, j, 0);
+    reqlist_rewind(p->script);
+    if (p->co) co_reset(p->co);
+    proc_end_wait(p, S->sim_clock);    /* comportamento recomeça do início */
+
+    S->metrics.aborts++;
+    S->metrics.wasted_grants += p->grants_since_start;
+    p->grants_since_start = 0;
+    p->aborts++;
+    p->restarted = true;
+    p->reacq_pending = false;
+    for (int j = 0; j < S->m; ++j) p->reacq[j] = 0;
+    p->init_pending = false;
+    for (int j = 0; j < S->m; ++j) p->init_pending = p->init_pending || p->Init[j] > 0;
+    p->in_deadlock = false;
+    p->state = P_READY;
+    sched_push_ready(S, p);
+    trace_state(S, p);
+}
+
+/*
+ * Passo de um processo com comportamento: retoma a corrotina até a
+ * próxima cessão e aplica o que ela pediu. Um pedido negado espera em
+ * BLOCKED (sweep_blocked repete t->req); compute(t) deixa P RUNNING,
+ * fora das filas, até o timer acordá-lo. Retorna true se P terminou.
+ */
+static bool co_step_handle_process(System *S, Process *p) {
+    CoTask *t = p->co;
+    p->state = P_RUNNING;
+    if (p->init_pending) {                  /* restart: readquire a carga antes */
+        int req[MAX_R];
+        (void)proc_peek_request(p, req);
+        if (handle_request_current_mode(S, p, req)) {
+            proc_pop_request(p);
+            p->state = P_READY;
+            sched_push_ready(S, p);
+        } else if (p->state == P_RUNNING) {
+            p->state = P_BLOCKED;
+            p->blocked_since = S->sim_clock;
+            sched_push_blocked(S, p);
+        }
+        return false;
+    }
+    switch (co_resume(S, p, t)) {
+        case CO_OP_REQUEST:
+            if (handle_request_current_mode(S, p, t->req)) {
+                t->granted = true;
+                p->state = P_READY;
+                sched_push_ready(S, p);
+            } else if (p->state == P_RUNNING) {
+                p->state = P_BLOCKED;
+                p->blocked_since = S->sim_clock;
+                sched_push_blocked(S, p);
+            }
+            return false;
+
+        case CO_OP_RELEASE: {
+            /* devolve no máximo o que detém (Need volta a crescer) */
+            int rel[MAX_R] = {0};
+            for (int j = 0; j < S->m; ++j) {
+                int r = t->req[j];
+                rel[j] = r < 0 ? 0 : (r > p->Allocation[j] ? p->Allocation[j] : r);
+            }
+            (void)sys_rollback(S, p, rel);
+            S->holders_valid = false;
+            S->metrics.partial_releases++;
+            p->state = P_READY;
+            sched_push_ready(S, p);
+            return false;
+        }
+
+        case CO_OP_COMPUTE:
+            co_sleep(p, S->sim_clock + t->wake);
+            return false;
+
+        case CO_OP_START:
+        case CO_OP_EXIT:
+        default:
+            sim_finish_process(S, p);
+            return true;
+    }
+}
 
 /*
  * Processa um processo por um "passo" de simulação.
@@ -183,129 +382,165 @@ void release_all_resources(System *S, Process *P);
 bool sim_step_handle_process(System *S, Process *p) {
     int req[MAX_R] = {0};
 
+    if (p->co) return co_step_handle_process(S, p);
+
     /* 1) Sem roteiro → termina e libera tudo */
-    if (p->script == NULL || reqlist_empty(p->script)) {
-        release_all_resources(S, p);
-        p->state = P_FINISHED;
+    if (proc_script_done(p)) {
+        sim_finish_process(S, p);
         return true;
     }
 
-    /* 2) Lê a próxima requisição sem consumir */
-    if (!reqlist_peek(p->script, req)) {
+    /* 2) Lê a próxima requisição sem consumir (após restart: a carga) */
+    if (!proc_peek_request(p, req)) {
         /* Roteiro inconsistente: trate como fim */
-        release_all_resources(S, p);
-        p->state = P_FINISHED;
+        sim_finish_process(S, p);
         return true;
     }
 
-    /* 3) Pede concessão conforme o modo atual (Ostrich/Banker) */
+    /* 3) Pede concessão conforme a política atual.
+          RUNNING durante a decisão: se a política abortar P, ele volta READY. */
+    p->state = P_RUNNING;
     bool granted = handle_request_current_mode(S, p, req);
 
     if (granted) {
         /* 4a) Avança o roteiro */
-        (void)reqlist_pop(p->script);
+        proc_pop_request(p);
 
         /* 4b) Se acabou o roteiro, termina liberando tudo */
-        if (reqlist_empty(p->script)) {
-            release_all_resources(S, p);
-            p->state = P_FINISHED;
+        if (proc_script_done(p)) {
+            sim_finish_process(S, p);
             return true;
         }
 
         /* 4c) Ainda tem requisições → volta para READY */
         p->state = P_READY;
-        //enqueue_ready(p->id);
+        sched_push_ready(S, p);
         return false;
     } else {
-        /* 4d) Não concedido → vai para BLOCKED */
-        p->state = P_BLOCKED;
-        //enqueue_blocked(p->id);
-        //(void)blocked_count();  /* útil para métricas/log, se quiser */
+        /* 4d) Não concedido → vai para BLOCKED (salvo se foi abortado) */
+        if (p->state == P_RUNNING) {
+            p->state = P_BLOCKED;
+            p->blocked_since = S->sim_clock;
+            sched_push_blocked(S, p);
+        }
         return false;
     }
 }
 
 /* ------------------------------------------------------------- */
-/* Varre todos os processos BLOQUEADOS e tenta a MESMA req de novo.
- * Retorna true se pelo menos um processo mudou de estado (desbloqueou
- * ou terminou).
+/* Varre a fila de BLOQUEADOS (na ordem do escalonador) e tenta a
+ * MESMA req de novo. Quem continua bloqueado volta para a fila da
+ * próxima rodada. sweep_one trata um processo e retorna true se ele
+ * mudou de estado (desbloqueou, terminou ou foi abortado); a varredura
+ * retorna true se pelo menos um mudou.
  * ------------------------------------------------------------- */
-static bool sweep_blocked(System *S) {
-    bool progress = false;
-    int  req[MAX_R];
-
-    for (int i = 0; i < S->n; ++i) {
-        Process *p = &S->procs[i];
-        if (p->state != P_BLOCKED) continue;
-
-        /* Se não há roteiro, finalize por segurança */
-        if (p->script == NULL || reqlist_empty(p->script)) {
-            release_all_resources(S, p);
-            p->state = P_FINISHED;
-            progress = true;
-            continue;
+static bool sweep_one(System *S, Process *p) {
+    int req[MAX_R];
+
+    /* Corrotina: repete o pedido pendente; concedido → READY */
+    if (p->co) {
+        (void)proc_peek_request(p, req);
+        p->state = P_RUNNING;
+        if (handle_request_current_mode(S, p, req)) {
+            proc_pop_request(p);
+            p->state = P_READY;
+            sched_push_ready(S, p);
+            return true;
         }
+        if (p->state != P_RUNNING) return true;   /* abortado */
+        p->state = P_BLOCKED;
+        sched_push_blocked(S, p);
+        return false;
+    }
 
-        /* Tenta novamente a requisição atual */
-        if (!reqlist_peek(p->script, req)) {
-            /* Roteiro inconsistente → finalize */
-            release_all_resources(S, p);
-            p->state = P_FINISHED;
-            progress = true;
-            continue;
-        }
+    /* Se não há roteiro, finalize por segurança */
+    if (proc_script_done(p)) {
+        sim_finish_process(S, p);
+        return true;
+    }
 
-        bool granted = handle_request_current_mode(S, p, req);
-        if (granted) {
-            (void)reqlist_pop(p->script);
+    /* Tenta novamente a requisição atual */
+    if (!proc_peek_request(p, req)) {
+        /* Roteiro inconsistente → finalize */
+        sim_finish_process(S, p);
+        return true;
+    }
 
-            if (reqlist_empty(p->script)) {
-                release_all_resources(S, p);
-                p->state = P_FINISHED;
-            } else {
-                p->state = P_READY;
-            }
-            progress = true;
+    p->state = P_RUNNING;
+    bool granted = handle_request_current_mode(S, p, req);
+    if (granted) {
+        proc_pop_request(p);
+
+        if (proc_script_done(p)) {
+            sim_finish_process(S, p);
+        } else {
+            p->state = P_READY;
+            sched_push_ready(S, p);
         }
-        /* senão, continua BLOQUEADO */
+        return true;
     }
-
-    return progress;
+    if (p->state != P_RUNNING) return true;   /* abortado: recomeça READY */
+    p->state = P_BLOCKED;                      /* continua BLOQUEADO */
+    sched_push_blocked(S, p);
+    return false;
 }
 
-/* ------------------------------------------------------------- */
-/* Retorna true se TODOS os processos 0..n-1 estão FINISHED      */
-/* ------------------------------------------------------------- */
-static bool all_finished(const System *S) {
-    for (int i = 0; i < S->n; ++i) {
-        if (S->procs[i].state != P_FINISHED) return false;
+static bool sweep_blocked(System *S) {
+    bool progress = false;
+    int  pid;
+
+    sched_begin_sweep(&S->sched);
+    while ((pid = sched_pop_sweep(S)) >= 0) {
+        Process *p = &S->procs[pid];
+        if (p->state != P_BLOCKED) continue;   /* abortado enquanto na fila */
+        if (sweep_one(S, p)) progress = true;
+        trace_state(S, p);
     }
-    return true;
+
+    return progress;
 }
 
 /* ------------------------------------------------------------- */
-/* Loop de simulação mínimo (sem filas): varre READY, tenta passos,
- * tenta desbloquear bloqueados e avança o relógio.
+/* Loop de simulação: a cada rodada visita os READY na ordem do
+ * escalonador (--sched), tenta desbloquear os bloqueados e avança
+ * o relógio. Termina quando as filas esvaziam (todos FINISHED).
  * Para evitar loop infinito quando nada muda (tudo bloqueado),
  * paramos se não houver progresso em uma rodada completa.
  * ------------------------------------------------------------- */
 void sim_run(System *S) {
     if (!S) return;
+    void (*on_tick)(System *) = S->policy->on_tick;   /* hooks lidos uma vez */
+    bool detect_on_stall = S->policy->detect_on_stall;
 
-    while (!all_finished(S)) {
-        bool progress = false;
+    detector_begin(S);
+    sim_metrics_begin(S);
 
-        /* 1) Passo nos processos READY */
-        for (int i = 0; i < S->n; ++i) {
-            Process *p = &S->procs[i];
+    /* Enfileira o estado inicial (pids em ordem crescente) */
+    for (int i = 0; i < S->n; ++i) {
+        Process *p = &S->procs[i];
+        if (p->state == P_READY)   sched_push_ready(S, p);
+        if (p->state == P_BLOCKED) sched_push_blocked(S, p);
+    }
+    trace_states_all(S);
+    trace_available(S);
+
+    while ((sched_pending(&S->sched) || co_has_sleepers()) && !S->fault) {
+        bool progress = false;
+        uint64_t grants0 = S->metrics.grants, aborts0 = S->metrics.aborts;
+        uint64_t releases0 = S->metrics.partial_releases;
+
+        /* 1) Passo nos processos READY desta rodada (e nos que acordaram) */
+        co_wake_due(S);
+        sched_begin_round(&S->sched);
+        int pid;
+        while ((pid = sched_pop_ready(S)) >= 0) {
+            Process *p = &S->procs[pid];
             if (p->state != P_READY) continue;
 
             /* Snapshot do estado antes */
             PState before = p->state;
-
-            /* sim_step_handle_process deve estar no seu simulator.c */
-            extern bool sim_step_handle_process(System *S, Process *p);
             bool finished_now = sim_step_handle_process(S, p);
+            trace_state(S, p);
 
             if (finished_now || p->state != before) {
                 progress = true;
@@ -317,24 +552,71 @@ void sim_run(System *S) {
             progress = true;
         }
 
+        /* Concessão READY→READY e abortos (READY→READY) também são progresso */
+        if (S->metrics.grants != grants0 || S->metrics.aborts != aborts0 ||
+            S->metrics.partial_releases != releases0) {
+            progress = true;
+        }
+
+        /* Só há corrotinas em compute(t): pula direto ao próximo timer */
+        if (!progress && co_has_sleepers()) {
+            uint64_t wake = co_next_wake();
+            if (wake > S->sim_clock + 1) sim_advance_clock(S, wake - 1);
+            progress = true;
+        }
+
         /* 3) Avança o relógio lógico */
-        S->sim_clock += 1;
+        sim_advance_clock(S, S->sim_clock + 1);
+        if (on_tick) on_tick(S);
 
         /* 4) Se não houve progresso na rodada, paramos (evita loop infinito) */
-        if (!progress) {
-            if (S->mode == MODE_OSTRICH) {
-                bool has_blocked = false;
-                for (int i = 0; i < S->n; ++i) {
-                    if (S->procs[i].state == P_BLOCKED) { has_blocked = true; break; }
-                }
-                if (has_blocked && detect_deadlock(S)) {
-                    S->metrics.deadlocks_found += 1;
-                    if (S->metrics.time_to_first_deadlock == 0) {
-                        S->metrics.time_to_first_deadlock = S->sim_clock;
-                    }
-                }
-            }
+        if (!progress && !S->fault) {
+            if (detect_on_stall) detector_on_stall(S);
             break; /* evita loop infinito */
         }
     }
+
+    flight_on_run_end(S);
+}
+
+static uint64_t proc_stat(const System *S, const Process *p, ProcStat k) {
+    switch (k) {
+        case PS_WAIT:
+            return p->wait_time_acc + (p->waiting ? S->sim_clock - p->blocked_since : 0);
+        case PS_RETRIES: return p->retries;
+        case PS_TURNAROUND:
+        default:         return p->finish_clock - p->arrival_clock;
+    }
+}
+
+void sim_proc_dist(const System *S, ProcStat k, ProcDist *out) {
+    memset(out, 0, sizeof *out);
+    if (!S || S->n <= 0) return;
+
+    uint64_t *v = malloc((size_t)S->n * sizeof *v);
+    if (!v) return;
+    int cnt = 0;
+    double sum = 0.0;
+    for (int i = 0; i < S->n; ++i) {
+        const Process *p = &S->procs[i];
+        if (k == PS_TURNAROUND && p->state != P_FINISHED) continue;
+        v[cnt] = proc_stat(S, p, k);
+        sum += (double)v[cnt++];
+    }
+    if (cnt > 0) {
+        qsort(v, (size_t)cnt, sizeof *v, metrics_cmp_u64);
+        out->count = cnt;
+        out->mean  = sum / cnt;
+        out->p50   = metrics_pct(v, (uint64_t)cnt, 50);
+        out->p99   = metrics_pct(v, (uint64_t)cnt, 99);
+        out->max   = v[cnt - 1];
+    }
+    free(v);
+}
+
+void sim_turnaround_stats(const System *S, double *mean, uint64_t *p99) {
+    ProcDist d;
+    sim_proc_dist(S, PS_TURNAROUND, &d);
+    if (mean) *mean = d.mean;
+    if (p99)  *p99  = d.p99;
 }
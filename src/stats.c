@@ -0,0 +1,190 @@
+/* ---------------------------------------------------------------------
+ * stats.c — Escritor (seqlock na página mapeada) e subcomando `stat`
+ * Escrita: seq ímpar → stores relaxados dos valores → seq par (release).
+ * Leitura: seq par (acquire) → cópia → fence → seq igual; senão repete.
+ * Os valores são _Atomic só para a cópia concorrente ser bem definida;
+ * stores relaxados de 64 bits são movs comuns no x86-64/arm64.
+ * --------------------------------------------------------------------- */
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "stats.h"
+#include "simulator.h"
+#include "scheduler.h"
+#include "policy.h"
+#include "timing.h"
+
+static StatsPage *g_page = NULL;
+
+bool stats_enabled(void) {
+    return g_page != NULL;
+}
+
+bool stats_open(const char *path, const System *S, const char *scenario) {
+    if (!path || !S || g_page) return false;
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    if (ftruncate(fd, (off_t)sizeof(StatsPage)) != 0) {
+        close(fd);
+        return false;
+    }
+    void *p = mmap(NULL, sizeof(StatsPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+
+    StatsPage *pg = p;
+    memcpy(pg->magic, STATS_MAGIC, sizeof pg->magic);
+    pg->version    = STATS_VERSION;
+    pg->writer_pid = (uint32_t)getpid();
+    pg->n = S->n;
+    pg->m = S->m;
+    snprintf(pg->mode, sizeof pg->mode, "%s", S->policy ? S->policy->label : "?");
+    snprintf(pg->scenario, sizeof pg->scenario, "%s", scenario ? scenario : "?");
+    atomic_store_explicit(&pg->seq, 0, memory_order_relaxed);
+    g_page = pg;
+    stats_publish(S);
+    return true;
+}
+
+static void publish(const System *S, uint64_t done) {
+    StatsPage *pg = g_page;
+    const Metrics *mt = &S->metrics;
+    uint64_t v[ST_COUNT] = {
+        [ST_CLOCK]          = S->sim_clock,
+        [ST_REQUESTS]       = mt->total_requests,
+        [ST_GRANTS]         = mt->grants,
+        [ST_BLOCKS]         = mt->blocks,
+        [ST_ABORTS]         = mt->aborts,
+        [ST_SAFETY_CALLS]   = mt->banker_safety_calls,
+        [ST_SAFETY_NS]      = mt->ns_in_safety_total,
+        [ST_DETECTOR_CALLS] = mt->detector_calls,
+        [ST_DEADLOCKS]      = mt->deadlocks_found,
+        [ST_EVENTS]         = mt->events,
+        [ST_READY]          = (uint64_t)sched_ready_count(&S->sched),
+        [ST_BLOCKED]        = (uint64_t)sched_blocked_count(&S->sched),
+        [ST_FINISHED]       = (uint64_t)S->n_finished,
+        [ST_DONE]           = done,
+    };
+
+    uint64_t s = atomic_load_explicit(&pg->seq, memory_order_relaxed);
+    atomic_store_explicit(&pg->seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for (int k = 0; k < ST_COUNT; ++k)
+        atomic_store_explicit(&pg->v[k], v[k], memory_order_relaxed);
+    atomic_store_explicit(&pg->seq, s + 2, memory_order_release);
+}
+
+void stats_publish(const System *S) {
+    if (!g_page) return;
+    publish(S, 0);
+}
+
+void stats_close(const System *S) {
+    if (!g_page) return;
+    if (S) publish(S, 1);
+    munmap(g_page, sizeof(StatsPage));
+    g_page = NULL;
+}
+
+/* ============================
+ * Leitor (subcomando stat)
+ * ============================ */
+static void snapshot(const StatsPage *pg, uint64_t v[ST_COUNT]) {
+    for (;;) {
+        uint64_t s1 = atomic_load_explicit(&pg->seq, memory_order_acquire);
+        if (s1 & 1u) continue;   /* escritor no meio: a janela é de poucos stores */
+        for (int k = 0; k < ST_COUNT; ++k)
+            v[k] = atomic_load_explicit(&pg->v[k], memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&pg->seq, memory_order_relaxed) == s1) return;
+    }
+}
+
+static bool writer_alive(uint32_t pid) {
+    return kill((pid_t)pid, 0) == 0 || errno != ESRCH;
+}
+
+static double rate(uint64_t now, uint64_t before, double secs) {
+    return now >= before ? (double)(now - before) / secs : 0.0;
+}
+
+static void print_line(const StatsPage *pg, const uint64_t v[ST_COUNT],
+                       const uint64_t prev[ST_COUNT], double secs, double elapsed)
+{
+    uint64_t dcalls = v[ST_SAFETY_CALLS] - prev[ST_SAFETY_CALLS];
+    uint64_t dns    = v[ST_SAFETY_NS] - prev[ST_SAFETY_NS];
+    printf("t=%.0fs clock=%llu ticks/s=%.0f req/s=%.0f grants/s=%.0f blocks/s=%.0f"
+           " aborts/s=%.0f ready=%llu blocked=%llu finished=%llu/%d"
+           " safety_avg_ns=%.0f deadlocks=%llu\n",
+           elapsed, (unsigned long long)v[ST_CLOCK],
+           rate(v[ST_CLOCK], prev[ST_CLOCK], secs),
+           rate(v[ST_REQUESTS], prev[ST_REQUESTS], secs),
+           rate(v[ST_GRANTS], prev[ST_GRANTS], secs),
+           rate(v[ST_BLOCKS], prev[ST_BLOCKS], secs),
+           rate(v[ST_ABORTS], prev[ST_ABORTS], secs),
+           (unsigned long long)v[ST_READY], (unsigned long long)v[ST_BLOCKED],
+           (unsigned long long)v[ST_FINISHED], pg->n,
+           dcalls ? (double)dns / (double)dcalls : 0.0,
+           (unsigned long long)v[ST_DEADLOCKS]);
+    fflush(stdout);
+}
+
+int stats_watch(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "stat: não abriu %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(StatsPage)) {
+        fprintf(stderr, "stat: %s não é uma página de estatísticas\n", path);
+        close(fd);
+        return 1;
+    }
+    void *p = mmap(NULL, sizeof(StatsPage), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        fprintf(stderr, "stat: mmap falhou: %s\n", strerror(errno));
+        return 1;
+    }
+    const StatsPage *pg = p;
+    if (memcmp(pg->magic, STATS_MAGIC, sizeof pg->magic) != 0 || pg->version != STATS_VERSION) {
+        fprintf(stderr, "stat: %s: magic/versão incompatível\n", path);
+        munmap(p, sizeof(StatsPage));
+        return 1;
+    }
+
+    printf("stat: mode=%s scenario=%s n=%d m=%d pid=%u\n",
+           pg->mode, pg->scenario, pg->n, pg->m, pg->writer_pid);
+
+    uint64_t v[ST_COUNT], prev[ST_COUNT];
+    snapshot(pg, prev);
+    unsigned long long t_start = now_ns(), t_prev = t_start;
+    int rc = 0;
+    for (;;) {
+        if (!prev[ST_DONE]) {
+            struct timespec one = { 1, 0 };
+            nanosleep(&one, NULL);
+        }
+        snapshot(pg, v);
+        unsigned long long t = now_ns();
+        double secs = (double)(t - t_prev) / 1e9;
+        print_line(pg, v, prev, secs > 0.0 ? secs : 1.0, (double)(t - t_start) / 1e9);
+        if (v[ST_DONE]) break;
+        if (!writer_alive(pg->writer_pid)) {
+            fprintf(stderr, "stat: escritor (pid %u) saiu sem publicar o fim\n", pg->writer_pid);
+            rc = 1;
+            break;
+        }
+        memcpy(prev, v, sizeof v);
+        t_prev = t;
+    }
+    munmap(p, sizeof(StatsPage));
+    return rc;
+}
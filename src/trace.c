@@ -0,0 +1,224 @@
+/* ---------------------------------------------------------------------
+ * trace.c — Buffers do trace e escrita em Chrome trace-event JSON
+ * Três buffers crescem por realloc (amortizado O(1) por registro):
+ * transições de estado (clock, pid, estado), amostras de Available
+ * (clock + m colunas) e spans de host (t0, t1, tipo). Transições são
+ * gravadas só quando o estado muda; na escrita viram spans "X" ligando
+ * cada transição à seguinte do mesmo processo.
+ * --------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+#include "simulator.h"
+#include "process.h"
+#include "timing.h"
+
+#define TRACE_MAX_RECORDS (1u << 26)   /* por buffer; além disso trunca */
+#define TRACE_US_PER_TICK 1000         /* 1 tick simulado = 1 ms no visualizador */
+
+typedef struct TrState {
+    uint64_t clock;
+    int32_t  pid;
+    int32_t  state;
+} TrState;
+
+typedef struct TrHost {
+    unsigned long long t0, t1;
+    TraceHost kind;
+} TrHost;
+
+typedef struct Trace {
+    const char *path;
+    int         m;
+    bool        truncated;
+    unsigned long long origin;   /* now_ns() no open */
+
+    TrState    *st;
+    size_t      st_len, st_cap;
+    TrHost     *host;
+    size_t      host_len, host_cap;
+    uint64_t   *av_clock;        /* [av_cap]       */
+    int32_t    *av_cols;         /* [av_cap][m]    */
+    size_t      av_len, av_cap;
+
+    int8_t      last_state[MAX_P];   /* -1 = ainda não visto */
+    int32_t     last_avail[MAX_R];
+    bool        have_avail;
+} Trace;
+
+static Trace g_tr;
+static bool  g_on = false;
+
+static const char *const g_host_names[] = {
+    [TR_HOST_SAFETY]    = "safety_check",
+    [TR_HOST_DETECT]    = "detect_deadlock",
+    [TR_HOST_LOG_FLUSH] = "logger_flush",
+};
+
+/* Garante espaço para mais um registro; false → trace truncado */
+static bool grow(void **buf, size_t *cap, size_t len, size_t elem) {
+    if (len < *cap) return true;
+    if (len >= TRACE_MAX_RECORDS) { g_tr.truncated = true; return false; }
+    size_t ncap = *cap ? 2 * *cap : 4096;
+    void *p = realloc(*buf, ncap * elem);
+    if (!p) { g_tr.truncated = true; return false; }
+    *buf = p;
+    *cap = ncap;
+    return true;
+}
+
+bool trace_open(const char *path, int m) {
+    if (!path || m <= 0 || m > MAX_R) return false;
+    memset(&g_tr, 0, sizeof g_tr);
+    g_tr.path = path;
+    g_tr.m = m;
+    g_tr.origin = now_ns();
+    memset(g_tr.last_state, -1, sizeof g_tr.last_state);
+    g_on = true;
+    return true;
+}
+
+bool trace_enabled(void) {
+    return g_on;
+}
+
+/* ============================
+ * Registro (hot path)
+ * ============================ */
+void trace_state(const System *S, const Process *P) {
+    if (!g_on || P->id < 0 || P->id >= MAX_P) return;
+    if (g_tr.last_state[P->id] == (int8_t)P->state) return;
+    if (!grow((void **)&g_tr.st, &g_tr.st_cap, g_tr.st_len, sizeof *g_tr.st)) return;
+    g_tr.st[g_tr.st_len++] = (TrState){ S->sim_clock, P->id, (int32_t)P->state };
+    g_tr.last_state[P->id] = (int8_t)P->state;
+}
+
+void trace_states_all(const System *S) {
+    if (!g_on) return;
+    for (int i = 0; i < S->n; ++i) trace_state(S, &S->procs[i]);
+}
+
+void trace_available(const System *S) {
+    if (!g_on) return;
+    int m = g_tr.m;
+    if (g_tr.have_avail) {
+        bool same = true;
+        for (int j = 0; j < m && same; ++j) same = g_tr.last_avail[j] == S->Available[j];
+        if (same) return;
+    }
+    if (g_tr.av_len == g_tr.av_cap) {
+        size_t cap = g_tr.av_cap;
+        if (!grow((void **)&g_tr.av_clock, &cap, g_tr.av_len, sizeof *g_tr.av_clock)) return;
+        int32_t *cols = realloc(g_tr.av_cols, cap * (size_t)m * sizeof *cols);
+        if (!cols) { g_tr.truncated = true; return; }
+        g_tr.av_cols = cols;
+        g_tr.av_cap = cap;
+    }
+    int32_t *c = g_tr.av_cols + g_tr.av_len * (size_t)m;
+    for (int j = 0; j < m; ++j) c[j] = g_tr.last_avail[j] = S->Available[j];
+    g_tr.av_clock[g_tr.av_len++] = S->sim_clock;
+    g_tr.have_avail = true;
+}
+
+void trace_host(TraceHost kind, unsigned long long t0, unsigned long long t1) {
+    if (!g_on) return;
+    if (!grow((void **)&g_tr.host, &g_tr.host_cap, g_tr.host_len, sizeof *g_tr.host)) return;
+    g_tr.host[g_tr.host_len++] = (TrHost){ t0, t1, kind };
+}
+
+/* ============================
+ * Escrita (uma vez, no close)
+ * ============================ */
+static const char *state_name(int s) {
+    switch (s) {
+        case P_NEW:      return "NEW";
+        case P_READY:    return "READY";
+        case P_RUNNING:  return "RUNNING";
+        case P_BLOCKED:  return "BLOCKED";
+        case P_FINISHED: return "FINISHED";
+        default:         return "?";
+    }
+}
+
+static void write_span(FILE *f, int pid, int state, uint64_t from, uint64_t to) {
+    if (to <= from) return;   /* transições no mesmo tick não têm duração */
+    fprintf(f, ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"name\":\"%s\",\"ts\":%llu,\"dur\":%llu}",
+            pid, state_name(state),
+            (unsigned long long)(from * TRACE_US_PER_TICK),
+            (unsigned long long)((to - from) * TRACE_US_PER_TICK));
+}
+
+static void write_json(const System *S, FILE *f) {
+    uint64_t end = S ? S->sim_clock : 0;
+    int n = S ? S->n : 0;
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"truncated\":%s,"
+               "\"us_per_tick\":%d},\n\"traceEvents\":[\n",
+            g_tr.truncated ? "true" : "false", TRACE_US_PER_TICK);
+    fprintf(f, "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\","
+               "\"args\":{\"name\":\"simulado (1 tick = 1 ms)\"}}");
+    fprintf(f, ",\n{\"ph\":\"M\",\"pid\":2,\"name\":\"process_name\",\"args\":{\"name\":\"host\"}}");
+    for (int i = 0; i < n; ++i) {
+        fprintf(f, ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\","
+                   "\"args\":{\"name\":\"P%d\"}}", i, i);
+    }
+    for (int k = 0; k < ARRAY_LEN(g_host_names); ++k) {
+        fprintf(f, ",\n{\"ph\":\"M\",\"pid\":2,\"tid\":%d,\"name\":\"thread_name\","
+                   "\"args\":{\"name\":\"%s\"}}", k, g_host_names[k]);
+    }
+
+    /* Spans de estado: cada transição fecha a anterior do mesmo pid */
+    uint64_t *open_at = malloc((size_t)MAX_P * sizeof *open_at);
+    int      *open_st = malloc((size_t)MAX_P * sizeof *open_st);
+    if (open_at && open_st) {
+        for (int i = 0; i < MAX_P; ++i) open_st[i] = -1;
+        for (size_t k = 0; k < g_tr.st_len; ++k) {
+            const TrState *e = &g_tr.st[k];
+            if (open_st[e->pid] >= 0) write_span(f, e->pid, open_st[e->pid], open_at[e->pid], e->clock);
+            open_st[e->pid] = e->state;
+            open_at[e->pid] = e->clock;
+        }
+        for (int i = 0; i < MAX_P; ++i) {
+            if (open_st[i] >= 0) write_span(f, i, open_st[i], open_at[i], end > open_at[i] ? end : open_at[i] + 1);
+        }
+    }
+    free(open_at);
+    free(open_st);
+
+    /* Counters de Available */
+    for (size_t k = 0; k < g_tr.av_len; ++k) {
+        const int32_t *c = g_tr.av_cols + k * (size_t)g_tr.m;
+        fprintf(f, ",\n{\"ph\":\"C\",\"pid\":1,\"name\":\"Available\",\"ts\":%llu,\"args\":{",
+                (unsigned long long)(g_tr.av_clock[k] * TRACE_US_PER_TICK));
+        for (int j = 0; j < g_tr.m; ++j) fprintf(f, "%s\"R%d\":%d", j ? "," : "", j, c[j]);
+        fprintf(f, "}}");
+    }
+
+    /* Spans de host (µs com fração de ns) */
+    for (size_t k = 0; k < g_tr.host_len; ++k) {
+        const TrHost *h = &g_tr.host[k];
+        unsigned long long t0 = h->t0 > g_tr.origin ? h->t0 - g_tr.origin : 0;
+        fprintf(f, ",\n{\"ph\":\"X\",\"pid\":2,\"tid\":%d,\"name\":\"%s\",\"ts\":%.3f,\"dur\":%.3f}",
+                (int)h->kind, g_host_names[h->kind], (double)t0 / 1000.0,
+                (double)(h->t1 - h->t0) / 1000.0);
+    }
+    fprintf(f, "\n]}\n");
+}
+
+bool trace_close(const System *S) {
+    if (!g_on) return false;
+    g_on = false;
+    bool ok = false;
+    FILE *f = fopen(g_tr.path, "w");
+    if (f) {
+        write_json(S, f);
+        ok = fclose(f) == 0;
+    }
+    free(g_tr.st);
+    free(g_tr.host);
+    free(g_tr.av_clock);
+    free(g_tr.av_cols);
+    memset(&g_tr, 0, sizeof g_tr);
+    return ok;
+}
@@ -0,0 +1,57 @@
+/* ---------------------------------------------------------------------
+ * unitbits.c — Classificação das colunas e montagem dos bitsets
+ * A classificação só muda com a carga (o total de instâncias de cada
+ * recurso se conserva); depois disso sys_grant/sys_rollback e a
+ * devolução mantêm os bits por ub_set, O(1) por coluna tocada.
+ * --------------------------------------------------------------------- */
+#include <string.h>
+#include "unitbits.h"
+#include "simulator.h"
+#include "process.h"
+
+void ub_build(System *S) {
+    UnitBits *b = &S->bits;
+    int m = S->m, n = S->n;
+    b->words = (m + 63) / 64;
+    b->n_unit = b->n_counted = 0;
+    memset(b->unit, 0, sizeof b->unit);
+    memset(b->avail, 0, sizeof b->avail);
+    memset(b->need, 0, sizeof b->need);    /* pids >= n entram depois (registro) */
+    memset(b->alloc, 0, sizeof b->alloc);
+
+    for (int j = 0; j < m; ++j) {
+        long long units = S->Available[j];
+        bool small = true;
+        for (int i = 0; i < n; ++i) {
+            units += S->procs[i].Allocation[j];
+            if (S->procs[i].Max[j] > 1) small = false;
+        }
+        if (units == 1 && small) {
+            b->unit[j >> 6] |= 1ull << (j & 63);
+            if (S->Available[j]) b->avail[j >> 6] |= 1ull << (j & 63);
+            b->n_unit++;
+        } else {
+            b->counted[b->n_counted++] = j;
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        const Process *p = &S->procs[i];
+        for (int w = 0; w < b->words; ++w) {
+            u64 bits = b->unit[w], nb = 0, ab = 0;
+            while (bits) {
+                int t = __builtin_ctzll(bits);
+                if (p->Need[w * 64 + t])       nb |= 1ull << t;
+                if (p->Allocation[w * 64 + t]) ab |= 1ull << t;
+                bits &= bits - 1;
+            }
+            b->need[i][w]  = nb;
+            b->alloc[i][w] = ab;
+        }
+    }
+    b->valid = true;
+}
+
+void ub_ensure(System *S) {
+    if (!S->bits.valid) ub_build(S);
+}